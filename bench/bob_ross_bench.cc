@@ -0,0 +1,547 @@
+// Draws every BobRoss primitive and a few UI-like scenes with each available
+// backend at several screen sizes, and prints the results as JSON so runs
+// can be diffed between releases.
+//
+// Usage: bob_ross_bench [--frames=N] [--backends=name,...] [--output=path]
+// Backends are cpu, cpu_threaded, gles3 and gles3_tessellated. The GLES3
+// ones run in a headless context and are skipped when none is available.
+// Results go to stdout unless --output is given.
+
+#include <bob_ross/bob_ross.h>
+#include <bob_ross/cpu_backend.h>
+#include <bob_ross/gles3_backend.h>
+#include <bob_ross/headless_context.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using bob_ross::BobRoss;
+using bob_ross::CircleInstance;
+using bob_ross::Color;
+using bob_ross::Point;
+using bob_ross::RectInstance;
+using Clock = std::chrono::steady_clock;
+
+constexpr int kWarmupFrames = 2;
+constexpr float kPi = 3.14159265358979f;
+
+struct ScreenSize {
+  int width, height;
+};
+
+constexpr ScreenSize kScreenSizes[] = {
+    {640, 360}, {1280, 720}, {1920, 1080}, {3840, 2160}};
+
+// One primitive of a scene, drawn with the matching BobRoss call.
+struct Shape {
+  enum class Kind { kRect, kCircle, kPolygon };
+  Kind kind = Kind::kRect;
+  Color color = {};
+  RectInstance rect = {};
+  CircleInstance circle = {};
+  std::vector<Point> points = {};
+};
+
+struct Scene {
+  std::vector<Shape> shapes;
+};
+
+const Color kOpaquePalette[] = {
+    {30, 60, 200, 255}, {220, 80, 40, 255}, {40, 200, 90, 255},
+    {240, 240, 240, 255}};
+const Color kTranslucentPalette[] = {
+    {30, 60, 200, 160}, {220, 80, 40, 128}, {40, 200, 90, 200},
+    {0, 0, 0, 96}};
+
+Shape MakeRect(float left, float top, float right, float bottom,
+               Color color) {
+  Shape shape{Shape::Kind::kRect, color};
+  shape.rect = {{left, top}, {right, bottom}};
+  return shape;
+}
+
+Shape MakeCircle(float x, float y, float radius, Color color) {
+  Shape shape{Shape::Kind::kCircle, color};
+  shape.circle = {{x, y}, radius};
+  return shape;
+}
+
+// A regular polygon, or a star when |inner_ratio| is below one.
+Shape MakePolygon(float x, float y, float radius, int corners,
+                  float inner_ratio, Color color) {
+  Shape shape{Shape::Kind::kPolygon, color};
+  int count = inner_ratio < 1 ? corners * 2 : corners;
+  for (int i = 0; i < count; i++) {
+    float angle = 2 * kPi * i / count;
+    float r = (inner_ratio < 1 && i % 2) ? radius * inner_ratio : radius;
+    shape.points.push_back({x + r * std::cos(angle), y + r * std::sin(angle)});
+  }
+  return shape;
+}
+
+// Shapes of a single kind scattered over the screen. |min_size| and
+// |max_size| are in pixels when |relative| is false and fractions of the
+// shorter screen side otherwise.
+Scene MakeScatterScene(Shape::Kind kind, int count, float min_size,
+                       float max_size, bool relative, bool concave,
+                       int corners, ScreenSize screen) {
+  std::mt19937 rng(7);
+  float scale = relative ? std::min(screen.width, screen.height) : 1.0f;
+  std::uniform_real_distribution<float> x(0, screen.width);
+  std::uniform_real_distribution<float> y(0, screen.height);
+  std::uniform_real_distribution<float> size(min_size * scale,
+                                             max_size * scale);
+  std::uniform_int_distribution<int> pick(0, 3);
+  Scene scene;
+  for (int i = 0; i < count; i++) {
+    // Large shapes are translucent so the benchmark also covers blending.
+    Color color = relative ? kTranslucentPalette[pick(rng)]
+                           : kOpaquePalette[pick(rng)];
+    float cx = x(rng), cy = y(rng), s = size(rng);
+    switch (kind) {
+      case Shape::Kind::kRect:
+        scene.shapes.push_back(
+            MakeRect(cx, cy, cx + s, cy + size(rng), color));
+        break;
+      case Shape::Kind::kCircle:
+        scene.shapes.push_back(MakeCircle(cx, cy, s, color));
+        break;
+      case Shape::Kind::kPolygon:
+        scene.shapes.push_back(
+            MakePolygon(cx, cy, s, corners, concave ? 0.45f : 1, color));
+        break;
+    }
+  }
+  return scene;
+}
+
+// A grid of cards, each with a header, a few lines of text drawn as bars,
+// an avatar, a sparkline and a button.
+Scene MakeDashboardScene(ScreenSize screen) {
+  constexpr float kCardWidth = 240, kCardHeight = 160, kGap = 12;
+  Scene scene;
+  scene.shapes.push_back(
+      MakeRect(0, 0, screen.width, screen.height, {236, 239, 244, 255}));
+  for (float top = kGap; top + kCardHeight <= screen.height;
+       top += kCardHeight + kGap) {
+    for (float left = kGap; left + kCardWidth <= screen.width;
+         left += kCardWidth + kGap) {
+      float right = left + kCardWidth, bottom = top + kCardHeight;
+      scene.shapes.push_back(MakeRect(left + 2, top + 2, right + 2,
+                                      bottom + 2, {0, 0, 0, 40}));
+      scene.shapes.push_back(
+          MakeRect(left, top, right, bottom, {255, 255, 255, 255}));
+      scene.shapes.push_back(
+          MakeRect(left, top, right, top + 28, {52, 101, 164, 255}));
+      scene.shapes.push_back(
+          MakeCircle(left + 24, top + 52, 14, {114, 159, 207, 255}));
+      for (int line = 0; line < 4; line++) {
+        float y = top + 44 + line * 12;
+        scene.shapes.push_back(MakeRect(left + 48, y,
+                                        right - 16 - line * 20, y + 6,
+                                        {85, 87, 83, 255}));
+      }
+      Shape sparkline{Shape::Kind::kPolygon, {78, 154, 6, 180}};
+      float base = bottom - 40;
+      sparkline.points.push_back({left + 12, base + 24});
+      for (int i = 0; i <= 10; i++) {
+        float value = std::sin(left * 0.01f + top * 0.02f + i * 0.9f);
+        sparkline.points.push_back({left + 12 + i * 14, base - value * 12});
+      }
+      sparkline.points.push_back({left + 152, base + 24});
+      scene.shapes.push_back(std::move(sparkline));
+      scene.shapes.push_back(MakeRect(right - 72, bottom - 32, right - 12,
+                                      bottom - 12, {204, 0, 0, 255}));
+    }
+  }
+  return scene;
+}
+
+// A scrolling list whose rows have a separator, an avatar, two lines of
+// text, a checkmark and a translucent selection highlight on every third
+// row.
+Scene MakeListScene(ScreenSize screen) {
+  constexpr float kRowHeight = 48;
+  Scene scene;
+  scene.shapes.push_back(
+      MakeRect(0, 0, screen.width, screen.height, {255, 255, 255, 255}));
+  int row = 0;
+  for (float top = 0; top < screen.height; top += kRowHeight, row++) {
+    float bottom = top + kRowHeight, right = screen.width;
+    if (row % 3 == 0) {
+      scene.shapes.push_back(
+          MakeRect(0, top, right, bottom, {52, 101, 164, 48}));
+    }
+    scene.shapes.push_back(
+        MakeRect(16, bottom - 1, right, bottom, {211, 215, 207, 255}));
+    scene.shapes.push_back(MakeCircle(36, top + 24, 16, {117, 80, 123, 255}));
+    scene.shapes.push_back(MakeRect(64, top + 12, 64 + (row % 5 + 4) * 30,
+                                    top + 22, {46, 52, 54, 255}));
+    scene.shapes.push_back(MakeRect(64, top + 28, 64 + (row % 7 + 6) * 24,
+                                    top + 36, {136, 138, 133, 255}));
+    Shape check{Shape::Kind::kPolygon, {78, 154, 6, 255}};
+    float x = right - 40, y = top + 24;
+    check.points = {{x - 10, y},     {x - 6, y - 4}, {x - 2, y + 1},
+                    {x + 8, y - 10}, {x + 12, y - 6}, {x - 2, y + 9}};
+    scene.shapes.push_back(std::move(check));
+  }
+  return scene;
+}
+
+// A map view: 50k small shapes spread over twenty times the screen area,
+// so only about 5% of them are visible.
+Scene MakeMapScene(ScreenSize screen) {
+  std::mt19937 rng(11);
+  float spread = std::sqrt(20.0f);
+  std::uniform_real_distribution<float> x(screen.width * (1 - spread) / 2,
+                                          screen.width * (1 + spread) / 2);
+  std::uniform_real_distribution<float> y(screen.height * (1 - spread) / 2,
+                                          screen.height * (1 + spread) / 2);
+  std::uniform_real_distribution<float> size(3, 12);
+  std::uniform_int_distribution<int> pick(0, 3);
+  Scene scene;
+  for (int i = 0; i < 50000; i++) {
+    float cx = x(rng), cy = y(rng), s = size(rng);
+    Color color = kOpaquePalette[pick(rng)];
+    switch (i % 3) {
+      case 0:
+        scene.shapes.push_back(MakeRect(cx, cy, cx + s, cy + s, color));
+        break;
+      case 1:
+        scene.shapes.push_back(MakeCircle(cx, cy, s / 2, color));
+        break;
+      case 2:
+        scene.shapes.push_back(MakePolygon(cx, cy, s, 3, 1, color));
+        break;
+    }
+  }
+  return scene;
+}
+
+struct SceneSpec {
+  const char *name;
+  Scene (*make)(ScreenSize screen);
+};
+
+const SceneSpec kScenes[] = {
+    {"rect_small",
+     [](ScreenSize s) {
+       return MakeScatterScene(Shape::Kind::kRect, 10000, 4, 16, false,
+                               false, 0, s);
+     }},
+    {"rect_large",
+     [](ScreenSize s) {
+       return MakeScatterScene(Shape::Kind::kRect, 200, 0.1f, 0.5f, true,
+                               false, 0, s);
+     }},
+    {"circle_small",
+     [](ScreenSize s) {
+       return MakeScatterScene(Shape::Kind::kCircle, 10000, 2, 8, false,
+                               false, 0, s);
+     }},
+    {"circle_large",
+     [](ScreenSize s) {
+       return MakeScatterScene(Shape::Kind::kCircle, 200, 0.05f, 0.25f, true,
+                               false, 0, s);
+     }},
+    {"polygon_convex_small",
+     [](ScreenSize s) {
+       return MakeScatterScene(Shape::Kind::kPolygon, 2000, 4, 12, false,
+                               false, 6, s);
+     }},
+    {"polygon_convex_large",
+     [](ScreenSize s) {
+       return MakeScatterScene(Shape::Kind::kPolygon, 100, 0.1f, 0.3f, true,
+                               false, 64, s);
+     }},
+    {"polygon_concave_small",
+     [](ScreenSize s) {
+       return MakeScatterScene(Shape::Kind::kPolygon, 2000, 6, 16, false,
+                               true, 5, s);
+     }},
+    {"polygon_concave_large",
+     [](ScreenSize s) {
+       return MakeScatterScene(Shape::Kind::kPolygon, 100, 0.1f, 0.3f, true,
+                               true, 32, s);
+     }},
+    {"ui_dashboard", MakeDashboardScene},
+    {"ui_list", MakeListScene},
+    {"map_offscreen", MakeMapScene},
+};
+
+void Draw(BobRoss *painter, const Scene &scene) {
+  const Color *current = nullptr;
+  for (const Shape &shape : scene.shapes) {
+    if (!current || std::memcmp(current, &shape.color, sizeof(Color))) {
+      painter->SetFillColor(shape.color);
+      current = &shape.color;
+    }
+    switch (shape.kind) {
+      case Shape::Kind::kRect:
+        painter->Rect(shape.rect.top_left, shape.rect.bottom_right);
+        break;
+      case Shape::Kind::kCircle:
+        painter->Circle(shape.circle.origin, shape.circle.radius);
+        break;
+      case Shape::Kind::kPolygon:
+        painter->Polygon(shape.points);
+        break;
+    }
+  }
+}
+
+// A backend under test, with the hooks needed to time it fairly.
+class BenchTarget {
+ public:
+  virtual ~BenchTarget() = default;
+
+  virtual const char *name() const = 0;
+  virtual std::string device() const = 0;
+  virtual void Resize(ScreenSize screen) {
+    painter_->UpdateScreenDimension(screen.width, screen.height);
+  }
+  virtual void BeginFrame() { painter_->BeginFrame(); }
+  // Returns once the frame is fully rendered.
+  virtual void EndFrame() { painter_->EndFrame(); }
+  virtual int draw_calls() const { return 0; }
+  virtual size_t bytes_uploaded() const { return 0; }
+
+  BobRoss *painter() { return painter_.get(); }
+
+ protected:
+  std::unique_ptr<BobRoss> painter_;
+};
+
+class CpuTarget : public BenchTarget {
+ public:
+  CpuTarget(const char *name, int thread_count) : name_(name) {
+    bob_ross::CpuOptions options;
+    options.thread_count = thread_count;
+    auto backend = std::make_unique<bob_ross::CpuBackend>(options);
+    threads_ = backend->thread_count();
+    painter_ = std::make_unique<BobRoss>(1, 1, std::move(backend));
+  }
+
+  const char *name() const override { return name_; }
+  std::string device() const override {
+    return "cpu, " + std::to_string(threads_) + " threads";
+  }
+
+ private:
+  const char *name_;
+  int threads_ = 1;
+};
+
+class Gles3Target : public BenchTarget {
+ public:
+  Gles3Target(const char *name, bob_ross::HeadlessContext *context,
+              const bob_ross::Gles3Options &options)
+      : name_(name), context_(context) {
+    context_->MakeCurrent();
+    auto backend = std::make_unique<bob_ross::Gles3Backend>(options);
+    backend_ = backend.get();
+    painter_ = std::make_unique<BobRoss>(1, 1, std::move(backend));
+  }
+
+  const char *name() const override { return name_; }
+  std::string device() const override { return context_->renderer(); }
+  void Resize(ScreenSize screen) override {
+    context_->Resize(screen.width, screen.height);
+    BenchTarget::Resize(screen);
+  }
+  void BeginFrame() override {
+    glClear(GL_COLOR_BUFFER_BIT);
+    BenchTarget::BeginFrame();
+  }
+  void EndFrame() override {
+    BenchTarget::EndFrame();
+    glFinish();
+  }
+  int draw_calls() const override { return backend_->draw_calls(); }
+  size_t bytes_uploaded() const override {
+    return backend_->bytes_uploaded();
+  }
+
+ private:
+  const char *name_;
+  bob_ross::HeadlessContext *context_;
+  bob_ross::Gles3Backend *backend_;
+};
+
+struct Result {
+  std::string backend;
+  std::string device;
+  const char *scene;
+  ScreenSize screen;
+  size_t primitives;
+  std::vector<double> frame_ms = {};
+  int draw_calls = 0;
+  size_t bytes_uploaded = 0;
+};
+
+Result Run(BenchTarget *target, const SceneSpec &spec, ScreenSize screen,
+           int frames) {
+  Scene scene = spec.make(screen);
+  target->Resize(screen);
+  Result result{target->name(), target->device(), spec.name, screen,
+                scene.shapes.size()};
+  for (int frame = 0; frame < kWarmupFrames + frames; frame++) {
+    auto start = Clock::now();
+    target->BeginFrame();
+    Draw(target->painter(), scene);
+    target->EndFrame();
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    if (frame >= kWarmupFrames) {
+      result.frame_ms.push_back(elapsed.count());
+    }
+  }
+  result.draw_calls = target->draw_calls();
+  result.bytes_uploaded = target->bytes_uploaded();
+  return result;
+}
+
+// Nearest rank percentile of sorted |values|.
+double Percentile(const std::vector<double> &values, double percent) {
+  size_t rank = static_cast<size_t>(std::ceil(percent / 100 * values.size()));
+  return values[std::min(std::max(rank, size_t{1}), values.size()) - 1];
+}
+
+std::string JsonString(const std::string &value) {
+  std::string out = "\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    if (static_cast<unsigned char>(c) >= 0x20) {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+void WriteJson(FILE *out, const std::vector<Result> &results, int frames) {
+  std::fprintf(out, "{\n  \"frames\": %d,\n  \"results\": [", frames);
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &result = results[i];
+    std::vector<double> sorted = result.frame_ms;
+    std::sort(sorted.begin(), sorted.end());
+    double total_ms = 0;
+    for (double ms : sorted) {
+      total_ms += ms;
+    }
+    double mean_ms = total_ms / sorted.size();
+    std::fprintf(out, "%s\n    {\n", i ? "," : "");
+    std::fprintf(out, "      \"backend\": %s,\n",
+                 JsonString(result.backend).c_str());
+    std::fprintf(out, "      \"device\": %s,\n",
+                 JsonString(result.device).c_str());
+    std::fprintf(out, "      \"scene\": \"%s\",\n", result.scene);
+    std::fprintf(out, "      \"width\": %d,\n      \"height\": %d,\n",
+                 result.screen.width, result.screen.height);
+    std::fprintf(out, "      \"primitives_per_frame\": %zu,\n",
+                 result.primitives);
+    std::fprintf(out, "      \"primitives_per_sec\": %.0f,\n",
+                 result.primitives / (mean_ms / 1000));
+    std::fprintf(out,
+                 "      \"frame_ms\": {\"mean\": %.3f, \"p50\": %.3f, "
+                 "\"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f},\n",
+                 mean_ms, Percentile(sorted, 50), Percentile(sorted, 90),
+                 Percentile(sorted, 99), sorted.back());
+    std::fprintf(out, "      \"draw_calls_per_frame\": %d,\n",
+                 result.draw_calls);
+    std::fprintf(out, "      \"bytes_uploaded_per_frame\": %zu\n    }",
+                 result.bytes_uploaded);
+  }
+  std::fprintf(out, "\n  ]\n}\n");
+}
+
+bool Selected(const std::string &backends, const char *name) {
+  if (backends.empty()) {
+    return true;
+  }
+  std::string list = "," + backends + ",";
+  return list.find("," + std::string(name) + ",") != std::string::npos;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int frames = 20;
+  std::string backends, output;
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (!std::strncmp(arg, "--frames=", 9)) {
+      frames = std::max(std::atoi(arg + 9), 1);
+    } else if (!std::strncmp(arg, "--backends=", 11)) {
+      backends = arg + 11;
+    } else if (!std::strncmp(arg, "--output=", 9)) {
+      output = arg + 9;
+    } else {
+      std::fprintf(stderr,
+                   "usage: %s [--frames=N] [--backends=name,...] "
+                   "[--output=path]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  std::vector<std::unique_ptr<BenchTarget>> targets;
+  if (Selected(backends, "cpu")) {
+    targets.push_back(std::make_unique<CpuTarget>("cpu", 1));
+  }
+  if (Selected(backends, "cpu_threaded")) {
+    targets.push_back(std::make_unique<CpuTarget>("cpu_threaded", 0));
+  }
+  std::unique_ptr<bob_ross::HeadlessContext> context;
+  if (Selected(backends, "gles3") || Selected(backends, "gles3_tessellated")) {
+    context = bob_ross::HeadlessContext::Create(1, 1);
+    if (!context) {
+      std::fprintf(stderr, "No GLES 3 context available, skipping gles3\n");
+    }
+  }
+  if (context) {
+    glClearColor(0, 0, 0, 1);
+    bob_ross::Gles3Options options;
+    if (Selected(backends, "gles3")) {
+      targets.push_back(
+          std::make_unique<Gles3Target>("gles3", context.get(), options));
+    }
+    options.instanced_shapes = false;
+    if (Selected(backends, "gles3_tessellated")) {
+      targets.push_back(std::make_unique<Gles3Target>(
+          "gles3_tessellated", context.get(), options));
+    }
+  }
+
+  std::vector<Result> results;
+  for (auto &target : targets) {
+    for (ScreenSize screen : kScreenSizes) {
+      for (const SceneSpec &scene : kScenes) {
+        std::fprintf(stderr, "%s %dx%d %s\n", target->name(), screen.width,
+                     screen.height, scene.name);
+        results.push_back(Run(target.get(), scene, screen, frames));
+      }
+    }
+  }
+
+  FILE *out = output.empty() ? stdout : std::fopen(output.c_str(), "w");
+  if (!out) {
+    std::fprintf(stderr, "Cannot write %s\n", output.c_str());
+    return 1;
+  }
+  WriteJson(out, results, frames);
+  if (out != stdout) {
+    std::fclose(out);
+  }
+  return 0;
+}
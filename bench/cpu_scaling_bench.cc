@@ -0,0 +1,112 @@
+// Measures how the tiled CPU backend scales with thread count on a 4K
+// frame.
+//
+// Usage: bob_ross_cpu_scaling_bench [max_threads]
+// Sweeps powers of two up to max_threads, which defaults to the number of
+// hardware threads.
+
+#include <bob_ross/bob_ross.h>
+#include <bob_ross/cpu_backend.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using bob_ross::BobRoss;
+using bob_ross::Point;
+using Clock = std::chrono::steady_clock;
+
+constexpr int kWidth = 3840;
+constexpr int kHeight = 2160;
+constexpr int kFrames = 10;
+
+struct Scene {
+  std::vector<bob_ross::RectInstance> rects;
+  std::vector<bob_ross::CircleInstance> circles;
+  std::vector<std::vector<Point>> polygons;
+};
+
+Scene MakeScene() {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> x(0, kWidth), y(0, kHeight);
+  std::uniform_real_distribution<float> small(2, 24), large(40, 200);
+  Scene scene;
+  for (int i = 0; i < 100000; i++) {
+    float left = x(rng), top = y(rng);
+    scene.rects.push_back({{left, top}, {left + small(rng), top + small(rng)}});
+  }
+  for (int i = 0; i < 50000; i++) {
+    scene.circles.push_back({{x(rng), y(rng)}, small(rng)});
+  }
+  for (int i = 0; i < 500; i++) {
+    float cx = x(rng), cy = y(rng), size = large(rng);
+    scene.polygons.push_back({{cx, cy - size},
+                              {cx + size, cy + size},
+                              {cx, cy + size / 3},
+                              {cx - size, cy + size}});
+  }
+  return scene;
+}
+
+void Draw(BobRoss *painter, const Scene &scene) {
+  painter->BeginFrame();
+  painter->SetFillColor({30, 60, 200, 255});
+  painter->Rects(scene.rects.data(), scene.rects.size());
+  painter->SetFillColor({220, 80, 40, 160});
+  painter->Circles(scene.circles.data(), scene.circles.size());
+  painter->SetFillColor({40, 200, 90, 200});
+  for (const auto &polygon : scene.polygons) {
+    painter->Polygon(polygon);
+  }
+  painter->EndFrame();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int max_threads =
+      argc > 1 ? std::atoi(argv[1])
+               : static_cast<int>(std::thread::hardware_concurrency());
+  max_threads = std::max(max_threads, 1);
+  Scene scene = MakeScene();
+
+  std::vector<int> sweep;
+  for (int threads = 1; threads < max_threads; threads *= 2) {
+    sweep.push_back(threads);
+  }
+  sweep.push_back(max_threads);
+
+  std::printf("%dx%d, %zu rects, %zu circles, %zu polygons per frame\n",
+              kWidth, kHeight, scene.rects.size(), scene.circles.size(),
+              scene.polygons.size());
+  std::printf("%8s %12s %10s %12s\n", "threads", "ms/frame", "speedup",
+              "efficiency");
+  double single_thread_ms = 0;
+  for (int threads : sweep) {
+    bob_ross::CpuOptions options;
+    options.thread_count = threads;
+    BobRoss painter(kWidth, kHeight,
+                    std::make_unique<bob_ross::CpuBackend>(options));
+    Draw(&painter, scene);  // Warm up the buffers.
+
+    auto start = Clock::now();
+    for (int frame = 0; frame < kFrames; frame++) {
+      Draw(&painter, scene);
+    }
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    double ms = elapsed.count() / kFrames;
+    if (threads == 1) {
+      single_thread_ms = ms;
+    }
+    double speedup = single_thread_ms / ms;
+    std::printf("%8d %12.2f %10.2f %11.0f%%\n", threads, ms, speedup,
+                100 * speedup / threads);
+  }
+  return 0;
+}
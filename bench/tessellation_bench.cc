@@ -0,0 +1,98 @@
+// Measures circle tessellation throughput across radius ranges.
+//
+// Compares the adaptive, table driven TessellateCircle against a fixed
+// segment count with per-vertex sinf/cosf.
+
+#include <bob_ross/tessellator.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+using bob_ross::CircleInstance;
+using bob_ross::Mesh;
+using bob_ross::Vertex;
+using Clock = std::chrono::steady_clock;
+
+constexpr int kCirclesPerRange = 4096;
+constexpr int kIterations = 64;
+constexpr int kBaselineSegments = 32;
+
+void TessellateCircleWithTrig(const CircleInstance &circle, uint32_t color,
+                              Mesh *mesh) {
+  auto base = static_cast<uint32_t>(mesh->vertices.size());
+  const auto &o = circle.origin;
+  mesh->vertices.push_back({o.x, o.y, o.z, color});
+  for (int i = 0; i < kBaselineSegments; i++) {
+    float angle = 2 * 3.14159265f * i / kBaselineSegments;
+    mesh->vertices.push_back({o.x + circle.radius * cosf(angle),
+                              o.y + circle.radius * sinf(angle), o.z, color});
+    uint32_t next = (i + 1) % kBaselineSegments;
+    mesh->indices.insert(mesh->indices.end(),
+                         {base, base + 1 + i, base + 1 + next});
+  }
+}
+
+struct Throughput {
+  double vertices_per_second;
+  double circles_per_second;
+};
+
+template <typename Tessellate>
+Throughput Measure(const std::vector<CircleInstance> &circles,
+                   Tessellate tessellate) {
+  Mesh mesh;
+  size_t vertices = 0;
+  auto start = Clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    mesh.Clear();
+    for (const CircleInstance &circle : circles) {
+      tessellate(circle, &mesh);
+    }
+    vertices += mesh.vertices.size();
+  }
+  std::chrono::duration<double> elapsed = Clock::now() - start;
+  return {vertices / elapsed.count(),
+          circles.size() * kIterations / elapsed.count()};
+}
+
+}  // namespace
+
+int main() {
+  const float ranges[][2] = {{0.5f, 2},    {2, 8},      {8, 32},
+                             {32, 128},    {128, 512},  {512, 2048}};
+  std::mt19937 rng(42);
+
+  std::printf("%-14s %16s %16s %16s %16s\n", "radius", "adaptive vert/s",
+              "adaptive circ/s", "sinf/cosf vert/s", "sinf/cosf circ/s");
+  for (const auto &range : ranges) {
+    std::uniform_real_distribution<float> radius(range[0], range[1]);
+    std::uniform_real_distribution<float> position(0, 1920);
+    std::vector<CircleInstance> circles(kCirclesPerRange);
+    for (CircleInstance &circle : circles) {
+      circle.origin = {position(rng), position(rng), 0};
+      circle.radius = radius(rng);
+    }
+
+    Throughput adaptive = Measure(
+        circles, [](const CircleInstance &circle, Mesh *mesh) {
+          bob_ross::TessellateCircle(circle, 0xffffffff,
+                                     bob_ross::kDefaultMaxError, mesh);
+        });
+    Throughput baseline = Measure(
+        circles, [](const CircleInstance &circle, Mesh *mesh) {
+          TessellateCircleWithTrig(circle, 0xffffffff, mesh);
+        });
+
+    char label[32];
+    std::snprintf(label, sizeof(label), "[%g, %g)", range[0], range[1]);
+    std::printf("%-14s %16.3e %16.3e %16.3e %16.3e\n", label,
+                adaptive.vertices_per_second, adaptive.circles_per_second,
+                baseline.vertices_per_second, baseline.circles_per_second);
+  }
+  return 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <bob_ross/command_buffer.h>
+#include <bob_ross/types.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+namespace bob_ross {
+
+// Axis aligned box in screen pixels. Starts out empty and grows with Add.
+struct Bounds {
+  float left = std::numeric_limits<float>::infinity();
+  float top = std::numeric_limits<float>::infinity();
+  float right = -std::numeric_limits<float>::infinity();
+  float bottom = -std::numeric_limits<float>::infinity();
+
+  bool empty() const { return !(left < right && top < bottom); }
+
+  void Add(float x, float y) {
+    left = std::min(left, x);
+    top = std::min(top, y);
+    right = std::max(right, x);
+    bottom = std::max(bottom, y);
+  }
+  void Add(const Bounds &other) {
+    left = std::min(left, other.left);
+    top = std::min(top, other.top);
+    right = std::max(right, other.right);
+    bottom = std::max(bottom, other.bottom);
+  }
+  bool Intersects(const Bounds &other) const {
+    return left < other.right && other.left < right && top < other.bottom &&
+           other.top < bottom;
+  }
+};
+
+Bounds RectBounds(const RectInstance &rect);
+Bounds CircleBounds(const CircleInstance &circle);
+Bounds PointsBounds(const Point *points, size_t count);
+
+// Area a drawing command may touch, before antialiasing. Empty for state
+// commands such as kSetFillColor.
+Bounds CommandBounds(CommandRef command);
+
+// Smallest pixel rectangle containing |bounds| grown by |padding| pixels,
+// clipped to a |width| x |height| screen.
+PixelRect ToPixelRect(const Bounds &bounds, float padding, int width,
+                      int height);
+
+}  // namespace bob_ross
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <bob_ross/command_buffer.h>
+#include <bob_ross/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace bob_ross {
+
+// Finds the parts of the screen that changed between two frames by
+// comparing their commands. Every drawing command is reduced to a hash of
+// its contents and fill color plus its pixel bounds. Commands of the new
+// frame are matched in order against the previous one, and the bounds of
+// every command without a match on either side are damaged. Pixels outside
+// the damage are then covered by the same commands in the same order, so
+// they can be kept from the previous frame.
+//
+// Damage is returned as at most kMaxRects disjoint rectangles, so a frame
+// can be redrawn once per rectangle with a scissor without blending any
+// pixel twice.
+class DamageTracker {
+ public:
+  static constexpr size_t kMaxRects = 4;
+  // Oldest back buffer that can be repaired without a full redraw.
+  static constexpr int kMaxBufferAge = 4;
+  // Antialiased edges reach up to a pixel beyond a shape's bounds.
+  static constexpr float kPadding = 1.0f;
+
+  // Sets the screen damage is clipped to and damages all of it.
+  void Resize(int screen_width, int screen_height);
+  // Damages the whole screen in the current frame.
+  void Invalidate() { invalidated_ = true; }
+
+  // Adds the commands of one replay to the current frame.
+  void Record(const CommandBuffer &commands);
+
+  // Finishes the current frame and returns what to redraw in a back buffer
+  // holding the frame |buffer_age| frames back, as reported by
+  // EGL_BUFFER_AGE_KHR. An age of 0 means the contents are unknown and
+  // everything that changed since the last frame is redrawn in full. Empty
+  // when the frame is identical to the previous one, which is then assumed
+  // not to be presented.
+  const std::vector<PixelRect> &Finish(int buffer_age);
+
+ private:
+  struct Entry {
+    uint64_t hash;
+    PixelRect bounds;
+  };
+
+  void MatchAgainstPrevious(std::vector<PixelRect> *damage);
+
+  int screen_width_ = 0, screen_height_ = 0;
+  bool invalidated_ = true;
+  std::vector<Entry> previous_;
+  std::vector<Entry> current_;
+  std::vector<uint32_t> previous_order_;
+  std::vector<uint8_t> previous_matched_;
+  // Damage of the latest presented frames, newest first.
+  std::deque<std::vector<PixelRect>> history_;
+  std::vector<PixelRect> damage_;
+};
+
+}  // namespace bob_ross
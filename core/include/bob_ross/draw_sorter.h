@@ -0,0 +1,84 @@
+#pragma once
+
+#include <bob_ross/command_buffer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bob_ross {
+
+// A drawing command with the packed fill color it is drawn with.
+struct Draw {
+  CommandRef command;
+  uint32_t color;
+};
+
+// Orders the drawing commands of a replay by 64-bit sort keys, so backends
+// can group commands that share GL state without changing the image.
+//
+// Keys are laid out from the most significant bit down as
+//   32 bits  layer, the z of the command's first point
+//   24 bits  overlap level
+//    8 bits  pipeline, the state the backend draws the command with
+// and sorted with a stable LSD radix sort, which skips the bytes every key
+// has in common. Equal keys keep their submission order.
+//
+// Layers put shapes with a greater z over those with a smaller one. Within
+// a layer, a command's level is one above the highest level of any earlier
+// command it overlaps, so commands that share a level never overlap and
+// their pipelines can be drawn in any order. Overlapping commands keep
+// painter's order whether they are opaque or not, which matters because
+// the GL backend blends without a depth buffer.
+//
+// Overlap is tested between pixel bounds. Earlier commands are binned into
+// kCellSize pixel cells, each keeping the bounds of up to kMaxCellEntries
+// commands. Beyond that a cell forgets its lowest entry and only remembers
+// its level as a floor for the whole cell, which can make levels higher
+// than needed but never lower.
+class DrawSorter {
+ public:
+  static constexpr int kCellSize = 64;
+  static constexpr size_t kMaxCellEntries = 16;
+  static constexpr int kPipelineBits = 8;
+
+  // Sets the screen overlap is tested on.
+  void Resize(int screen_width, int screen_height);
+
+  // Returns the drawing commands of |commands| in draw order. |pipelines|
+  // maps every CommandType to the backend's pipeline for it. Without it
+  // only layers are sorted and submission order is kept within them. The
+  // result is valid until the next Sort.
+  const std::vector<Draw> &Sort(const CommandBuffer &commands,
+                                const uint8_t *pipelines);
+
+ private:
+  struct Entry {
+    uint64_t key;
+    uint32_t draw;
+  };
+
+  struct Placed {
+    PixelRect rect;
+    uint32_t level;
+  };
+
+  struct Cell {
+    // Level every command overlapping the cell is above.
+    uint32_t floor = 0;
+    std::vector<Placed> placed;
+  };
+
+  uint32_t AssignLevel(CommandRef command);
+  void RadixSort();
+
+  int screen_width_ = 0, screen_height_ = 0;
+  int cells_x_ = 0, cells_y_ = 0;
+  std::vector<Cell> cells_;
+  std::vector<Draw> draws_;
+  std::vector<Draw> sorted_;
+  std::vector<Entry> entries_;
+  std::vector<Entry> scratch_;
+};
+
+}  // namespace bob_ross
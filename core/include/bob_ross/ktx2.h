@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bob_ross {
+
+// Vulkan format numbers of the block compressed formats KTX2 files are
+// read and written with.
+enum Ktx2Format : uint32_t {
+  kKtx2Etc2Rgb8 = 147,
+  kKtx2Etc2Rgb8Srgb = 148,
+  kKtx2Etc2Rgba8 = 151,
+  kKtx2Etc2Rgba8Srgb = 152,
+  kKtx2Astc4x4 = 157,
+  kKtx2Astc4x4Srgb = 158,
+  kKtx2Astc6x6 = 165,
+  kKtx2Astc6x6Srgb = 166,
+  kKtx2Astc8x8 = 175,
+  kKtx2Astc8x8Srgb = 176,
+};
+
+// Block size of a Ktx2Format, false for formats not listed there.
+bool Ktx2BlockSize(uint32_t format, int *block_width, int *block_height,
+                   int *block_bytes);
+
+// A 2D texture in a KTX2 container. Level data points into the parsed
+// memory, so it is valid as long as that is.
+struct Ktx2Texture {
+  struct Level {
+    const uint8_t *data;
+    // Of the level's blocks, without any padding after them in the file.
+    size_t size;
+    int width, height;
+  };
+
+  uint32_t format = 0;
+  int width = 0, height = 0;
+  // Level 0 first.
+  std::vector<Level> levels;
+};
+
+// Reads a KTX2 container holding a single 2D texture of a Ktx2Format, with
+// no supercompression. Doesn't copy level data. Returns false with a reason
+// in |error| for anything else or a malformed file.
+bool ParseKtx2(const uint8_t *data, size_t size, Ktx2Texture *texture,
+               std::string *error);
+
+// Writes |texture| as a KTX2 container with a data format descriptor
+// matching its format. Levels must be sized for it.
+std::vector<uint8_t> WriteKtx2(const Ktx2Texture &texture);
+
+}  // namespace bob_ross
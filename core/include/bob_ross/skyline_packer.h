@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bob_ross {
+
+// Packs rectangles into a fixed size area without moving those already
+// placed, for texture atlases filled as images are loaded.
+//
+// The free space is tracked as a skyline: the top edge of everything placed
+// so far, as horizontal segments from left to right. A rectangle goes where
+// its top ends up lowest, sitting on the highest segment it spans, and ties
+// go to the segment that leaves the least space unusable under it. Space
+// below the skyline is never reused, which wastes little when rectangles
+// arrive roughly sorted by height and keeps placement linear in the number
+// of segments.
+class SkylinePacker {
+ public:
+  SkylinePacker(int width, int height);
+
+  // Empties the area.
+  void Reset();
+
+  // Places a |width| by |height| rectangle and returns its top left corner
+  // in |x| and |y|. Returns false, leaving the area as is, when it doesn't
+  // fit.
+  bool Pack(int width, int height, int *x, int *y);
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  // Area covered by the rectangles placed since Reset.
+  int64_t used_area() const { return used_area_; }
+  // Segments of the skyline, which placement takes time linear in.
+  size_t segment_count() const { return skyline_.size(); }
+
+ private:
+  struct Segment {
+    int x, y, width;
+  };
+
+  // Top of a |width| wide rectangle sitting on the skyline from segment
+  // |index|, or -1 if it doesn't fit. |waste| is the area left under it.
+  int Fit(size_t index, int width, int height, int64_t *waste) const;
+
+  int width_, height_;
+  int64_t used_area_ = 0;
+  std::vector<Segment> skyline_;
+};
+
+}  // namespace bob_ross
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <bob_ross/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bob_ross {
+
+// Loose quadtree over the shapes of one frame, for hit-testing them.
+//
+// The tree covers the screen rounded up to a power of two. A shape is
+// stored in the single node whose size is at least its extent and whose
+// cell holds its center. Nodes are loose, their bounds are grown by half a
+// cell on every side, so that node contains the whole shape without
+// splitting it. A point query then only needs the at most four nodes per
+// level whose loose bounds contain it.
+//
+// Nodes are not allocated. Every shape gets a key made of its level and
+// cell, and Build sorts the shapes by key, so looking up a node is a binary
+// search. Shapes are added as a frame is recorded and Build runs once at
+// the end.
+class SpatialIndex {
+ public:
+  // Cells at the deepest level are the root size / 2^kMaxDepth.
+  static constexpr int kMaxDepth = 10;
+
+  // Drops every shape and sets the area queries are answered for.
+  void Reset(int screen_width, int screen_height);
+
+  // |id| identifies the shape in HitTest results. The shape's z is that of
+  // its first point. Polygons without indices are simple outlines,
+  // otherwise every three indices form a triangle.
+  void AddRect(uint32_t id, const RectInstance &rect);
+  void AddCircle(uint32_t id, const CircleInstance &circle);
+  void AddPolygon(uint32_t id, const Point *points, size_t point_count,
+                  const uint32_t *indices, size_t index_count);
+
+  // Shapes added from now on are replayed after those added before, so
+  // they are drawn above them whatever their z.
+  void NextReplay() { replay_++; }
+
+  // Sorts the shapes added since Reset. Must run before HitTest.
+  void Build();
+
+  // Id of the topmost shape containing |point|, or -1 if there is none. That
+  // is the one from the latest replay, then with the greatest z, then with
+  // the highest id.
+  int64_t HitTest(Point point) const;
+
+  size_t size() const { return shapes_.size(); }
+
+ private:
+  struct Shape {
+    enum class Kind : uint8_t { kRect, kCircle, kPolygon };
+    uint64_t key;
+    uint32_t id;
+    float z;
+    Kind kind;
+    // Rect corners, or circle center and radius.
+    float params[4] = {};
+    // Range of the polygon's points and indices in points_ and indices_.
+    uint32_t first_point = 0, point_count = 0;
+    uint32_t first_index = 0, index_count = 0;
+    // NextReplay calls before the shape was added.
+    uint32_t replay = 0;
+  };
+
+  void Add(Shape shape, float left, float top, float right, float bottom);
+  bool Contains(const Shape &shape, float x, float y) const;
+
+  int width_ = 0, height_ = 0;
+  float root_size_ = 1;
+  uint32_t replay_ = 0;
+  std::vector<Shape> shapes_;
+  std::vector<Point> points_;
+  std::vector<uint32_t> indices_;
+};
+
+}  // namespace bob_ross
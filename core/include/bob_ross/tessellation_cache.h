@@ -0,0 +1,76 @@
+#pragma once
+
+#include <bob_ross/command_buffer.h>
+#include <bob_ross/tessellator.h>
+#include <bob_ross/triangulator.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace bob_ross {
+
+// Keeps the triangulation of polygon outlines between frames, so outlines
+// that are drawn again are not ear clipped again.
+//
+// Entries are keyed by the outline relative to its first point, so a
+// polygon that only moved reuses the triangles of its previous position.
+// The color and the position are applied when the cached triangles are
+// appended. Outlines are compared in full on a hit, a hash collision never
+// returns the wrong triangles.
+//
+// The cache holds at most |budget_bytes| of outlines and indices. The
+// least recently used entries are evicted to stay within it.
+class TessellationCache {
+ public:
+  // Enough for a few thousand typical UI outlines.
+  static constexpr size_t kDefaultBudgetBytes = 4 << 20;
+  // Smaller outlines are cheaper to triangulate than to look up.
+  static constexpr uint32_t kMinPoints = 5;
+
+  explicit TessellationCache(size_t budget_bytes = kDefaultBudgetBytes);
+
+  // Same as the free TessellatePolygon. Outlines without indices are
+  // looked up in the cache and triangulated with |triangulator| on a miss.
+  void TessellatePolygon(const PolygonCommand &polygon, uint32_t color,
+                         Triangulator *triangulator, Mesh *mesh);
+
+  // Evicts entries until the cache fits |budget_bytes|. 0 disables it.
+  void SetBudget(size_t budget_bytes);
+  void Clear();
+
+  size_t budget_bytes() const { return budget_bytes_; }
+  size_t size_bytes() const { return size_bytes_; }
+  size_t entry_count() const { return entries_.size(); }
+  // Lookups since construction, for tuning the budget.
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  struct Entry {
+    uint64_t hash;
+    // The outline with the first point moved to the origin.
+    std::vector<Point> outline;
+    // Triangles indexing into the outline.
+    std::vector<uint32_t> indices;
+  };
+
+  static size_t EntryBytes(const Entry &entry);
+  const Entry *Find(uint64_t hash, const std::vector<Point> &outline);
+  void Insert(Entry entry);
+  void EvictToBudget(size_t budget_bytes);
+
+  size_t budget_bytes_;
+  size_t size_bytes_ = 0;
+  uint64_t hits_ = 0, misses_ = 0;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_multimap<uint64_t, std::list<Entry>::iterator> index_;
+  // Scratch space reused between lookups.
+  std::vector<Point> outline_;
+  std::vector<uint32_t> indices_;
+};
+
+}  // namespace bob_ross
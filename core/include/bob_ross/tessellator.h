@@ -0,0 +1,49 @@
+#pragma once
+
+#include <bob_ross/command_buffer.h>
+#include <bob_ross/triangulator.h>
+#include <bob_ross/types.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace bob_ross {
+
+// Vertex layout shared by the triangle mesh backends. Positions are in screen
+// pixels with the origin at the top left, the color is RGBA8.
+struct Vertex {
+  float x, y, z;
+  uint32_t color;
+};
+
+struct Mesh {
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+
+  void Clear() {
+    vertices.clear();
+    indices.clear();
+  }
+};
+
+// Default upper bound, in pixels, on the distance between a tessellated
+// curve and the true outline.
+constexpr float kDefaultMaxError = 0.25f;
+
+// Number of segments needed for a circle of |radius| pixels to stay within
+// |max_error| pixels of the true circle. Rounded up to one of the
+// precomputed unit circle tables.
+int CircleSegmentCount(float radius, float max_error);
+
+// Packs a Color into RGBA8 in memory order, clamping every channel.
+uint32_t PackColor(Color color);
+
+// The Tessellate* functions append triangles for the shape to |mesh|.
+void TessellateRect(const RectInstance &rect, uint32_t color, Mesh *mesh);
+void TessellateCircle(const CircleInstance &circle, uint32_t color,
+                      float max_error, Mesh *mesh);
+// Outlines without indices are triangulated with |triangulator|.
+void TessellatePolygon(const PolygonCommand &polygon, uint32_t color,
+                       Triangulator *triangulator, Mesh *mesh);
+
+}  // namespace bob_ross
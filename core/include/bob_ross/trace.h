@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace bob_ross {
+
+// A completed scope. |name| must outlive the tracer, usually a literal.
+struct TraceEvent {
+  const char *name;
+  int64_t start_ns;
+  int64_t duration_ns;
+  uint32_t track;
+};
+
+// Collects timed scopes from every thread into a fixed size ring buffer, so
+// the last few frames can be dumped when one of them spikes. The dump is
+// Chrome trace JSON, which chrome://tracing and ui.perfetto.dev both open.
+//
+// Tracing is off until Enable is called. While off, a scope costs a relaxed
+// atomic load and a branch. Building with BOB_ROSS_DISABLE_TRACING removes
+// the scopes altogether.
+class Tracer {
+ public:
+  static constexpr size_t kDefaultCapacity = 1 << 16;
+  // Track of events measured on the GPU. CPU threads get tracks from 1 up.
+  static constexpr uint32_t kGpuTrack = 0;
+
+  static Tracer &Get();
+
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+  // Starts recording, keeping the latest |capacity| events.
+  void Enable(size_t capacity = kDefaultCapacity);
+  // Stops recording. Recorded events are kept until the next Enable.
+  void Disable();
+
+  void Record(const char *name, int64_t start_ns, int64_t duration_ns,
+              uint32_t track);
+
+  // Monotonic clock all events are measured against.
+  static int64_t NowNs();
+  // Track of the calling thread.
+  static uint32_t CurrentTrack();
+
+  // Recorded events, oldest first.
+  std::vector<TraceEvent> Events() const;
+  std::string ToChromeJson() const;
+  bool WriteChromeJson(const char *path) const;
+
+ private:
+  Tracer() = default;
+
+  static std::atomic<bool> enabled_;
+  mutable std::mutex mutex_;
+  std::vector<TraceEvent> events_;
+  size_t next_ = 0;
+  bool wrapped_ = false;
+};
+
+// Records the time between its construction and destruction.
+class TraceScope {
+ public:
+  explicit TraceScope(const char *name)
+      : name_(Tracer::enabled() ? name : nullptr) {
+    if (name_) {
+      start_ns_ = Tracer::NowNs();
+    }
+  }
+  ~TraceScope() {
+    if (name_) {
+      Tracer::Get().Record(name_, start_ns_, Tracer::NowNs() - start_ns_,
+                           Tracer::CurrentTrack());
+    }
+  }
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+ private:
+  const char *name_;
+  int64_t start_ns_ = 0;
+};
+
+}  // namespace bob_ross
+
+#define BOB_ROSS_TRACE_CONCAT_INNER(a, b) a##b
+#define BOB_ROSS_TRACE_CONCAT(a, b) BOB_ROSS_TRACE_CONCAT_INNER(a, b)
+
+#ifdef BOB_ROSS_DISABLE_TRACING
+#define BOB_ROSS_TRACE_SCOPE(name)
+#else
+// Times the rest of the enclosing block under |name|.
+#define BOB_ROSS_TRACE_SCOPE(name) \
+  ::bob_ross::TraceScope BOB_ROSS_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#endif
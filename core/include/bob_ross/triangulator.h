@@ -0,0 +1,54 @@
+#pragma once
+
+#include <bob_ross/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bob_ross {
+
+// Triangulates simple polygon outlines by ear clipping. Outlines with more
+// than kHashThreshold points index their vertices along a z-order curve so
+// each ear test only looks at nearby points, which keeps large outlines
+// close to O(n log n). Self intersecting or degenerate input still produces
+// triangles, though not necessarily a perfect cover.
+//
+// The node storage is kept between calls, so reuse one Triangulator for
+// every polygon of a frame.
+class Triangulator {
+ public:
+  static constexpr size_t kHashThreshold = 80;
+
+  // Vertex of the outline being clipped, defined in triangulator.cc.
+  struct Node;
+
+  Triangulator();
+  ~Triangulator();
+
+  // Appends the triangles of the outline |points[0..count)| to |indices|,
+  // offset by |base|. Index must be uint16_t or uint32_t.
+  template <typename Index>
+  void Triangulate(const Point *points, size_t count, Index base,
+                   std::vector<Index> *indices);
+
+ private:
+  Node *CreateNode(uint32_t i, float x, float y);
+  Node *InsertNode(uint32_t i, float x, float y, Node *last);
+  Node *LinkedList(const Point *points, size_t count);
+  Node *FilterPoints(Node *start, Node *end = nullptr);
+  void EarcutLinked(Node *ear, int pass);
+  bool IsEar(Node *ear) const;
+  bool IsEarHashed(Node *ear) const;
+  Node *CureLocalIntersections(Node *start);
+  void SplitEarcut(Node *start);
+  void IndexCurve(Node *start) const;
+  int32_t ZOrder(float x, float y) const;
+  void Emit(uint32_t a, uint32_t b, uint32_t c);
+
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> triangles_;
+  float min_x_ = 0, min_y_ = 0, inv_size_ = 0;
+};
+
+}  // namespace bob_ross
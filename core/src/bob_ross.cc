@@ -0,0 +1,317 @@
+#include <bob_ross/bob_ross.h>
+#include <bob_ross/bounds.h>
+#include <bob_ross/damage_tracker.h>
+#include <bob_ross/spatial_index.h>
+#include <bob_ross/trace.h>
+
+#include <cstring>
+
+namespace bob_ross {
+namespace {
+
+// Antialiased edges reach a pixel past a shape's bounds.
+constexpr float kCullPadding = 1.0f;
+
+}  // namespace
+
+BobRoss::BobRoss(int screen_width, int screen_height)
+    : BobRoss(screen_width, screen_height, nullptr) {}
+
+BobRoss::BobRoss(int screen_width, int screen_height,
+                 std::unique_ptr<Backend> backend)
+    : screen_width_(screen_width),
+      screen_height_(screen_height),
+      backend_(std::move(backend)) {
+  if (backend_) {
+    backend_->Resize(screen_width_, screen_height_);
+  }
+}
+
+BobRoss::~BobRoss() = default;
+
+void BobRoss::UpdateScreenDimension(int screen_width, int screen_height) {
+  if (screen_width == screen_width_ && screen_height == screen_height_) {
+    return;
+  }
+  // Commands recorded so far were meant for the old dimensions.
+  Flush();
+  screen_width_ = screen_width;
+  screen_height_ = screen_height;
+  if (backend_) {
+    backend_->Resize(screen_width_, screen_height_);
+  }
+  if (damage_tracker_) {
+    damage_tracker_->Resize(screen_width_, screen_height_);
+  }
+}
+
+void BobRoss::BeginFrame() {
+  commands_.Reset();
+  deferred_flushes_.clear();
+  fill_color_dirty_ = true;
+  damage_computed_ = false;
+  next_shape_id_ = 0;
+  if (recording_index_) {
+    recording_index_->Reset(screen_width_, screen_height_);
+  }
+  if (backend_) {
+    backend_->BeginFrame();
+  }
+}
+
+void BobRoss::EndFrame() {
+  if (damage_tracker_ && !damage_computed_) {
+    ComputeDamage(0);
+  }
+  Flush();
+  if (backend_) {
+    backend_->EndFrame();
+  }
+  if (recording_index_) {
+    recording_index_->Build();
+    std::swap(recording_index_, hit_index_);
+  }
+}
+
+void BobRoss::Flush() {
+  if (commands_.empty()) {
+    return;
+  }
+  // Backends don't carry the fill color between replays.
+  fill_color_dirty_ = true;
+  if (recording_index_) {
+    recording_index_->NextReplay();
+  }
+  if (damage_tracker_ && !damage_computed_) {
+    // Replayed once the damage is known, still split where the calls were,
+    // since z only orders shapes within a replay.
+    if (deferred_flushes_.empty() ||
+        deferred_flushes_.back() != commands_.byte_size()) {
+      deferred_flushes_.push_back(commands_.byte_size());
+    }
+    return;
+  }
+  BOB_ROSS_TRACE_SCOPE("BobRoss::Flush");
+  if (backend_) {
+    if (deferred_flushes_.empty()) {
+      backend_->Replay(commands_);
+    } else {
+      size_t begin = 0;
+      deferred_flushes_.push_back(commands_.byte_size());
+      for (size_t end : deferred_flushes_) {
+        if (end == begin) {
+          continue;
+        }
+        replay_.Reset();
+        replay_.AppendRange(commands_, begin, end);
+        backend_->Replay(replay_);
+        begin = end;
+      }
+    }
+  }
+  commands_.Reset();
+  deferred_flushes_.clear();
+}
+
+void BobRoss::EnableDamageTracking(bool enable) {
+  if (!enable) {
+    damage_tracker_.reset();
+    return;
+  }
+  if (!damage_tracker_) {
+    damage_tracker_ = std::make_unique<DamageTracker>();
+    damage_tracker_->Resize(screen_width_, screen_height_);
+  }
+}
+
+void BobRoss::InvalidateDamage() {
+  if (damage_tracker_) {
+    damage_tracker_->Invalidate();
+  }
+}
+
+const std::vector<PixelRect> &BobRoss::ComputeDamage(int buffer_age) {
+  if (!damage_tracker_) {
+    untracked_damage_ = {{0, 0, screen_width_, screen_height_}};
+    return untracked_damage_;
+  }
+  damage_tracker_->Record(commands_);
+  const std::vector<PixelRect> &damage = damage_tracker_->Finish(buffer_age);
+  damage_computed_ = true;
+  if (damage.empty()) {
+    // Identical to what is on screen, nothing to replay.
+    commands_.Reset();
+    deferred_flushes_.clear();
+    fill_color_dirty_ = true;
+  }
+  if (backend_) {
+    backend_->SetClipRects(damage.data(), damage.size());
+  }
+  return damage;
+}
+
+void BobRoss::EnableHitTesting(bool enable) {
+  if (!enable) {
+    recording_index_.reset();
+    hit_index_.reset();
+    return;
+  }
+  if (!recording_index_) {
+    recording_index_ = std::make_unique<SpatialIndex>();
+    recording_index_->Reset(screen_width_, screen_height_);
+    hit_index_ = std::make_unique<SpatialIndex>();
+  }
+}
+
+int64_t BobRoss::HitTest(Point point) const {
+  return hit_index_ ? hit_index_->HitTest(point) : -1;
+}
+
+bool BobRoss::IsOnScreen(const Bounds &bounds) const {
+  return bounds.Intersects({-kCullPadding, -kCullPadding,
+                            screen_width_ + kCullPadding,
+                            screen_height_ + kCullPadding});
+}
+
+void BobRoss::SetFillColor(Color color) {
+  fill_color_ = color;
+  fill_color_dirty_ = true;
+}
+
+void BobRoss::EmitFillColor() {
+  if (!fill_color_dirty_) {
+    return;
+  }
+  commands_.Append<SetFillColorCommand>()->color = fill_color_;
+  fill_color_dirty_ = false;
+}
+
+void BobRoss::Circle(Point origin, float radius) {
+  uint32_t id = next_shape_id_++;
+  if (!IsOnScreen(CircleBounds({origin, radius}))) {
+    return;
+  }
+  if (recording_index_) {
+    recording_index_->AddCircle(id, {origin, radius});
+  }
+  EmitFillColor();
+  auto *command = commands_.Append<CircleCommand>();
+  command->origin = origin;
+  command->radius = radius;
+}
+
+void BobRoss::Polygon(const std::vector<Point> &points) {
+  Polygon(points.data(), points.size(), nullptr, 0);
+}
+
+void BobRoss::Polygon(const Point *points, size_t point_count) {
+  Polygon(points, point_count, nullptr, 0);
+}
+
+void BobRoss::Polygon(const std::vector<Point> &points,
+                      const std::vector<uint32_t> &indexes) {
+  Polygon(points.data(), points.size(), indexes.data(), indexes.size());
+}
+
+void BobRoss::Polygon(const Point *points, size_t point_count,
+                      const uint32_t *indexes, size_t index_count) {
+  uint32_t id = next_shape_id_++;
+  if (point_count < 3 || !IsOnScreen(PointsBounds(points, point_count))) {
+    return;
+  }
+  if (recording_index_) {
+    recording_index_->AddPolygon(id, points, point_count, indexes,
+                                 index_count);
+  }
+  EmitFillColor();
+  auto *command = commands_.Append<PolygonCommand>(
+      point_count * sizeof(Point) + index_count * sizeof(uint32_t));
+  command->point_count = static_cast<uint32_t>(point_count);
+  command->index_count = static_cast<uint32_t>(index_count);
+  std::memcpy(command->points(), points, point_count * sizeof(Point));
+  if (index_count) {
+    std::memcpy(command->indices(), indexes, index_count * sizeof(uint32_t));
+  }
+}
+
+void BobRoss::Rect(Point top_left, Point bottom_right) {
+  uint32_t id = next_shape_id_++;
+  if (!IsOnScreen(RectBounds({top_left, bottom_right}))) {
+    return;
+  }
+  if (recording_index_) {
+    recording_index_->AddRect(id, {top_left, bottom_right});
+  }
+  EmitFillColor();
+  auto *command = commands_.Append<RectCommand>();
+  command->top_left = top_left;
+  command->bottom_right = bottom_right;
+}
+
+void BobRoss::Circles(const CircleInstance *circles, size_t count) {
+  uint32_t first_id = next_shape_id_;
+  next_shape_id_ += static_cast<uint32_t>(count);
+  if (!count) {
+    return;
+  }
+  // Culls straight into a command sized for every element, then trims it
+  // to those on screen. The fill color stays emitted if none are.
+  EmitFillColor();
+  auto *command =
+      commands_.Append<CirclesCommand>(count * sizeof(CircleInstance));
+  CircleInstance *out = command->circles();
+  uint32_t visible = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (IsOnScreen(CircleBounds(circles[i]))) {
+      out[visible++] = circles[i];
+      if (recording_index_) {
+        recording_index_->AddCircle(static_cast<uint32_t>(first_id + i),
+                                    circles[i]);
+      }
+    }
+  }
+  if (!visible) {
+    commands_.DropLast();
+    return;
+  }
+  command->count = visible;
+  commands_.ShrinkLast<CirclesCommand>(visible * sizeof(CircleInstance));
+}
+
+void BobRoss::Rects(const RectInstance *rects, size_t count) {
+  uint32_t first_id = next_shape_id_;
+  next_shape_id_ += static_cast<uint32_t>(count);
+  if (!count) {
+    return;
+  }
+  // Culls straight into a command sized for every element, then trims it
+  // to those on screen. The fill color stays emitted if none are.
+  EmitFillColor();
+  auto *command =
+      commands_.Append<RectsCommand>(count * sizeof(RectInstance));
+  RectInstance *out = command->rects();
+  uint32_t visible = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (IsOnScreen(RectBounds(rects[i]))) {
+      out[visible++] = rects[i];
+      if (recording_index_) {
+        recording_index_->AddRect(static_cast<uint32_t>(first_id + i),
+                                  rects[i]);
+      }
+    }
+  }
+  if (!visible) {
+    commands_.DropLast();
+    return;
+  }
+  command->count = visible;
+  commands_.ShrinkLast<RectsCommand>(visible * sizeof(RectInstance));
+}
+
+void BobRoss::Polygons(const PolygonOutline *polygons, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    Polygon(polygons[i].points, polygons[i].point_count, nullptr, 0);
+  }
+}
+
+}  // namespace bob_ross
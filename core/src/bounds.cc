@@ -0,0 +1,78 @@
+#include <bob_ross/bounds.h>
+
+#include <cmath>
+
+namespace bob_ross {
+
+Bounds RectBounds(const RectInstance &rect) {
+  Bounds bounds;
+  bounds.Add(rect.top_left.x, rect.top_left.y);
+  bounds.Add(rect.bottom_right.x, rect.bottom_right.y);
+  return bounds;
+}
+
+Bounds CircleBounds(const CircleInstance &circle) {
+  float radius = std::fabs(circle.radius);
+  return {circle.origin.x - radius, circle.origin.y - radius,
+          circle.origin.x + radius, circle.origin.y + radius};
+}
+
+Bounds PointsBounds(const Point *points, size_t count) {
+  Bounds bounds;
+  for (size_t i = 0; i < count; i++) {
+    bounds.Add(points[i].x, points[i].y);
+  }
+  return bounds;
+}
+
+Bounds CommandBounds(CommandRef command) {
+  Bounds bounds;
+  switch (command.type) {
+    case CommandType::kSetFillColor:
+      break;
+    case CommandType::kCircle:
+      bounds = CircleBounds(command.As<CircleCommand>());
+      break;
+    case CommandType::kRect:
+      bounds = RectBounds(command.As<RectCommand>());
+      break;
+    case CommandType::kPolygon: {
+      const auto &polygon = command.As<PolygonCommand>();
+      bounds = PointsBounds(polygon.points(), polygon.point_count);
+      break;
+    }
+    case CommandType::kCircles: {
+      const auto &circles = command.As<CirclesCommand>();
+      for (uint32_t i = 0; i < circles.count; i++) {
+        bounds.Add(CircleBounds(circles.circles()[i]));
+      }
+      break;
+    }
+    case CommandType::kRects: {
+      const auto &rects = command.As<RectsCommand>();
+      for (uint32_t i = 0; i < rects.count; i++) {
+        bounds.Add(RectBounds(rects.rects()[i]));
+      }
+      break;
+    }
+  }
+  return bounds;
+}
+
+PixelRect ToPixelRect(const Bounds &bounds, float padding, int width,
+                      int height) {
+  if (bounds.empty()) {
+    return {0, 0, 0, 0};
+  }
+  // Clamp in float first, the bounds may be far outside the int range.
+  auto clamp = [](float value, int limit) {
+    return static_cast<int>(std::min(std::max(value, 0.0f),
+                                     static_cast<float>(limit)));
+  };
+  return {clamp(std::floor(bounds.left - padding), width),
+          clamp(std::floor(bounds.top - padding), height),
+          clamp(std::ceil(bounds.right + padding), width),
+          clamp(std::ceil(bounds.bottom + padding), height)};
+}
+
+}  // namespace bob_ross
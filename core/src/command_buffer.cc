@@ -0,0 +1,93 @@
+#include <bob_ross/command_buffer.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace bob_ross {
+namespace {
+
+constexpr size_t kInitialCapacity = 16 * 1024;
+
+constexpr size_t AlignUp(size_t size) {
+  return (size + kCommandAlignment - 1) & ~(kCommandAlignment - 1);
+}
+
+static_assert(sizeof(CommandHeader) % kCommandAlignment == 0,
+              "Command records must stay aligned");
+
+}  // namespace
+
+void CommandBuffer::Reset() {
+  size_ = 0;
+  command_count_ = 0;
+}
+
+void *CommandBuffer::Allocate(CommandType type, size_t size) {
+  size_t record_size = AlignUp(size);
+  size_t needed = size_ + sizeof(CommandHeader) + record_size;
+  if (needed > capacity_) {
+    Grow(needed);
+  }
+  uint8_t *cursor = storage_.get() + size_;
+  last_ = size_;
+  auto *header = reinterpret_cast<CommandHeader *>(cursor);
+  header->type = type;
+  header->size = static_cast<uint32_t>(record_size);
+  size_ = needed;
+  command_count_++;
+  return cursor + sizeof(CommandHeader);
+}
+
+void CommandBuffer::Shrink(size_t size) {
+  auto *header = reinterpret_cast<CommandHeader *>(storage_.get() + last_);
+  size_t record_size = AlignUp(size);
+  assert(record_size <= header->size);
+  header->size = static_cast<uint32_t>(record_size);
+  size_ = last_ + sizeof(CommandHeader) + record_size;
+}
+
+void CommandBuffer::DropLast() {
+  assert(command_count_ > 0);
+  size_ = last_;
+  command_count_--;
+}
+
+void CommandBuffer::AppendRange(const CommandBuffer &source, size_t begin,
+                                size_t end) {
+  assert(begin <= end && end <= source.size_);
+  if (begin == end) {
+    return;
+  }
+  if (size_ + end - begin > capacity_) {
+    Grow(size_ + end - begin);
+  }
+  // Records are position independent, so the range is copied whole and
+  // only walked to count it.
+  std::memcpy(storage_.get() + size_, source.storage_.get() + begin,
+              end - begin);
+  for (size_t offset = begin; offset < end;) {
+    last_ = size_ + offset - begin;
+    auto *header =
+        reinterpret_cast<const CommandHeader *>(source.storage_.get() + offset);
+    offset += sizeof(CommandHeader) + header->size;
+    command_count_++;
+  }
+  size_ += end - begin;
+}
+
+void CommandBuffer::Grow(size_t min_capacity) {
+  size_t capacity = std::max(capacity_ * 2, kInitialCapacity);
+  while (capacity < min_capacity) {
+    capacity *= 2;
+  }
+  // Commands are trivially copyable, so moving them is a memcpy.
+  std::unique_ptr<uint8_t[]> storage(new uint8_t[capacity]);
+  if (size_) {
+    std::memcpy(storage.get(), storage_.get(), size_);
+  }
+  storage_ = std::move(storage);
+  capacity_ = capacity;
+}
+
+}  // namespace bob_ross
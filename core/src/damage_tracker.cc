@@ -0,0 +1,201 @@
+#include <bob_ross/bounds.h>
+#include <bob_ross/damage_tracker.h>
+
+#include <algorithm>
+
+namespace bob_ross {
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t Hash(const void *data, size_t size, uint64_t hash) {
+  auto *bytes = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+// Bytes of a command that affect its pixels. The padding the buffer adds
+// after a record is left uninitialized, so it can't be hashed.
+size_t ContentSize(CommandRef command) {
+  switch (command.type) {
+    case CommandType::kSetFillColor:
+      return sizeof(SetFillColorCommand);
+    case CommandType::kCircle:
+      return sizeof(CircleCommand);
+    case CommandType::kRect:
+      return sizeof(RectCommand);
+    case CommandType::kPolygon: {
+      const auto &polygon = command.As<PolygonCommand>();
+      return sizeof(PolygonCommand) + polygon.point_count * sizeof(Point) +
+             polygon.index_count * sizeof(uint32_t);
+    }
+    case CommandType::kCircles:
+      return sizeof(CirclesCommand) +
+             command.As<CirclesCommand>().count * sizeof(CircleInstance);
+    case CommandType::kRects:
+      return sizeof(RectsCommand) +
+             command.As<RectsCommand>().count * sizeof(RectInstance);
+  }
+  return 0;
+}
+
+bool IsEmpty(const PixelRect &rect) {
+  return rect.left >= rect.right || rect.top >= rect.bottom;
+}
+
+bool Overlaps(const PixelRect &a, const PixelRect &b) {
+  return a.left < b.right && b.left < a.right && a.top < b.bottom &&
+         b.top < a.bottom;
+}
+
+PixelRect Union(const PixelRect &a, const PixelRect &b) {
+  return {std::min(a.left, b.left), std::min(a.top, b.top),
+          std::max(a.right, b.right), std::max(a.bottom, b.bottom)};
+}
+
+int64_t Area(const PixelRect &rect) {
+  return static_cast<int64_t>(rect.right - rect.left) *
+         (rect.bottom - rect.top);
+}
+
+// Adds |rect| to |rects|, merging it into the rectangle that grows the least
+// once there are kMaxRects.
+void AddRect(const PixelRect &rect, std::vector<PixelRect> *rects) {
+  if (IsEmpty(rect)) {
+    return;
+  }
+  if (rects->size() < DamageTracker::kMaxRects) {
+    rects->push_back(rect);
+    return;
+  }
+  PixelRect *best = nullptr;
+  int64_t best_growth = 0;
+  for (PixelRect &existing : *rects) {
+    int64_t growth = Area(Union(existing, rect)) - Area(existing);
+    if (!best || growth < best_growth) {
+      best = &existing;
+      best_growth = growth;
+    }
+  }
+  *best = Union(*best, rect);
+}
+
+// Merges overlapping rectangles until none overlap.
+void MakeDisjoint(std::vector<PixelRect> *rects) {
+  for (size_t i = 0; i < rects->size(); i++) {
+    for (size_t j = i + 1; j < rects->size(); j++) {
+      if (Overlaps((*rects)[i], (*rects)[j])) {
+        (*rects)[i] = Union((*rects)[i], (*rects)[j]);
+        rects->erase(rects->begin() + j);
+        // The grown rectangle may now overlap ones already checked.
+        i = static_cast<size_t>(-1);
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void DamageTracker::Resize(int screen_width, int screen_height) {
+  screen_width_ = screen_width;
+  screen_height_ = screen_height;
+  invalidated_ = true;
+}
+
+void DamageTracker::Record(const CommandBuffer &commands) {
+  // Replays start from the default color, like the backends.
+  const Color default_color = {0, 0, 0, 255};
+  uint64_t color_hash = Hash(&default_color, sizeof(Color), kFnvOffset);
+  for (CommandRef command : commands) {
+    if (command.type == CommandType::kSetFillColor) {
+      color_hash = Hash(&command.As<SetFillColorCommand>().color,
+                        sizeof(Color), kFnvOffset);
+      continue;
+    }
+    uint64_t hash = Hash(&command.type, sizeof(command.type), color_hash);
+    hash = Hash(command.data, ContentSize(command), hash);
+    current_.push_back({hash, ToPixelRect(CommandBounds(command), kPadding,
+                                          screen_width_, screen_height_)});
+  }
+}
+
+const std::vector<PixelRect> &DamageTracker::Finish(int buffer_age) {
+  std::vector<PixelRect> frame_damage;
+  if (invalidated_) {
+    frame_damage.push_back({0, 0, screen_width_, screen_height_});
+    history_.clear();
+  } else {
+    MatchAgainstPrevious(&frame_damage);
+    MakeDisjoint(&frame_damage);
+  }
+  invalidated_ = false;
+  std::swap(previous_, current_);
+  current_.clear();
+
+  damage_.clear();
+  if (frame_damage.empty() || IsEmpty(frame_damage.front())) {
+    return damage_;
+  }
+  history_.push_front(std::move(frame_damage));
+  if (history_.size() > static_cast<size_t>(kMaxBufferAge)) {
+    history_.pop_back();
+  }
+  if (buffer_age <= 0 || static_cast<size_t>(buffer_age) > history_.size()) {
+    // The back buffer predates the frames we know about.
+    damage_.push_back({0, 0, screen_width_, screen_height_});
+    return damage_;
+  }
+  for (int age = 0; age < buffer_age; age++) {
+    for (const PixelRect &rect : history_[age]) {
+      AddRect(rect, &damage_);
+    }
+  }
+  MakeDisjoint(&damage_);
+  return damage_;
+}
+
+// Walks the current frame in order and matches every command to the next
+// identical one in the previous frame, skipping over previous commands that
+// have no counterpart. Matched pairs keep their relative order, so only
+// the unmatched commands of both frames change pixels.
+void DamageTracker::MatchAgainstPrevious(std::vector<PixelRect> *damage) {
+  previous_order_.resize(previous_.size());
+  for (uint32_t i = 0; i < previous_order_.size(); i++) {
+    previous_order_[i] = i;
+  }
+  std::sort(previous_order_.begin(), previous_order_.end(),
+            [this](uint32_t a, uint32_t b) {
+              return previous_[a].hash < previous_[b].hash ||
+                     (previous_[a].hash == previous_[b].hash && a < b);
+            });
+  previous_matched_.assign(previous_.size(), 0);
+
+  int64_t last_match = -1;
+  for (const Entry &entry : current_) {
+    // The first occurrence of the same command after the last match.
+    auto match = std::lower_bound(
+        previous_order_.begin(), previous_order_.end(), entry.hash,
+        [&](uint32_t index, uint64_t hash) {
+          return previous_[index].hash < hash ||
+                 (previous_[index].hash == hash && index <= last_match);
+        });
+    if (match != previous_order_.end() &&
+        previous_[*match].hash == entry.hash) {
+      previous_matched_[*match] = 1;
+      last_match = *match;
+    } else {
+      AddRect(entry.bounds, damage);
+    }
+  }
+  for (size_t i = 0; i < previous_.size(); i++) {
+    if (!previous_matched_[i]) {
+      AddRect(previous_[i].bounds, damage);
+    }
+  }
+}
+
+}  // namespace bob_ross
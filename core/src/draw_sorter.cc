@@ -0,0 +1,179 @@
+#include <bob_ross/bounds.h>
+#include <bob_ross/draw_sorter.h>
+#include <bob_ross/tessellator.h>
+#include <bob_ross/trace.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace bob_ross {
+namespace {
+
+constexpr uint32_t kMaxLevel = (1u << 24) - 1;
+// Shapes antialiased by the GL backend reach a pixel past their bounds.
+constexpr float kPadding = 1.0f;
+
+float FirstZ(CommandRef command) {
+  switch (command.type) {
+    case CommandType::kSetFillColor:
+      break;
+    case CommandType::kCircle:
+      return command.As<CircleCommand>().origin.z;
+    case CommandType::kRect:
+      return command.As<RectCommand>().top_left.z;
+    case CommandType::kPolygon: {
+      const auto &polygon = command.As<PolygonCommand>();
+      return polygon.point_count ? polygon.points()[0].z : 0;
+    }
+    case CommandType::kCircles: {
+      const auto &circles = command.As<CirclesCommand>();
+      return circles.count ? circles.circles()[0].origin.z : 0;
+    }
+    case CommandType::kRects: {
+      const auto &rects = command.As<RectsCommand>();
+      return rects.count ? rects.rects()[0].top_left.z : 0;
+    }
+  }
+  return 0;
+}
+
+bool Overlaps(const PixelRect &a, const PixelRect &b) {
+  return a.left < b.right && b.left < a.right && a.top < b.bottom &&
+         b.top < a.bottom;
+}
+
+// Maps floats to unsigned integers of the same order.
+uint32_t LayerOf(float z) {
+  z += 0.0f;  // -0 to +0, so both are one layer.
+  uint32_t bits;
+  std::memcpy(&bits, &z, sizeof(bits));
+  return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+}
+
+}  // namespace
+
+void DrawSorter::Resize(int screen_width, int screen_height) {
+  screen_width_ = std::max(screen_width, 0);
+  screen_height_ = std::max(screen_height, 0);
+  cells_x_ = (screen_width_ + kCellSize - 1) / kCellSize;
+  cells_y_ = (screen_height_ + kCellSize - 1) / kCellSize;
+  cells_.assign(static_cast<size_t>(cells_x_) * cells_y_, {});
+}
+
+const std::vector<Draw> &DrawSorter::Sort(const CommandBuffer &commands,
+                                          const uint8_t *pipelines) {
+  draws_.clear();
+  entries_.clear();
+  if (pipelines) {
+    for (Cell &cell : cells_) {
+      cell.floor = 0;
+      cell.placed.clear();
+    }
+  }
+  uint32_t color = PackColor({0, 0, 0, 255});
+  bool in_order = true;
+  for (CommandRef command : commands) {
+    if (command.type == CommandType::kSetFillColor) {
+      color = PackColor(command.As<SetFillColorCommand>().color);
+      continue;
+    }
+    uint64_t key = static_cast<uint64_t>(LayerOf(FirstZ(command))) << 32;
+    if (pipelines) {
+      uint32_t level = AssignLevel(command);
+      // Reversing the pipeline order on odd levels lets the last pipeline
+      // of one level continue into the next.
+      uint32_t pipeline = pipelines[static_cast<size_t>(command.type)];
+      if (level & 1) {
+        pipeline ^= (1u << kPipelineBits) - 1;
+      }
+      key |= static_cast<uint64_t>(level) << kPipelineBits | pipeline;
+    }
+    in_order = in_order && (entries_.empty() || entries_.back().key <= key);
+    entries_.push_back({key, static_cast<uint32_t>(draws_.size())});
+    draws_.push_back({command, color});
+  }
+  if (in_order) {
+    return draws_;
+  }
+
+  BOB_ROSS_TRACE_SCOPE("DrawSorter::Sort");
+  RadixSort();
+  sorted_.resize(draws_.size());
+  for (size_t i = 0; i < entries_.size(); i++) {
+    sorted_[i] = draws_[entries_[i].draw];
+  }
+  return sorted_;
+}
+
+uint32_t DrawSorter::AssignLevel(CommandRef command) {
+  Bounds bounds = CommandBounds(command);
+  // Padding before converting keeps zero sized shapes, which may still
+  // touch pixels when antialiased.
+  bounds = {bounds.left - kPadding, bounds.top - kPadding,
+            bounds.right + kPadding, bounds.bottom + kPadding};
+  PixelRect rect = ToPixelRect(bounds, 0, screen_width_, screen_height_);
+  if (rect.left >= rect.right || rect.top >= rect.bottom) {
+    return 0;
+  }
+  int x0 = rect.left / kCellSize, x1 = (rect.right - 1) / kCellSize;
+  int y0 = rect.top / kCellSize, y1 = (rect.bottom - 1) / kCellSize;
+  uint32_t level = 0;
+  for (int y = y0; y <= y1; y++) {
+    for (int x = x0; x <= x1; x++) {
+      const Cell &cell = cells_[static_cast<size_t>(y) * cells_x_ + x];
+      level = std::max(level, cell.floor);
+      for (const Placed &placed : cell.placed) {
+        if (placed.level > level && Overlaps(placed.rect, rect)) {
+          level = placed.level;
+        }
+      }
+    }
+  }
+  level = std::min(level + 1, kMaxLevel);
+  for (int y = y0; y <= y1; y++) {
+    for (int x = x0; x <= x1; x++) {
+      Cell &cell = cells_[static_cast<size_t>(y) * cells_x_ + x];
+      if (cell.placed.size() < kMaxCellEntries) {
+        cell.placed.push_back({rect, level});
+        continue;
+      }
+      // Forget the lowest entry, it raises the floor the least.
+      auto lowest = std::min_element(
+          cell.placed.begin(), cell.placed.end(),
+          [](const Placed &a, const Placed &b) { return a.level < b.level; });
+      cell.floor = std::max(cell.floor, lowest->level);
+      *lowest = {rect, level};
+    }
+  }
+  return level;
+}
+
+void DrawSorter::RadixSort() {
+  constexpr int kPasses = sizeof(uint64_t);
+  size_t histograms[kPasses][256] = {};
+  for (const Entry &entry : entries_) {
+    for (int pass = 0; pass < kPasses; pass++) {
+      histograms[pass][(entry.key >> (pass * 8)) & 0xff]++;
+    }
+  }
+  scratch_.resize(entries_.size());
+  for (int pass = 0; pass < kPasses; pass++) {
+    size_t *counts = histograms[pass];
+    // A byte every key has in common doesn't reorder anything.
+    if (*std::max_element(counts, counts + 256) == entries_.size()) {
+      continue;
+    }
+    size_t offset = 0;
+    for (int i = 0; i < 256; i++) {
+      size_t count = counts[i];
+      counts[i] = offset;
+      offset += count;
+    }
+    for (const Entry &entry : entries_) {
+      scratch_[counts[(entry.key >> (pass * 8)) & 0xff]++] = entry;
+    }
+    entries_.swap(scratch_);
+  }
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,246 @@
+#include <bob_ross/ktx2.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace bob_ross {
+namespace {
+
+constexpr uint8_t kIdentifier[12] = {0xab, 'K',  'T',  'X', ' ',  '2',
+                                     '0',  0xbb, '\r', '\n', 0x1a, '\n'};
+constexpr size_t kHeaderSize = 80;
+constexpr size_t kLevelIndexEntrySize = 24;
+
+// Data format descriptor values, from the Khronos Data Format
+// Specification.
+constexpr uint32_t kDfdVersion = 2;
+constexpr uint32_t kModelEtc2 = 161;
+constexpr uint32_t kModelAstc = 162;
+constexpr uint32_t kPrimariesBt709 = 1;
+constexpr uint32_t kTransferLinear = 1;
+constexpr uint32_t kTransferSrgb = 2;
+constexpr uint32_t kChannelEtc2Color = 2;
+constexpr uint32_t kChannelEtc2Alpha = 15;
+constexpr uint32_t kChannelAstcData = 0;
+
+// KTX2 is little endian whatever the host is.
+uint32_t Get32(const uint8_t *data) {
+  return data[0] | data[1] << 8 | data[2] << 16 |
+         static_cast<uint32_t>(data[3]) << 24;
+}
+
+uint64_t Get64(const uint8_t *data) {
+  return Get32(data) | static_cast<uint64_t>(Get32(data + 4)) << 32;
+}
+
+void Put32(std::vector<uint8_t> *out, size_t offset, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    (*out)[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+  }
+}
+
+void Put64(std::vector<uint8_t> *out, size_t offset, uint64_t value) {
+  Put32(out, offset, static_cast<uint32_t>(value));
+  Put32(out, offset + 4, static_cast<uint32_t>(value >> 32));
+}
+
+size_t AlignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+bool IsSrgb(uint32_t format) {
+  switch (format) {
+    case kKtx2Etc2Rgb8Srgb:
+    case kKtx2Etc2Rgba8Srgb:
+    case kKtx2Astc4x4Srgb:
+    case kKtx2Astc6x6Srgb:
+    case kKtx2Astc8x8Srgb:
+      return true;
+    default:
+      return false;
+  }
+}
+
+size_t LevelSize(uint32_t format, int width, int height) {
+  int block_width, block_height, block_bytes;
+  Ktx2BlockSize(format, &block_width, &block_height, &block_bytes);
+  size_t blocks_x =
+      (static_cast<size_t>(width) + block_width - 1) / block_width;
+  size_t blocks_y =
+      (static_cast<size_t>(height) + block_height - 1) / block_height;
+  return blocks_x * blocks_y * block_bytes;
+}
+
+}  // namespace
+
+bool Ktx2BlockSize(uint32_t format, int *block_width, int *block_height,
+                   int *block_bytes) {
+  switch (format) {
+    case kKtx2Etc2Rgb8:
+    case kKtx2Etc2Rgb8Srgb:
+      *block_width = *block_height = 4;
+      *block_bytes = 8;
+      return true;
+    case kKtx2Etc2Rgba8:
+    case kKtx2Etc2Rgba8Srgb:
+    case kKtx2Astc4x4:
+    case kKtx2Astc4x4Srgb:
+      *block_width = *block_height = 4;
+      *block_bytes = 16;
+      return true;
+    case kKtx2Astc6x6:
+    case kKtx2Astc6x6Srgb:
+      *block_width = *block_height = 6;
+      *block_bytes = 16;
+      return true;
+    case kKtx2Astc8x8:
+    case kKtx2Astc8x8Srgb:
+      *block_width = *block_height = 8;
+      *block_bytes = 16;
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool ParseKtx2(const uint8_t *data, size_t size, Ktx2Texture *texture,
+               std::string *error) {
+  if (size < kHeaderSize || std::memcmp(data, kIdentifier, 12)) {
+    *error = "Not a KTX2 file";
+    return false;
+  }
+  uint32_t format = Get32(data + 12);
+  uint32_t width = Get32(data + 20);
+  uint32_t height = Get32(data + 24);
+  uint32_t depth = Get32(data + 28);
+  uint32_t layers = Get32(data + 32);
+  uint32_t faces = Get32(data + 36);
+  // 0 asks for mip levels to be generated from the one stored.
+  uint32_t level_count = std::max(Get32(data + 40), 1u);
+  uint32_t supercompression = Get32(data + 44);
+  int block_width, block_height, block_bytes;
+  if (!Ktx2BlockSize(format, &block_width, &block_height, &block_bytes)) {
+    *error = "Unsupported format " + std::to_string(format);
+    return false;
+  }
+  if (!width || !height || depth > 1 || layers > 1 || faces != 1) {
+    *error = "Not a single 2D texture";
+    return false;
+  }
+  if (supercompression) {
+    *error = "Supercompressed files aren't supported";
+    return false;
+  }
+  // Checked before the shifts and int casts below, which are undefined past
+  // these.
+  if (width > INT_MAX || height > INT_MAX) {
+    *error = "Texture is too large";
+    return false;
+  }
+  if (level_count > 32 ||
+      (width >> (level_count - 1) == 0 && height >> (level_count - 1) == 0)) {
+    *error = "Too many mip levels";
+    return false;
+  }
+  if (size < kHeaderSize + level_count * kLevelIndexEntrySize) {
+    *error = "Truncated level index";
+    return false;
+  }
+
+  texture->format = format;
+  texture->width = static_cast<int>(width);
+  texture->height = static_cast<int>(height);
+  texture->levels.clear();
+  for (uint32_t i = 0; i < level_count; i++) {
+    const uint8_t *entry = data + kHeaderSize + i * kLevelIndexEntrySize;
+    uint64_t offset = Get64(entry);
+    uint64_t length = Get64(entry + 8);
+    int level_width = std::max(texture->width >> i, 1);
+    int level_height = std::max(texture->height >> i, 1);
+    size_t level_size = LevelSize(format, level_width, level_height);
+    if (offset > size || length > size - offset || length < level_size) {
+      *error = "Level " + std::to_string(i) + " is out of bounds";
+      return false;
+    }
+    // GL wants the exact size of the blocks, without any padding the file
+    // has after them.
+    texture->levels.push_back(
+        {data + offset, level_size, level_width, level_height});
+  }
+  return true;
+}
+
+std::vector<uint8_t> WriteKtx2(const Ktx2Texture &texture) {
+  int block_width = 4, block_height = 4, block_bytes = 8;
+  Ktx2BlockSize(texture.format, &block_width, &block_height, &block_bytes);
+  bool etc2 = texture.format <= kKtx2Etc2Rgba8Srgb;
+  bool etc2_alpha = etc2 && block_bytes == 16;
+
+  struct Sample {
+    uint32_t bit_offset, bit_length, channel;
+  };
+  std::vector<Sample> samples;
+  if (!etc2) {
+    samples.push_back({0, 127, kChannelAstcData});
+  } else if (etc2_alpha) {
+    samples.push_back({0, 63, kChannelEtc2Alpha});
+    samples.push_back({64, 63, kChannelEtc2Color});
+  } else {
+    samples.push_back({0, 63, kChannelEtc2Color});
+  }
+  size_t level_count = texture.levels.size();
+  size_t dfd_offset = kHeaderSize + level_count * kLevelIndexEntrySize;
+  size_t block_size = 24 + 16 * samples.size();
+  size_t dfd_size = 4 + block_size;
+
+  // Levels go smallest first, each aligned to the block size and 4.
+  size_t alignment = block_bytes % 4 ? block_bytes * 4 : block_bytes;
+  std::vector<size_t> offsets(level_count);
+  size_t end = dfd_offset + dfd_size;
+  for (size_t i = level_count; i-- > 0;) {
+    offsets[i] = AlignUp(end, alignment);
+    end = offsets[i] + texture.levels[i].size;
+  }
+
+  std::vector<uint8_t> out(end, 0);
+  std::memcpy(out.data(), kIdentifier, 12);
+  Put32(&out, 12, texture.format);
+  // Block compressed data has a type size of 1.
+  Put32(&out, 16, 1);
+  Put32(&out, 20, texture.width);
+  Put32(&out, 24, texture.height);
+  Put32(&out, 36, 1);
+  Put32(&out, 40, static_cast<uint32_t>(level_count));
+  Put32(&out, 48, static_cast<uint32_t>(dfd_offset));
+  Put32(&out, 52, static_cast<uint32_t>(dfd_size));
+  for (size_t i = 0; i < level_count; i++) {
+    size_t entry = kHeaderSize + i * kLevelIndexEntrySize;
+    Put64(&out, entry, offsets[i]);
+    Put64(&out, entry + 8, texture.levels[i].size);
+    Put64(&out, entry + 16, texture.levels[i].size);
+    std::memcpy(out.data() + offsets[i], texture.levels[i].data,
+                texture.levels[i].size);
+  }
+
+  size_t dfd = dfd_offset;
+  Put32(&out, dfd, static_cast<uint32_t>(dfd_size));
+  // Vendor and descriptor type are both 0, the basic descriptor block.
+  Put32(&out, dfd + 4, 0);
+  Put32(&out, dfd + 8, kDfdVersion | static_cast<uint32_t>(block_size) << 16);
+  uint32_t transfer = IsSrgb(texture.format) ? kTransferSrgb : kTransferLinear;
+  Put32(&out, dfd + 12,
+        (etc2 ? kModelEtc2 : kModelAstc) | kPrimariesBt709 << 8 |
+            transfer << 16);
+  Put32(&out, dfd + 16, (block_width - 1) | (block_height - 1) << 8);
+  Put32(&out, dfd + 20, block_bytes);
+  for (size_t i = 0; i < samples.size(); i++) {
+    size_t sample = dfd + 28 + i * 16;
+    Put32(&out, sample, samples[i].bit_offset | samples[i].bit_length << 16 |
+                            samples[i].channel << 24);
+    Put32(&out, sample + 12, 0xffffffffu);
+  }
+  return out;
+}
+
+}  // namespace bob_ross
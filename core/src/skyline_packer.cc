@@ -0,0 +1,99 @@
+#include <bob_ross/skyline_packer.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace bob_ross {
+
+SkylinePacker::SkylinePacker(int width, int height)
+    : width_(width), height_(height) {
+  Reset();
+}
+
+void SkylinePacker::Reset() {
+  skyline_.assign(1, {0, 0, width_});
+  used_area_ = 0;
+}
+
+int SkylinePacker::Fit(size_t index, int width, int height,
+                       int64_t *waste) const {
+  int left = skyline_[index].x;
+  if (left + width > width_) {
+    return -1;
+  }
+  // The rectangle rests on the highest segment under it.
+  int y = 0;
+  int remaining = width;
+  for (size_t i = index; remaining > 0; i++) {
+    y = std::max(y, skyline_[i].y);
+    remaining -= skyline_[i].width;
+  }
+  if (y + height > height_) {
+    return -1;
+  }
+  *waste = 0;
+  remaining = width;
+  for (size_t i = index; remaining > 0; i++) {
+    int covered = std::min(remaining, skyline_[i].width);
+    *waste += static_cast<int64_t>(y - skyline_[i].y) * covered;
+    remaining -= covered;
+  }
+  return y;
+}
+
+bool SkylinePacker::Pack(int width, int height, int *x, int *y) {
+  if (width <= 0 || height <= 0) {
+    return false;
+  }
+  size_t best = skyline_.size();
+  int best_top = std::numeric_limits<int>::max();
+  int64_t best_waste = std::numeric_limits<int64_t>::max();
+  for (size_t i = 0; i < skyline_.size(); i++) {
+    int64_t waste;
+    int top = Fit(i, width, height, &waste);
+    if (top < 0) {
+      continue;
+    }
+    if (top + height < best_top ||
+        (top + height == best_top && waste < best_waste)) {
+      best = i;
+      best_top = top + height;
+      best_waste = waste;
+    }
+  }
+  if (best == skyline_.size()) {
+    return false;
+  }
+  *x = skyline_[best].x;
+  *y = best_top - height;
+  used_area_ += static_cast<int64_t>(width) * height;
+
+  // The new segment replaces the part of the skyline it covers.
+  skyline_.insert(skyline_.begin() + best, {*x, best_top, width});
+  int right = *x + width;
+  size_t next = best + 1;
+  while (next < skyline_.size() && skyline_[next].x < right) {
+    Segment &segment = skyline_[next];
+    int end = segment.x + segment.width;
+    if (end <= right) {
+      skyline_.erase(skyline_.begin() + next);
+      continue;
+    }
+    segment.width = end - right;
+    segment.x = right;
+    break;
+  }
+  // Neighbors at the same height merge, so later fits look at fewer
+  // segments.
+  for (size_t i = 0; i + 1 < skyline_.size();) {
+    if (skyline_[i].y == skyline_[i + 1].y) {
+      skyline_[i].width += skyline_[i + 1].width;
+      skyline_.erase(skyline_.begin() + i + 1);
+    } else {
+      i++;
+    }
+  }
+  return true;
+}
+
+}  // namespace bob_ross
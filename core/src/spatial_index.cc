@@ -0,0 +1,196 @@
+#include <bob_ross/spatial_index.h>
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace bob_ross {
+namespace {
+
+uint64_t MakeKey(int level, uint32_t cell_x, uint32_t cell_y) {
+  return static_cast<uint64_t>(level) << 56 |
+         static_cast<uint64_t>(cell_y) << 28 | cell_x;
+}
+
+// Cell of |coordinate| at a level with cells of |cell_size| and |cells| per
+// side. Shapes centered off screen go to the nearest edge cell, which still
+// contains the part of them that is on screen.
+uint32_t CellOf(float coordinate, float cell_size, uint32_t cells) {
+  float cell = std::floor(coordinate / cell_size);
+  if (!(cell > 0)) {
+    return 0;
+  }
+  return std::min(static_cast<uint32_t>(std::min(cell, 1e9f)), cells - 1);
+}
+
+float Cross(const Point &a, const Point &b, float x, float y) {
+  return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+bool InTriangle(const Point &a, const Point &b, const Point &c, float x,
+                float y) {
+  float ab = Cross(a, b, x, y);
+  float bc = Cross(b, c, x, y);
+  float ca = Cross(c, a, x, y);
+  return (ab >= 0 && bc >= 0 && ca >= 0) || (ab <= 0 && bc <= 0 && ca <= 0);
+}
+
+// Even-odd rule, which matches the triangulation of a simple outline.
+bool InOutline(const Point *points, size_t count, float x, float y) {
+  bool inside = false;
+  for (size_t i = 0, j = count - 1; i < count; j = i++) {
+    const Point &a = points[i];
+    const Point &b = points[j];
+    if ((a.y > y) != (b.y > y) &&
+        x < (b.x - a.x) * (y - a.y) / (b.y - a.y) + a.x) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+}  // namespace
+
+void SpatialIndex::Reset(int screen_width, int screen_height) {
+  width_ = screen_width;
+  height_ = screen_height;
+  root_size_ = 1;
+  while (root_size_ < width_ || root_size_ < height_) {
+    root_size_ *= 2;
+  }
+  replay_ = 0;
+  shapes_.clear();
+  points_.clear();
+  indices_.clear();
+}
+
+void SpatialIndex::AddRect(uint32_t id, const RectInstance &rect) {
+  float left = std::min(rect.top_left.x, rect.bottom_right.x);
+  float top = std::min(rect.top_left.y, rect.bottom_right.y);
+  float right = std::max(rect.top_left.x, rect.bottom_right.x);
+  float bottom = std::max(rect.top_left.y, rect.bottom_right.y);
+  Shape shape = {0, id, rect.top_left.z, Shape::Kind::kRect,
+                 {left, top, right, bottom}};
+  Add(shape, left, top, right, bottom);
+}
+
+void SpatialIndex::AddCircle(uint32_t id, const CircleInstance &circle) {
+  float x = circle.origin.x, y = circle.origin.y;
+  float radius = std::fabs(circle.radius);
+  Shape shape = {0, id, circle.origin.z, Shape::Kind::kCircle,
+                 {x, y, radius}};
+  Add(shape, x - radius, y - radius, x + radius, y + radius);
+}
+
+void SpatialIndex::AddPolygon(uint32_t id, const Point *points,
+                              size_t point_count, const uint32_t *indices,
+                              size_t index_count) {
+  if (point_count < 3) {
+    return;
+  }
+  Shape shape = {0, id, points[0].z, Shape::Kind::kPolygon};
+  shape.first_point = static_cast<uint32_t>(points_.size());
+  shape.point_count = static_cast<uint32_t>(point_count);
+  shape.first_index = static_cast<uint32_t>(indices_.size());
+  shape.index_count = static_cast<uint32_t>(index_count);
+  float left = points[0].x, top = points[0].y;
+  float right = left, bottom = top;
+  for (size_t i = 0; i < point_count; i++) {
+    left = std::min(left, points[i].x);
+    top = std::min(top, points[i].y);
+    right = std::max(right, points[i].x);
+    bottom = std::max(bottom, points[i].y);
+  }
+  points_.insert(points_.end(), points, points + point_count);
+  indices_.insert(indices_.end(), indices, indices + index_count);
+  Add(shape, left, top, right, bottom);
+}
+
+void SpatialIndex::Add(Shape shape, float left, float top, float right,
+                       float bottom) {
+  // The deepest level whose cells are still as large as the shape.
+  float extent = std::max(right - left, bottom - top);
+  int level = 0;
+  float cell_size = root_size_;
+  while (level < kMaxDepth && cell_size * 0.5f >= extent) {
+    cell_size *= 0.5f;
+    level++;
+  }
+  uint32_t cells = 1u << level;
+  shape.replay = replay_;
+  shape.key = MakeKey(level, CellOf((left + right) * 0.5f, cell_size, cells),
+                      CellOf((top + bottom) * 0.5f, cell_size, cells));
+  shapes_.push_back(shape);
+}
+
+void SpatialIndex::Build() {
+  std::sort(shapes_.begin(), shapes_.end(),
+            [](const Shape &a, const Shape &b) { return a.key < b.key; });
+}
+
+int64_t SpatialIndex::HitTest(Point point) const {
+  float x = point.x, y = point.y;
+  if (!(x >= 0 && y >= 0 && x < width_ && y < height_)) {
+    return -1;
+  }
+  const Shape *hit = nullptr;
+  float cell_size = root_size_;
+  for (int level = 0; level <= kMaxDepth; level++, cell_size *= 0.5f) {
+    uint32_t cells = 1u << level;
+    // Loose bounds reach half a cell into the neighbors.
+    float half = cell_size * 0.5f;
+    uint32_t x0 = CellOf(x - half, cell_size, cells);
+    uint32_t x1 = CellOf(x + half, cell_size, cells);
+    uint32_t y0 = CellOf(y - half, cell_size, cells);
+    uint32_t y1 = CellOf(y + half, cell_size, cells);
+    for (uint32_t cell_y = y0; cell_y <= y1; cell_y++) {
+      for (uint32_t cell_x = x0; cell_x <= x1; cell_x++) {
+        uint64_t key = MakeKey(level, cell_x, cell_y);
+        auto first = std::lower_bound(
+            shapes_.begin(), shapes_.end(), key,
+            [](const Shape &shape, uint64_t key) { return shape.key < key; });
+        for (auto it = first; it != shapes_.end() && it->key == key; ++it) {
+          bool above =
+              !hit || std::tie(it->replay, it->z, it->id) >
+                          std::tie(hit->replay, hit->z, hit->id);
+          if (above && Contains(*it, x, y)) {
+            hit = &*it;
+          }
+        }
+      }
+    }
+  }
+  return hit ? static_cast<int64_t>(hit->id) : -1;
+}
+
+bool SpatialIndex::Contains(const Shape &shape, float x, float y) const {
+  const float *p = shape.params;
+  switch (shape.kind) {
+    case Shape::Kind::kRect:
+      return x >= p[0] && x < p[2] && y >= p[1] && y < p[3];
+    case Shape::Kind::kCircle: {
+      float dx = x - p[0], dy = y - p[1];
+      return dx * dx + dy * dy <= p[2] * p[2];
+    }
+    case Shape::Kind::kPolygon: {
+      const Point *points = points_.data() + shape.first_point;
+      if (!shape.index_count) {
+        return InOutline(points, shape.point_count, x, y);
+      }
+      const uint32_t *indices = indices_.data() + shape.first_index;
+      for (uint32_t i = 0; i + 2 < shape.index_count; i += 3) {
+        if (indices[i] < shape.point_count &&
+            indices[i + 1] < shape.point_count &&
+            indices[i + 2] < shape.point_count &&
+            InTriangle(points[indices[i]], points[indices[i + 1]],
+                       points[indices[i + 2]], x, y)) {
+          return true;
+        }
+      }
+      return false;
+    }
+  }
+  return false;
+}
+
+}  // namespace bob_ross
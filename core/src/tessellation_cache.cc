@@ -0,0 +1,142 @@
+#include <bob_ross/tessellation_cache.h>
+#include <bob_ross/trace.h>
+
+#include <iterator>
+#include <utility>
+
+namespace bob_ross {
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t HashOutline(const std::vector<Point> &outline) {
+  uint64_t hash = kFnvOffset;
+  for (const Point &point : outline) {
+    const float xy[2] = {point.x, point.y};
+    auto *bytes = reinterpret_cast<const uint8_t *>(xy);
+    for (size_t i = 0; i < sizeof(xy); i++) {
+      hash = (hash ^ bytes[i]) * kFnvPrime;
+    }
+  }
+  return hash;
+}
+
+bool SameOutline(const std::vector<Point> &a, const std::vector<Point> &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].x != b[i].x || a[i].y != b[i].y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TessellationCache::TessellationCache(size_t budget_bytes)
+    : budget_bytes_(budget_bytes) {}
+
+void TessellationCache::TessellatePolygon(const PolygonCommand &polygon,
+                                          uint32_t color,
+                                          Triangulator *triangulator,
+                                          Mesh *mesh) {
+  if (polygon.index_count || polygon.point_count < kMinPoints ||
+      !budget_bytes_) {
+    bob_ross::TessellatePolygon(polygon, color, triangulator, mesh);
+    return;
+  }
+  BOB_ROSS_TRACE_SCOPE("TessellationCache::TessellatePolygon");
+  const Point *points = polygon.points();
+  const Point &origin = points[0];
+  outline_.resize(polygon.point_count);
+  for (uint32_t i = 0; i < polygon.point_count; i++) {
+    outline_[i] = {points[i].x - origin.x, points[i].y - origin.y, 0};
+  }
+  uint64_t hash = HashOutline(outline_);
+
+  const std::vector<uint32_t> *indices;
+  if (const Entry *entry = Find(hash, outline_)) {
+    hits_++;
+    indices = &entry->indices;
+  } else {
+    misses_++;
+    // Triangulating the relative outline keeps the result independent of
+    // where the polygon was first seen.
+    indices_.clear();
+    triangulator->Triangulate(outline_.data(), outline_.size(), 0u,
+                              &indices_);
+    indices = &indices_;
+  }
+
+  auto base = static_cast<uint32_t>(mesh->vertices.size());
+  for (uint32_t i = 0; i < polygon.point_count; i++) {
+    mesh->vertices.push_back({points[i].x, points[i].y, points[i].z, color});
+  }
+  size_t first_index = mesh->indices.size();
+  mesh->indices.resize(first_index + indices->size());
+  uint32_t *index = mesh->indices.data() + first_index;
+  for (uint32_t i : *indices) {
+    *index++ = base + i;
+  }
+
+  if (indices == &indices_) {
+    Insert({hash, outline_, indices_});
+  }
+}
+
+void TessellationCache::SetBudget(size_t budget_bytes) {
+  budget_bytes_ = budget_bytes;
+  EvictToBudget(budget_bytes_);
+}
+
+void TessellationCache::Clear() { EvictToBudget(0); }
+
+size_t TessellationCache::EntryBytes(const Entry &entry) {
+  return sizeof(Entry) + entry.outline.size() * sizeof(Point) +
+         entry.indices.size() * sizeof(uint32_t);
+}
+
+const TessellationCache::Entry *TessellationCache::Find(
+    uint64_t hash, const std::vector<Point> &outline) {
+  auto range = index_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (SameOutline(it->second->outline, outline)) {
+      // Move to the front of the recency list.
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return &entries_.front();
+    }
+  }
+  return nullptr;
+}
+
+void TessellationCache::Insert(Entry entry) {
+  size_t bytes = EntryBytes(entry);
+  if (bytes > budget_bytes_) {
+    return;
+  }
+  EvictToBudget(budget_bytes_ - bytes);
+  uint64_t hash = entry.hash;
+  entries_.push_front(std::move(entry));
+  index_.emplace(hash, entries_.begin());
+  size_bytes_ += bytes;
+}
+
+void TessellationCache::EvictToBudget(size_t budget_bytes) {
+  while (size_bytes_ > budget_bytes && !entries_.empty()) {
+    auto last = std::prev(entries_.end());
+    auto range = index_.equal_range(last->hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == last) {
+        index_.erase(it);
+        break;
+      }
+    }
+    size_bytes_ -= EntryBytes(*last);
+    entries_.erase(last);
+  }
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,172 @@
+#include <bob_ross/tessellator.h>
+#include <bob_ross/trace.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace bob_ross {
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// std::sin/std::cos aren't constexpr, so the tables are built with a Taylor
+// series. The angles stay within [0, 2pi) and are folded into [-pi, pi]
+// first, where 15 terms are accurate far beyond float precision.
+constexpr double ConstexprSin(double x) {
+  if (x > kPi) {
+    x -= 2 * kPi;
+  }
+  double term = x, sum = x;
+  for (int i = 1; i < 15; i++) {
+    term *= -x * x / ((2 * i) * (2 * i + 1));
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double ConstexprCos(double x) {
+  if (x > kPi) {
+    x -= 2 * kPi;
+  }
+  double term = 1, sum = 1;
+  for (int i = 1; i < 15; i++) {
+    term *= -x * x / ((2 * i - 1) * (2 * i));
+    sum += term;
+  }
+  return sum;
+}
+
+template <int kSegments>
+struct UnitCircle {
+  std::array<float, kSegments> cos{};
+  std::array<float, kSegments> sin{};
+
+  constexpr UnitCircle() {
+    for (int i = 0; i < kSegments; i++) {
+      double angle = 2 * kPi * i / kSegments;
+      cos[i] = static_cast<float>(ConstexprCos(angle));
+      sin[i] = static_cast<float>(ConstexprSin(angle));
+    }
+  }
+};
+
+struct UnitCircleView {
+  int segments;
+  const float *cos;
+  const float *sin;
+};
+
+template <int kSegments>
+constexpr UnitCircle<kSegments> kUnitCircle{};
+
+template <int kSegments>
+constexpr UnitCircleView View() {
+  return {kSegments, kUnitCircle<kSegments>.cos.data(),
+          kUnitCircle<kSegments>.sin.data()};
+}
+
+// Sorted by segment count.
+constexpr UnitCircleView kUnitCircles[] = {
+    View<4>(),  View<8>(),  View<12>(),  View<16>(),  View<24>(),  View<32>(),
+    View<48>(), View<64>(), View<96>(), View<128>(), View<192>(), View<256>(),
+};
+
+const UnitCircleView &UnitCircleFor(float radius, float max_error) {
+  // The chord of a segment spanning angle a deviates from the arc by
+  // r * (1 - cos(a / 2)), so n segments are enough once
+  // n >= pi / acos(1 - max_error / r).
+  float needed = 0;
+  if (radius > max_error) {
+    needed = static_cast<float>(kPi) / std::acos(1 - max_error / radius);
+  }
+  for (const UnitCircleView &circle : kUnitCircles) {
+    if (circle.segments >= needed) {
+      return circle;
+    }
+  }
+  return kUnitCircles[std::size(kUnitCircles) - 1];
+}
+
+uint32_t ClampChannel(int value) {
+  return static_cast<uint32_t>(std::min(std::max(value, 0), 255));
+}
+
+}  // namespace
+
+int CircleSegmentCount(float radius, float max_error) {
+  return UnitCircleFor(std::fabs(radius), max_error).segments;
+}
+
+uint32_t PackColor(Color color) {
+  return ClampChannel(color.r) | ClampChannel(color.g) << 8 |
+         ClampChannel(color.b) << 16 | ClampChannel(color.a) << 24;
+}
+
+void TessellateRect(const RectInstance &rect, uint32_t color, Mesh *mesh) {
+  auto base = static_cast<uint32_t>(mesh->vertices.size());
+  const Point &tl = rect.top_left;
+  const Point &br = rect.bottom_right;
+  mesh->vertices.push_back({tl.x, tl.y, tl.z, color});
+  mesh->vertices.push_back({br.x, tl.y, tl.z, color});
+  mesh->vertices.push_back({br.x, br.y, tl.z, color});
+  mesh->vertices.push_back({tl.x, br.y, tl.z, color});
+  mesh->indices.insert(mesh->indices.end(), {base, base + 1, base + 2, base,
+                                             base + 2, base + 3});
+}
+
+void TessellateCircle(const CircleInstance &circle, uint32_t color,
+                      float max_error, Mesh *mesh) {
+  float radius = circle.radius;
+  const UnitCircleView &unit = UnitCircleFor(std::fabs(radius), max_error);
+  int segments = unit.segments;
+  auto base = static_cast<uint32_t>(mesh->vertices.size());
+  const Point &o = circle.origin;
+
+  mesh->vertices.resize(base + 1 + segments);
+  Vertex *vertex = mesh->vertices.data() + base;
+  *vertex++ = {o.x, o.y, o.z, color};
+  for (int i = 0; i < segments; i++) {
+    *vertex++ = {o.x + radius * unit.cos[i], o.y + radius * unit.sin[i], o.z,
+                 color};
+  }
+
+  size_t first_index = mesh->indices.size();
+  mesh->indices.resize(first_index + segments * 3);
+  uint32_t *index = mesh->indices.data() + first_index;
+  for (int i = 0; i < segments; i++) {
+    *index++ = base;
+    *index++ = base + 1 + i;
+    *index++ = base + 1 + (i + 1 == segments ? 0 : i + 1);
+  }
+}
+
+void TessellatePolygon(const PolygonCommand &polygon, uint32_t color,
+                       Triangulator *triangulator, Mesh *mesh) {
+  BOB_ROSS_TRACE_SCOPE("TessellatePolygon");
+  auto base = static_cast<uint32_t>(mesh->vertices.size());
+  const Point *points = polygon.points();
+  for (uint32_t i = 0; i < polygon.point_count; i++) {
+    mesh->vertices.push_back({points[i].x, points[i].y, points[i].z, color});
+  }
+  if (!polygon.index_count) {
+    triangulator->Triangulate(points, polygon.point_count, base,
+                              &mesh->indices);
+    return;
+  }
+  const uint32_t *indices = polygon.indices();
+  for (uint32_t i = 0; i + 2 < polygon.index_count; i += 3) {
+    // Drop triangles that point outside of the polygon instead of reading out
+    // of bounds on the GPU.
+    if (indices[i] >= polygon.point_count ||
+        indices[i + 1] >= polygon.point_count ||
+        indices[i + 2] >= polygon.point_count) {
+      continue;
+    }
+    mesh->indices.insert(mesh->indices.end(),
+                         {base + indices[i], base + indices[i + 1],
+                          base + indices[i + 2]});
+  }
+}
+
+}  // namespace bob_ross
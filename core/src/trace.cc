@@ -0,0 +1,110 @@
+#include <bob_ross/trace.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+namespace bob_ross {
+namespace {
+
+void AppendJsonString(const char *value, std::string *out) {
+  out->push_back('"');
+  for (; *value; value++) {
+    if (*value == '"' || *value == '\\') {
+      out->push_back('\\');
+    }
+    if (static_cast<unsigned char>(*value) >= 0x20) {
+      out->push_back(*value);
+    }
+  }
+  out->push_back('"');
+}
+
+}  // namespace
+
+std::atomic<bool> Tracer::enabled_{false};
+
+Tracer &Tracer::Get() {
+  static Tracer *tracer = new Tracer();
+  return *tracer;
+}
+
+void Tracer::Enable(size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.assign(capacity ? capacity : 1, TraceEvent());
+  next_ = 0;
+  wrapped_ = false;
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Disable() { enabled_.store(false, std::memory_order_relaxed); }
+
+void Tracer::Record(const char *name, int64_t start_ns, int64_t duration_ns,
+                    uint32_t track) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (events_.empty()) {
+    return;
+  }
+  events_[next_] = {name, start_ns, duration_ns, track};
+  if (++next_ == events_.size()) {
+    next_ = 0;
+    wrapped_ = true;
+  }
+}
+
+int64_t Tracer::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+uint32_t Tracer::CurrentTrack() {
+  static std::atomic<uint32_t> next_track{kGpuTrack + 1};
+  thread_local uint32_t track = next_track.fetch_add(1);
+  return track;
+}
+
+std::vector<TraceEvent> Tracer::Events() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<TraceEvent> events;
+  if (wrapped_) {
+    events.assign(events_.begin() + next_, events_.end());
+  }
+  events.insert(events.end(), events_.begin(), events_.begin() + next_);
+  return events;
+}
+
+// Timestamps are microseconds in the trace format. Scopes nest on a track
+// by time, so complete ("X") events are enough.
+std::string Tracer::ToChromeJson() const {
+  std::vector<TraceEvent> events = Events();
+  std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  json +=
+      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+      "\"args\":{\"name\":\"GPU\"}}";
+  char buffer[160];
+  for (const TraceEvent &event : events) {
+    json += ",{\"name\":";
+    AppendJsonString(event.name, &json);
+    std::snprintf(buffer, sizeof(buffer),
+                  ",\"ph\":\"X\",\"pid\":1,\"tid\":%" PRIu32
+                  ",\"ts\":%.3f,\"dur\":%.3f}",
+                  event.track, event.start_ns / 1000.0,
+                  event.duration_ns / 1000.0);
+    json += buffer;
+  }
+  json += "]}\n";
+  return json;
+}
+
+bool Tracer::WriteChromeJson(const char *path) const {
+  FILE *file = std::fopen(path, "w");
+  if (!file) {
+    return false;
+  }
+  std::string json = ToChromeJson();
+  bool written = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+  return std::fclose(file) == 0 && written;
+}
+
+}  // namespace bob_ross
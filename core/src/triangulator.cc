@@ -0,0 +1,468 @@
+#include <bob_ross/triangulator.h>
+
+#include <algorithm>
+#include <cassert>
+
+// Follows the structure of mapbox/earcut without hole support.
+
+namespace bob_ross {
+
+struct Triangulator::Node {
+  uint32_t i;
+  float x, y;
+  Node *prev = nullptr, *next = nullptr;
+  // z-order curve value and neighbours in z-order.
+  int32_t z = 0;
+  Node *prev_z = nullptr, *next_z = nullptr;
+};
+
+namespace {
+
+using Node = Triangulator::Node;
+
+float Area(const Node *p, const Node *q, const Node *r) {
+  return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+bool Equals(const Node *a, const Node *b) {
+  return a->x == b->x && a->y == b->y;
+}
+
+int Sign(float value) { return (value > 0) - (value < 0); }
+
+bool PointInTriangle(float ax, float ay, float bx, float by, float cx,
+                     float cy, float px, float py) {
+  return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+         (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+         (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+// Whether q lies on segment pr, given the three are collinear.
+bool OnSegment(const Node *p, const Node *q, const Node *r) {
+  return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) &&
+         q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+}
+
+bool Intersects(const Node *p1, const Node *q1, const Node *p2,
+                const Node *q2) {
+  int o1 = Sign(Area(p1, q1, p2));
+  int o2 = Sign(Area(p1, q1, q2));
+  int o3 = Sign(Area(p2, q2, p1));
+  int o4 = Sign(Area(p2, q2, q1));
+  if (o1 != o2 && o3 != o4) {
+    return true;
+  }
+  return (o1 == 0 && OnSegment(p1, p2, q1)) ||
+         (o2 == 0 && OnSegment(p1, q2, q1)) ||
+         (o3 == 0 && OnSegment(p2, p1, q2)) ||
+         (o4 == 0 && OnSegment(p2, q1, q2));
+}
+
+bool IntersectsPolygon(const Node *a, const Node *b) {
+  const Node *p = a;
+  do {
+    if (p->i != a->i && p->next->i != a->i && p->i != b->i &&
+        p->next->i != b->i && Intersects(p, p->next, a, b)) {
+      return true;
+    }
+    p = p->next;
+  } while (p != a);
+  return false;
+}
+
+bool LocallyInside(const Node *a, const Node *b) {
+  return Area(a->prev, a, a->next) < 0
+             ? Area(a, b, a->next) >= 0 && Area(a, a->prev, b) >= 0
+             : Area(a, b, a->prev) < 0 || Area(a, a->next, b) < 0;
+}
+
+bool MiddleInside(const Node *a, const Node *b) {
+  const Node *p = a;
+  bool inside = false;
+  float px = (a->x + b->x) / 2;
+  float py = (a->y + b->y) / 2;
+  do {
+    if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+        (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x)) {
+      inside = !inside;
+    }
+    p = p->next;
+  } while (p != a);
+  return inside;
+}
+
+bool IsValidDiagonal(const Node *a, const Node *b) {
+  return a->next->i != b->i && a->prev->i != b->i &&
+         !IntersectsPolygon(a, b) &&
+         ((LocallyInside(a, b) && LocallyInside(b, a) && MiddleInside(a, b) &&
+           (Area(a->prev, a, b->prev) != 0 || Area(a, b->prev, b) != 0)) ||
+          (Equals(a, b) && Area(a->prev, a, a->next) > 0 &&
+           Area(b->prev, b, b->next) > 0));
+}
+
+void RemoveNode(Node *p) {
+  p->next->prev = p->prev;
+  p->prev->next = p->next;
+  if (p->prev_z) {
+    p->prev_z->next_z = p->next_z;
+  }
+  if (p->next_z) {
+    p->next_z->prev_z = p->prev_z;
+  }
+}
+
+// Merge sort of the z-order list, see
+// https://www.chiark.greenend.org.uk/~sgtatham/algorithms/listsort.html
+Node *SortLinked(Node *list) {
+  int in_size = 1;
+  int merges;
+  do {
+    Node *p = list;
+    Node *tail = nullptr;
+    list = nullptr;
+    merges = 0;
+    while (p) {
+      merges++;
+      Node *q = p;
+      int p_size = 0;
+      for (int i = 0; i < in_size; i++) {
+        p_size++;
+        q = q->next_z;
+        if (!q) {
+          break;
+        }
+      }
+      int q_size = in_size;
+      while (p_size > 0 || (q_size > 0 && q)) {
+        Node *e;
+        if (p_size != 0 && (q_size == 0 || !q || p->z <= q->z)) {
+          e = p;
+          p = p->next_z;
+          p_size--;
+        } else {
+          e = q;
+          q = q->next_z;
+          q_size--;
+        }
+        if (tail) {
+          tail->next_z = e;
+        } else {
+          list = e;
+        }
+        e->prev_z = tail;
+        tail = e;
+      }
+      p = q;
+    }
+    tail->next_z = nullptr;
+    in_size *= 2;
+  } while (merges > 1);
+  return list;
+}
+
+}  // namespace
+
+Triangulator::Triangulator() = default;
+Triangulator::~Triangulator() = default;
+
+template <typename Index>
+void Triangulator::Triangulate(const Point *points, size_t count, Index base,
+                               std::vector<Index> *indices) {
+  if (count < 3) {
+    return;
+  }
+  // Every split adds two nodes and there are fewer splits than points, so
+  // this never reallocates and node pointers stay valid.
+  nodes_.clear();
+  nodes_.reserve(count * 3);
+  triangles_.clear();
+
+  Node *outer = LinkedList(points, count);
+  if (!outer || outer->next == outer->prev) {
+    return;
+  }
+
+  inv_size_ = 0;
+  if (count > kHashThreshold) {
+    float max_x = min_x_ = points[0].x;
+    float max_y = min_y_ = points[0].y;
+    for (size_t i = 1; i < count; i++) {
+      min_x_ = std::min(min_x_, points[i].x);
+      min_y_ = std::min(min_y_, points[i].y);
+      max_x = std::max(max_x, points[i].x);
+      max_y = std::max(max_y, points[i].y);
+    }
+    float size = std::max(max_x - min_x_, max_y - min_y_);
+    inv_size_ = size != 0 ? 32767 / size : 0;
+  }
+
+  EarcutLinked(outer, 0);
+
+  size_t first = indices->size();
+  indices->resize(first + triangles_.size());
+  Index *out = indices->data() + first;
+  for (uint32_t i : triangles_) {
+    *out++ = static_cast<Index>(base + i);
+  }
+}
+
+template void Triangulator::Triangulate<uint16_t>(const Point *, size_t,
+                                                  uint16_t,
+                                                  std::vector<uint16_t> *);
+template void Triangulator::Triangulate<uint32_t>(const Point *, size_t,
+                                                  uint32_t,
+                                                  std::vector<uint32_t> *);
+
+Triangulator::Node *Triangulator::CreateNode(uint32_t i, float x, float y) {
+  assert(nodes_.size() < nodes_.capacity());
+  nodes_.push_back({i, x, y});
+  return &nodes_.back();
+}
+
+Triangulator::Node *Triangulator::InsertNode(uint32_t i, float x, float y,
+                                             Node *last) {
+  Node *p = CreateNode(i, x, y);
+  if (!last) {
+    p->prev = p;
+    p->next = p;
+  } else {
+    p->next = last->next;
+    p->prev = last;
+    last->next->prev = p;
+    last->next = p;
+  }
+  return p;
+}
+
+// Builds a circular list from the outline in a consistent winding order.
+Triangulator::Node *Triangulator::LinkedList(const Point *points,
+                                             size_t count) {
+  float signed_area = 0;
+  for (size_t i = 0, j = count - 1; i < count; j = i++) {
+    signed_area += (points[j].x - points[i].x) * (points[i].y + points[j].y);
+  }
+  Node *last = nullptr;
+  if (signed_area > 0) {
+    for (size_t i = 0; i < count; i++) {
+      last = InsertNode(i, points[i].x, points[i].y, last);
+    }
+  } else {
+    for (size_t i = count; i-- > 0;) {
+      last = InsertNode(i, points[i].x, points[i].y, last);
+    }
+  }
+  if (last && Equals(last, last->next)) {
+    RemoveNode(last);
+    last = last->next;
+  }
+  return last;
+}
+
+// Removes duplicate and collinear points.
+Triangulator::Node *Triangulator::FilterPoints(Node *start, Node *end) {
+  if (!start) {
+    return start;
+  }
+  if (!end) {
+    end = start;
+  }
+  Node *p = start;
+  bool again;
+  do {
+    again = false;
+    if (Equals(p, p->next) || Area(p->prev, p, p->next) == 0) {
+      RemoveNode(p);
+      p = end = p->prev;
+      if (p == p->next) {
+        break;
+      }
+      again = true;
+    } else {
+      p = p->next;
+    }
+  } while (again || p != end);
+  return end;
+}
+
+// Main ear slicing loop. When no ear is found, pass 1 filters points, pass 2
+// cures small self intersections and pass 3 splits the polygon in two.
+void Triangulator::EarcutLinked(Node *ear, int pass) {
+  if (!ear) {
+    return;
+  }
+  if (!pass && inv_size_) {
+    IndexCurve(ear);
+  }
+  Node *stop = ear;
+  while (ear->prev != ear->next) {
+    Node *prev = ear->prev;
+    Node *next = ear->next;
+    if (inv_size_ ? IsEarHashed(ear) : IsEar(ear)) {
+      Emit(prev->i, ear->i, next->i);
+      RemoveNode(ear);
+      // Skipping the next vertex leads to less sliver triangles.
+      ear = next->next;
+      stop = next->next;
+      continue;
+    }
+    ear = next;
+    if (ear == stop) {
+      if (pass == 0) {
+        EarcutLinked(FilterPoints(ear), 1);
+      } else if (pass == 1) {
+        EarcutLinked(CureLocalIntersections(FilterPoints(ear)), 2);
+      } else {
+        SplitEarcut(ear);
+      }
+      break;
+    }
+  }
+}
+
+bool Triangulator::IsEar(Node *ear) const {
+  const Node *a = ear->prev;
+  const Node *b = ear;
+  const Node *c = ear->next;
+  if (Area(a, b, c) >= 0) {
+    return false;  // Reflex, can't be an ear.
+  }
+  float x0 = std::min({a->x, b->x, c->x});
+  float y0 = std::min({a->y, b->y, c->y});
+  float x1 = std::max({a->x, b->x, c->x});
+  float y1 = std::max({a->y, b->y, c->y});
+  for (const Node *p = c->next; p != a; p = p->next) {
+    if (p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 &&
+        PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+        Area(p->prev, p, p->next) >= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Triangulator::IsEarHashed(Node *ear) const {
+  const Node *a = ear->prev;
+  const Node *b = ear;
+  const Node *c = ear->next;
+  if (Area(a, b, c) >= 0) {
+    return false;
+  }
+  float x0 = std::min({a->x, b->x, c->x});
+  float y0 = std::min({a->y, b->y, c->y});
+  float x1 = std::max({a->x, b->x, c->x});
+  float y1 = std::max({a->y, b->y, c->y});
+  int32_t min_z = ZOrder(x0, y0);
+  int32_t max_z = ZOrder(x1, y1);
+
+  auto blocks = [&](const Node *p) {
+    return p != a && p != c && p->x >= x0 && p->x <= x1 && p->y >= y0 &&
+           p->y <= y1 &&
+           PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+           Area(p->prev, p, p->next) >= 0;
+  };
+
+  // Look for points inside the triangle in both directions along the curve.
+  const Node *p = ear->prev_z;
+  const Node *n = ear->next_z;
+  while (p && p->z >= min_z && n && n->z <= max_z) {
+    if (blocks(p) || blocks(n)) {
+      return false;
+    }
+    p = p->prev_z;
+    n = n->next_z;
+  }
+  for (; p && p->z >= min_z; p = p->prev_z) {
+    if (blocks(p)) {
+      return false;
+    }
+  }
+  for (; n && n->z <= max_z; n = n->next_z) {
+    if (blocks(n)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Triangulator::Node *Triangulator::CureLocalIntersections(Node *start) {
+  Node *p = start;
+  do {
+    Node *a = p->prev;
+    Node *b = p->next->next;
+    if (!Equals(a, b) && Intersects(a, p, p->next, b) && LocallyInside(a, b) &&
+        LocallyInside(b, a)) {
+      Emit(a->i, p->i, b->i);
+      RemoveNode(p);
+      RemoveNode(p->next);
+      p = start = b;
+    }
+    p = p->next;
+  } while (p != start);
+  return FilterPoints(p);
+}
+
+// Splits the polygon along a valid diagonal and triangulates both halves.
+void Triangulator::SplitEarcut(Node *start) {
+  Node *a = start;
+  do {
+    for (Node *b = a->next->next; b != a->prev; b = b->next) {
+      if (a->i != b->i && IsValidDiagonal(a, b)) {
+        Node *a2 = CreateNode(a->i, a->x, a->y);
+        Node *b2 = CreateNode(b->i, b->x, b->y);
+        Node *an = a->next;
+        Node *bp = b->prev;
+        a->next = b;
+        b->prev = a;
+        a2->next = an;
+        an->prev = a2;
+        b2->next = a2;
+        a2->prev = b2;
+        bp->next = b2;
+        b2->prev = bp;
+
+        a = FilterPoints(a, a->next);
+        Node *c = FilterPoints(b2, b2->next);
+        EarcutLinked(a, 0);
+        EarcutLinked(c, 0);
+        return;
+      }
+    }
+    a = a->next;
+  } while (a != start);
+}
+
+void Triangulator::IndexCurve(Node *start) const {
+  Node *p = start;
+  do {
+    p->z = ZOrder(p->x, p->y);
+    p->prev_z = p->prev;
+    p->next_z = p->next;
+    p = p->next;
+  } while (p != start);
+  p->prev_z->next_z = nullptr;
+  p->prev_z = nullptr;
+  SortLinked(p);
+}
+
+// Interleaves the bits of the coordinates, scaled to 15 bits each.
+int32_t Triangulator::ZOrder(float fx, float fy) const {
+  auto x = static_cast<int32_t>((fx - min_x_) * inv_size_);
+  auto y = static_cast<int32_t>((fy - min_y_) * inv_size_);
+  x = (x | (x << 8)) & 0x00FF00FF;
+  x = (x | (x << 4)) & 0x0F0F0F0F;
+  x = (x | (x << 2)) & 0x33333333;
+  x = (x | (x << 1)) & 0x55555555;
+  y = (y | (y << 8)) & 0x00FF00FF;
+  y = (y | (y << 4)) & 0x0F0F0F0F;
+  y = (y | (y << 2)) & 0x33333333;
+  y = (y | (y << 1)) & 0x55555555;
+  return x | (y << 1);
+}
+
+void Triangulator::Emit(uint32_t a, uint32_t b, uint32_t c) {
+  triangles_.push_back(a);
+  triangles_.push_back(b);
+  triangles_.push_back(c);
+}
+
+}  // namespace bob_ross
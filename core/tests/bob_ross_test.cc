@@ -0,0 +1,153 @@
+#include <bob_ross/bob_ross.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+constexpr int kWidth = 100, kHeight = 80;
+
+class BobRossTest : public testing::Test {
+ protected:
+  void SetUp() override { bob_ross_.EnableHitTesting(true); }
+
+  // Commands recorded so far, by type.
+  std::vector<CommandType> Types() const {
+    std::vector<CommandType> types;
+    for (CommandRef command : bob_ross_.commands()) {
+      types.push_back(command.type);
+    }
+    return types;
+  }
+
+  BobRoss bob_ross_{kWidth, kHeight};
+};
+
+TEST_F(BobRossTest, HitsTopmostByZWithinReplay) {
+  bob_ross_.BeginFrame();
+  bob_ross_.Rect({10, 10, 5}, {50, 50, 5});
+  bob_ross_.Rect({30, 30, 0}, {70, 70, 0});
+  bob_ross_.Rect({60, 10, 0}, {90, 40, 0});
+  bob_ross_.Rect({80, 20, 0}, {95, 35, 0});
+  bob_ross_.EndFrame();
+  // The greater z wins over call order.
+  EXPECT_EQ(bob_ross_.HitTest({40, 40}), 0);
+  EXPECT_EQ(bob_ross_.HitTest({65, 65}), 1);
+  // Then the later call.
+  EXPECT_EQ(bob_ross_.HitTest({85, 30}), 3);
+  EXPECT_EQ(bob_ross_.HitTest({5, 5}), -1);
+  EXPECT_EQ(bob_ross_.HitTest({-1, 40}), -1);
+}
+
+TEST_F(BobRossTest, LaterReplaysAreAbove) {
+  bob_ross_.BeginFrame();
+  bob_ross_.Rect({16, 16, 5}, {48, 48, 5});
+  bob_ross_.Flush();
+  bob_ross_.Circle({32, 32, 0}, 8);
+  bob_ross_.Flush();
+  bob_ross_.Polygon({{60, 10, -1}, {90, 10, -1}, {75, 40, -1}});
+  bob_ross_.EndFrame();
+  // Drawn after the rect, so on top of it despite the smaller z.
+  EXPECT_EQ(bob_ross_.HitTest({32, 32}), 1);
+  EXPECT_EQ(bob_ross_.HitTest({20, 20}), 0);
+  EXPECT_EQ(bob_ross_.HitTest({75, 20}), 2);
+}
+
+TEST_F(BobRossTest, LaterReplaysAreAboveWhileTrackingDamage) {
+  bob_ross_.EnableDamageTracking(true);
+  bob_ross_.BeginFrame();
+  bob_ross_.Rect({16, 16, 5}, {48, 48, 5});
+  bob_ross_.Flush();
+  bob_ross_.Rect({24, 24, 0}, {40, 40, 0});
+  bob_ross_.ComputeDamage(0);
+  bob_ross_.EndFrame();
+  EXPECT_EQ(bob_ross_.HitTest({32, 32}), 1);
+}
+
+TEST_F(BobRossTest, BulkElementsCountOneIdEach) {
+  const CircleInstance circles[] = {
+      {{10, 10}, 5}, {{30, 10}, 5}, {{50, 10}, 5}};
+  const RectInstance rects[] = {{{0, 40}, {20, 60}}, {{30, 40}, {50, 60}}};
+  bob_ross_.BeginFrame();
+  bob_ross_.Rect({60, 40}, {80, 60});
+  bob_ross_.Circles(circles, 3);
+  bob_ross_.Rects(rects, 2);
+  bob_ross_.Circle({90, 10}, 5);
+  bob_ross_.EndFrame();
+  EXPECT_EQ(bob_ross_.HitTest({70, 50}), 0);
+  EXPECT_EQ(bob_ross_.HitTest({10, 10}), 1);
+  EXPECT_EQ(bob_ross_.HitTest({50, 10}), 3);
+  EXPECT_EQ(bob_ross_.HitTest({10, 50}), 4);
+  EXPECT_EQ(bob_ross_.HitTest({40, 50}), 5);
+  EXPECT_EQ(bob_ross_.HitTest({90, 10}), 6);
+}
+
+TEST_F(BobRossTest, CulledShapesKeepTheirIds) {
+  const RectInstance rects[] = {{{-50, 0}, {-10, 20}},
+                                {{10, 10}, {30, 30}},
+                                {{200, 0}, {220, 20}}};
+  bob_ross_.BeginFrame();
+  bob_ross_.Circle({-20, -20}, 5);
+  bob_ross_.Polygon({{120, 0}, {140, 0}, {130, 20}});
+  bob_ross_.Rects(rects, 3);
+  bob_ross_.Rect({50, 50}, {70, 70});
+  bob_ross_.EndFrame();
+  EXPECT_EQ(bob_ross_.HitTest({20, 20}), 3);
+  EXPECT_EQ(bob_ross_.HitTest({60, 60}), 5);
+}
+
+TEST_F(BobRossTest, CullsOffscreenShapes) {
+  bob_ross_.BeginFrame();
+  bob_ross_.Rect({-30, 10}, {-2, 20});
+  bob_ross_.Circle({50, -20}, 10);
+  bob_ross_.Polygon({{0, 90}, {10, 90}, {5, 100}});
+  EXPECT_TRUE(bob_ross_.commands().empty());
+
+  // Within the antialiasing padding of the edge, so kept.
+  bob_ross_.Rect({-30, 10}, {-0.5f, 20});
+  bob_ross_.Circle({50, -10.5f}, 11);
+  EXPECT_EQ(Types(),
+            (std::vector<CommandType>{CommandType::kSetFillColor,
+                                      CommandType::kRect,
+                                      CommandType::kCircle}));
+}
+
+TEST_F(BobRossTest, CullsBulkElements) {
+  const RectInstance rects[] = {{{-50, 0}, {-10, 20}},
+                                {{10, 10}, {30, 30}},
+                                {{200, 0}, {220, 20}},
+                                {{40, 10}, {60, 30}}};
+  const CircleInstance offscreen[] = {{{-20, -20}, 5}, {{200, 200}, 5}};
+  bob_ross_.BeginFrame();
+  bob_ross_.Rects(rects, 4);
+  bob_ross_.Circles(offscreen, 2);
+  std::vector<CommandType> types = Types();
+  ASSERT_EQ(types, (std::vector<CommandType>{CommandType::kSetFillColor,
+                                             CommandType::kRects}));
+  auto it = bob_ross_.commands().begin();
+  ++it;
+  const auto &command = (*it).As<RectsCommand>();
+  ASSERT_EQ(command.count, 2u);
+  EXPECT_EQ(command.rects()[0].top_left.x, 10);
+  EXPECT_EQ(command.rects()[1].top_left.x, 40);
+}
+
+TEST_F(BobRossTest, HitTestsLastFinishedFrame) {
+  bob_ross_.BeginFrame();
+  bob_ross_.Rect({0, 0}, {50, 50});
+  bob_ross_.EndFrame();
+  bob_ross_.BeginFrame();
+  bob_ross_.Circle({90, 70}, 5);
+  bob_ross_.Rect({0, 0}, {50, 50});
+  // Still the previous frame until this one ends.
+  EXPECT_EQ(bob_ross_.HitTest({25, 25}), 0);
+  bob_ross_.EndFrame();
+  EXPECT_EQ(bob_ross_.HitTest({25, 25}), 1);
+
+  bob_ross_.EnableHitTesting(false);
+  EXPECT_EQ(bob_ross_.HitTest({25, 25}), -1);
+}
+
+}  // namespace
+}  // namespace bob_ross
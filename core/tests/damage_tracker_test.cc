@@ -0,0 +1,178 @@
+#include <bob_ross/damage_tracker.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+constexpr int kWidth = 100, kHeight = 80;
+
+struct TestRect {
+  float left, top, right, bottom;
+  Color color;
+};
+
+class DamageTrackerTest : public testing::Test {
+ protected:
+  void SetUp() override { tracker_.Resize(kWidth, kHeight); }
+
+  const std::vector<PixelRect> &Frame(const std::vector<TestRect> &rects,
+                                      int buffer_age = 1) {
+    CommandBuffer commands;
+    for (const TestRect &rect : rects) {
+      commands.Append<SetFillColorCommand>()->color = rect.color;
+      auto *command = commands.Append<RectCommand>();
+      command->top_left = {rect.left, rect.top};
+      command->bottom_right = {rect.right, rect.bottom};
+    }
+    tracker_.Record(commands);
+    const std::vector<PixelRect> &damage = tracker_.Finish(buffer_age);
+    ExpectWellFormed(damage);
+    return damage;
+  }
+
+  static void ExpectWellFormed(const std::vector<PixelRect> &damage) {
+    EXPECT_LE(damage.size(), DamageTracker::kMaxRects);
+    for (size_t i = 0; i < damage.size(); i++) {
+      const PixelRect &a = damage[i];
+      EXPECT_LT(a.left, a.right);
+      EXPECT_LT(a.top, a.bottom);
+      EXPECT_GE(a.left, 0);
+      EXPECT_GE(a.top, 0);
+      EXPECT_LE(a.right, kWidth);
+      EXPECT_LE(a.bottom, kHeight);
+      for (size_t j = i + 1; j < damage.size(); j++) {
+        const PixelRect &b = damage[j];
+        bool overlap = a.left < b.right && b.left < a.right &&
+                       a.top < b.bottom && b.top < a.bottom;
+        EXPECT_FALSE(overlap) << "Damage rects " << i << " and " << j;
+      }
+    }
+  }
+
+  static bool Covers(const std::vector<PixelRect> &damage, int x, int y) {
+    for (const PixelRect &rect : damage) {
+      if (x >= rect.left && x < rect.right && y >= rect.top &&
+          y < rect.bottom) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static bool CoversRect(const std::vector<PixelRect> &damage,
+                         const PixelRect &rect) {
+    for (int y = rect.top; y < rect.bottom; y++) {
+      for (int x = rect.left; x < rect.right; x++) {
+        if (!Covers(damage, x, y)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  static bool IsFullScreen(const std::vector<PixelRect> &damage) {
+    return damage.size() == 1 && CoversRect(damage, {0, 0, kWidth, kHeight});
+  }
+
+  DamageTracker tracker_;
+};
+
+const Color kRed = {255, 0, 0, 255};
+const Color kBlue = {0, 0, 255, 255};
+
+TEST_F(DamageTrackerTest, FirstFrameIsFullScreen) {
+  EXPECT_TRUE(IsFullScreen(Frame({{10, 10, 20, 20, kRed}})));
+}
+
+TEST_F(DamageTrackerTest, IdenticalFrameHasNoDamage) {
+  std::vector<TestRect> rects = {{10, 10, 20, 20, kRed},
+                                 {30, 30, 50, 40, kBlue}};
+  Frame(rects);
+  EXPECT_TRUE(Frame(rects).empty());
+}
+
+TEST_F(DamageTrackerTest, MovedShapeDamagesBothPositions) {
+  Frame({{10, 10, 20, 20, kRed}, {60, 10, 70, 20, kBlue}});
+  const std::vector<PixelRect> &damage =
+      Frame({{10, 10, 20, 20, kRed}, {60, 40, 70, 50, kBlue}});
+  EXPECT_TRUE(CoversRect(damage, {60, 10, 70, 20}));
+  EXPECT_TRUE(CoversRect(damage, {60, 40, 70, 50}));
+  // The unchanged rect is kept.
+  EXPECT_FALSE(Covers(damage, 15, 15));
+}
+
+TEST_F(DamageTrackerTest, ColorChangeDamagesOnlyThatShape) {
+  Frame({{10, 10, 20, 20, kRed}, {60, 10, 70, 20, kBlue}});
+  const std::vector<PixelRect> &damage =
+      Frame({{10, 10, 20, 20, kRed}, {60, 10, 70, 20, kRed}});
+  EXPECT_TRUE(CoversRect(damage, {60, 10, 70, 20}));
+  EXPECT_FALSE(Covers(damage, 15, 15));
+}
+
+TEST_F(DamageTrackerTest, ReorderedOverlappingShapes) {
+  Frame({{10, 10, 40, 40, kRed}, {20, 20, 50, 50, kBlue}});
+  const std::vector<PixelRect> &damage =
+      Frame({{20, 20, 50, 50, kBlue}, {10, 10, 40, 40, kRed}});
+  EXPECT_TRUE(CoversRect(damage, {20, 20, 40, 40}));
+}
+
+TEST_F(DamageTrackerTest, AntialiasedEdgesArePadded) {
+  Frame({});
+  const std::vector<PixelRect> &damage = Frame({{10, 10, 20, 20, kRed}});
+  EXPECT_TRUE(CoversRect(damage, {9, 9, 21, 21}));
+}
+
+TEST_F(DamageTrackerTest, OlderBuffersAccumulateDamage) {
+  Frame({{10, 10, 20, 20, kRed}, {60, 10, 70, 20, kBlue}});
+  Frame({{10, 10, 20, 20, kBlue}, {60, 10, 70, 20, kBlue}});
+  const std::vector<PixelRect> &damage =
+      Frame({{10, 10, 20, 20, kBlue}, {60, 10, 70, 20, kRed}}, 2);
+  // A buffer two frames old misses both changes.
+  EXPECT_TRUE(CoversRect(damage, {10, 10, 20, 20}));
+  EXPECT_TRUE(CoversRect(damage, {60, 10, 70, 20}));
+}
+
+TEST_F(DamageTrackerTest, UnknownOrTooOldBuffersAreFullScreen) {
+  Frame({{10, 10, 20, 20, kRed}});
+  EXPECT_TRUE(IsFullScreen(Frame({{10, 10, 20, 20, kBlue}}, 0)));
+  EXPECT_TRUE(IsFullScreen(
+      Frame({{10, 10, 20, 20, kRed}}, DamageTracker::kMaxBufferAge + 1)));
+}
+
+TEST_F(DamageTrackerTest, InvalidateDamagesFullScreen) {
+  std::vector<TestRect> rects = {{10, 10, 20, 20, kRed}};
+  Frame(rects);
+  tracker_.Invalidate();
+  EXPECT_TRUE(IsFullScreen(Frame(rects)));
+  EXPECT_TRUE(Frame(rects).empty());
+}
+
+TEST_F(DamageTrackerTest, ManyChangesFitInMaxRects) {
+  std::vector<TestRect> before, after;
+  for (int i = 0; i < 8; i++) {
+    float x = 5 + i * 11.0f, y = 5 + (i % 3) * 25.0f;
+    before.push_back({x, y, x + 6, y + 6, kRed});
+    after.push_back({x, y, x + 6, y + 6, kBlue});
+  }
+  Frame(before);
+  const std::vector<PixelRect> &damage = Frame(after);
+  for (const TestRect &rect : after) {
+    EXPECT_TRUE(CoversRect(damage, {static_cast<int>(rect.left),
+                                    static_cast<int>(rect.top),
+                                    static_cast<int>(rect.right),
+                                    static_cast<int>(rect.bottom)}));
+  }
+}
+
+TEST_F(DamageTrackerTest, ResizeDamagesFullScreen) {
+  std::vector<TestRect> rects = {{10, 10, 20, 20, kRed}};
+  Frame(rects);
+  tracker_.Resize(kWidth, kHeight);
+  EXPECT_TRUE(IsFullScreen(Frame(rects)));
+}
+
+}  // namespace
+}  // namespace bob_ross
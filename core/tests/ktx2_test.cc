@@ -0,0 +1,229 @@
+#include <bob_ross/ktx2.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+constexpr size_t kLevelCountOffset = 40;
+constexpr size_t kLevelIndexOffset = 80;
+
+void Put32(std::vector<uint8_t> *data, size_t offset, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    (*data)[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+  }
+}
+
+class Ktx2Test : public testing::Test {
+ protected:
+  // A 16x8 ETC2 RGB8 texture with a full mip chain, every byte of each
+  // level numbered so misplaced data shows.
+  void SetUp() override {
+    texture_.format = kKtx2Etc2Rgb8;
+    texture_.width = 16;
+    texture_.height = 8;
+    // Levels point into levels_, which mustn't reallocate.
+    levels_.reserve(5);
+    int width = 16, height = 8;
+    for (int i = 0; i < 5; i++) {
+      size_t size = ((width + 3) / 4) * ((height + 3) / 4) * 8;
+      levels_.emplace_back(size);
+      for (size_t j = 0; j < size; j++) {
+        levels_.back()[j] = static_cast<uint8_t>(i * 31 + j);
+      }
+      texture_.levels.push_back({levels_.back().data(), size, width, height});
+      width = std::max(width / 2, 1);
+      height = std::max(height / 2, 1);
+    }
+  }
+
+  bool Parse(const std::vector<uint8_t> &data, Ktx2Texture *parsed) {
+    return ParseKtx2(data.data(), data.size(), parsed, &error_);
+  }
+
+  Ktx2Texture texture_;
+  std::vector<std::vector<uint8_t>> levels_;
+  std::string error_;
+};
+
+TEST_F(Ktx2Test, RoundTrips) {
+  for (uint32_t format : {kKtx2Etc2Rgb8, kKtx2Etc2Rgba8Srgb, kKtx2Astc4x4}) {
+    Ktx2Texture texture;
+    texture.format = format;
+    texture.width = 16;
+    texture.height = 8;
+    std::vector<std::vector<uint8_t>> levels;
+    levels.reserve(5);
+    int block_width, block_height, block_bytes;
+    ASSERT_TRUE(Ktx2BlockSize(format, &block_width, &block_height,
+                              &block_bytes));
+    int width = 16, height = 8;
+    for (int i = 0; i < 5; i++) {
+      size_t size = ((width + block_width - 1) / block_width) *
+                    ((height + block_height - 1) / block_height) * block_bytes;
+      levels.emplace_back(size, static_cast<uint8_t>(i + 1));
+      texture.levels.push_back({levels.back().data(), size, width, height});
+      width = std::max(width / 2, 1);
+      height = std::max(height / 2, 1);
+    }
+    std::vector<uint8_t> data = WriteKtx2(texture);
+
+    Ktx2Texture parsed;
+    ASSERT_TRUE(Parse(data, &parsed)) << error_;
+    EXPECT_EQ(parsed.format, format);
+    EXPECT_EQ(parsed.width, 16);
+    EXPECT_EQ(parsed.height, 8);
+    ASSERT_EQ(parsed.levels.size(), texture.levels.size());
+    for (size_t i = 0; i < parsed.levels.size(); i++) {
+      EXPECT_EQ(parsed.levels[i].width, texture.levels[i].width);
+      EXPECT_EQ(parsed.levels[i].height, texture.levels[i].height);
+      ASSERT_EQ(parsed.levels[i].size, levels[i].size());
+      EXPECT_EQ(std::vector<uint8_t>(
+                    parsed.levels[i].data,
+                    parsed.levels[i].data + parsed.levels[i].size),
+                levels[i]);
+    }
+  }
+}
+
+TEST_F(Ktx2Test, LevelDataIsNotCopied) {
+  std::vector<uint8_t> data = WriteKtx2(texture_);
+  Ktx2Texture parsed;
+  ASSERT_TRUE(Parse(data, &parsed)) << error_;
+  for (size_t i = 0; i < parsed.levels.size(); i++) {
+    EXPECT_GE(parsed.levels[i].data, data.data());
+    EXPECT_LE(parsed.levels[i].data + parsed.levels[i].size,
+              data.data() + data.size());
+    EXPECT_EQ(parsed.levels[i].data[1], levels_[i][1]);
+  }
+}
+
+TEST_F(Ktx2Test, DropsLevelPadding) {
+  // Level 2, 4x2, takes one 8 byte block. Written with 8 more bytes after
+  // it, which the file's level length includes.
+  std::vector<uint8_t> padded(16, 0xee);
+  std::copy(levels_[2].begin(), levels_[2].end(), padded.begin());
+  texture_.levels[2].data = padded.data();
+  texture_.levels[2].size = padded.size();
+  std::vector<uint8_t> data = WriteKtx2(texture_);
+
+  Ktx2Texture parsed;
+  ASSERT_TRUE(Parse(data, &parsed)) << error_;
+  ASSERT_EQ(parsed.levels[2].size, 8u);
+  EXPECT_EQ(std::vector<uint8_t>(parsed.levels[2].data,
+                                 parsed.levels[2].data + 8),
+            levels_[2]);
+  for (size_t i = 0; i < parsed.levels.size(); i++) {
+    EXPECT_EQ(parsed.levels[i].size, levels_[i].size());
+  }
+}
+
+TEST_F(Ktx2Test, RejectsOtherFiles) {
+  Ktx2Texture parsed;
+  std::vector<uint8_t> data = WriteKtx2(texture_);
+  EXPECT_FALSE(Parse(std::vector<uint8_t>(data.begin(), data.begin() + 79),
+                     &parsed));
+  data[1] = 'X';
+  EXPECT_FALSE(Parse(data, &parsed));
+  EXPECT_EQ(error_, "Not a KTX2 file");
+}
+
+TEST_F(Ktx2Test, RejectsUnsupportedFormat) {
+  std::vector<uint8_t> data = WriteKtx2(texture_);
+  // VK_FORMAT_R8G8B8A8_UNORM.
+  Put32(&data, 12, 37);
+  Ktx2Texture parsed;
+  EXPECT_FALSE(Parse(data, &parsed));
+  EXPECT_EQ(error_, "Unsupported format 37");
+}
+
+TEST_F(Ktx2Test, RejectsTruncatedLevelIndex) {
+  std::vector<uint8_t> data = WriteKtx2(texture_);
+  data.resize(kLevelIndexOffset + 24 * 5 - 1);
+  Ktx2Texture parsed;
+  EXPECT_FALSE(Parse(data, &parsed));
+  EXPECT_EQ(error_, "Truncated level index");
+}
+
+TEST_F(Ktx2Test, RejectsHugeLevelCount) {
+  for (uint32_t level_count : {6u, 33u, 64u, 0xffffffffu}) {
+    std::vector<uint8_t> data = WriteKtx2(texture_);
+    Put32(&data, kLevelCountOffset, level_count);
+    Ktx2Texture parsed;
+    EXPECT_FALSE(Parse(data, &parsed)) << level_count;
+    EXPECT_EQ(error_, "Too many mip levels") << level_count;
+  }
+}
+
+TEST_F(Ktx2Test, RejectsOversizedDimensions) {
+  for (size_t offset : {20, 24}) {
+    for (uint32_t size : {0x80000000u, 0xffffffffu}) {
+      std::vector<uint8_t> data = WriteKtx2(texture_);
+      Put32(&data, offset, size);
+      Ktx2Texture parsed;
+      EXPECT_FALSE(Parse(data, &parsed));
+      EXPECT_EQ(error_, "Texture is too large");
+    }
+  }
+}
+
+TEST_F(Ktx2Test, RejectsLargeDimensionsWithoutData) {
+  // Fits an int, but the levels are far too small for it.
+  std::vector<uint8_t> data = WriteKtx2(texture_);
+  Put32(&data, 20, 0x7fffffff);
+  Ktx2Texture parsed;
+  EXPECT_FALSE(Parse(data, &parsed));
+  EXPECT_EQ(error_, "Level 0 is out of bounds");
+}
+
+TEST_F(Ktx2Test, RejectsOutOfBoundsLevels) {
+  std::vector<uint8_t> valid = WriteKtx2(texture_);
+  size_t entry = kLevelIndexOffset + 2 * 24;
+  Ktx2Texture parsed;
+
+  // Offset past the end.
+  std::vector<uint8_t> data = valid;
+  Put32(&data, entry, static_cast<uint32_t>(data.size() + 1));
+  EXPECT_FALSE(Parse(data, &parsed));
+  EXPECT_EQ(error_, "Level 2 is out of bounds");
+
+  // Length running past the end, in the high word so offset + length
+  // would wrap.
+  data = valid;
+  Put32(&data, entry + 12, 0xffffffff);
+  EXPECT_FALSE(Parse(data, &parsed));
+  EXPECT_EQ(error_, "Level 2 is out of bounds");
+
+  // Shorter than the level's blocks.
+  data = valid;
+  Put32(&data, entry + 8, 7);
+  EXPECT_FALSE(Parse(data, &parsed));
+  EXPECT_EQ(error_, "Level 2 is out of bounds");
+
+  // The file ending before the last level does.
+  data = valid;
+  data.resize(data.size() - 1);
+  EXPECT_FALSE(Parse(data, &parsed));
+  EXPECT_EQ(error_, "Level 0 is out of bounds");
+}
+
+TEST_F(Ktx2Test, RejectsOtherTextureTypes) {
+  Ktx2Texture parsed;
+  // Depth, array layers and faces.
+  for (size_t offset : {28, 32, 36}) {
+    std::vector<uint8_t> data = WriteKtx2(texture_);
+    Put32(&data, offset, 6);
+    EXPECT_FALSE(Parse(data, &parsed));
+    EXPECT_EQ(error_, "Not a single 2D texture");
+  }
+  std::vector<uint8_t> data = WriteKtx2(texture_);
+  Put32(&data, 44, 1);
+  EXPECT_FALSE(Parse(data, &parsed));
+  EXPECT_EQ(error_, "Supercompressed files aren't supported");
+}
+
+}  // namespace
+}  // namespace bob_ross
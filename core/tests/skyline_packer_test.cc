@@ -0,0 +1,124 @@
+#include <bob_ross/skyline_packer.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+struct Placed {
+  int x, y, width, height;
+};
+
+bool Overlap(const Placed &a, const Placed &b) {
+  return a.x < b.x + b.width && b.x < a.x + a.width &&
+         a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+TEST(SkylinePackerTest, PlacesInBoundsWithoutOverlap) {
+  std::mt19937 random(5);
+  for (int round = 0; round < 20; round++) {
+    SkylinePacker packer(128 + round, 96);
+    std::vector<Placed> placed;
+    int64_t area = 0;
+    for (int i = 0; i < 300; i++) {
+      Placed rect = {0, 0, 1 + static_cast<int>(random() % 40),
+                     1 + static_cast<int>(random() % 30)};
+      if (!packer.Pack(rect.width, rect.height, &rect.x, &rect.y)) {
+        continue;
+      }
+      ASSERT_GE(rect.x, 0);
+      ASSERT_GE(rect.y, 0);
+      ASSERT_LE(rect.x + rect.width, packer.width());
+      ASSERT_LE(rect.y + rect.height, packer.height());
+      for (const Placed &other : placed) {
+        ASSERT_FALSE(Overlap(rect, other))
+            << rect.x << "," << rect.y << " " << rect.width << "x"
+            << rect.height << " overlaps " << other.x << "," << other.y;
+      }
+      placed.push_back(rect);
+      area += static_cast<int64_t>(rect.width) * rect.height;
+    }
+    EXPECT_EQ(packer.used_area(), area);
+    // Roughly sorted input would do better, random still fills most.
+    EXPECT_GT(area, packer.width() * packer.height() / 2) << round;
+  }
+}
+
+TEST(SkylinePackerTest, RestsOnLowestSkyline) {
+  SkylinePacker packer(32, 32);
+  int x, y;
+  ASSERT_TRUE(packer.Pack(10, 8, &x, &y));
+  EXPECT_EQ(x, 0);
+  EXPECT_EQ(y, 0);
+  ASSERT_TRUE(packer.Pack(10, 4, &x, &y));
+  EXPECT_EQ(x, 10);
+  EXPECT_EQ(y, 0);
+  // Lowest on the shorter rectangle, which it overhangs onto the floor.
+  ASSERT_TRUE(packer.Pack(14, 4, &x, &y));
+  EXPECT_EQ(x, 10);
+  EXPECT_EQ(y, 4);
+  // Too wide for the floor left at the right, so on top of the others.
+  ASSERT_TRUE(packer.Pack(12, 2, &x, &y));
+  EXPECT_EQ(x, 0);
+  EXPECT_EQ(y, 8);
+}
+
+TEST(SkylinePackerTest, MergesSegmentsAtTheSameHeight) {
+  SkylinePacker packer(32, 32);
+  EXPECT_EQ(packer.segment_count(), 1u);
+  int x, y;
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(packer.Pack(8, 8, &x, &y));
+    EXPECT_EQ(x, i * 8);
+    // The row so far, then the floor.
+    EXPECT_EQ(packer.segment_count(), 2u);
+  }
+  // Completes the row, leaving a single segment.
+  ASSERT_TRUE(packer.Pack(8, 8, &x, &y));
+  EXPECT_EQ(packer.segment_count(), 1u);
+  ASSERT_TRUE(packer.Pack(32, 8, &x, &y));
+  EXPECT_EQ(y, 8);
+  EXPECT_EQ(packer.segment_count(), 1u);
+  // Different heights stay apart, then merge once level.
+  ASSERT_TRUE(packer.Pack(8, 4, &x, &y));
+  EXPECT_EQ(packer.segment_count(), 2u);
+  ASSERT_TRUE(packer.Pack(24, 8, &x, &y));
+  EXPECT_EQ(x, 8);
+  EXPECT_EQ(y, 16);
+  EXPECT_EQ(packer.segment_count(), 2u);
+  ASSERT_TRUE(packer.Pack(8, 4, &x, &y));
+  EXPECT_EQ(x, 0);
+  EXPECT_EQ(y, 20);
+  EXPECT_EQ(packer.segment_count(), 1u);
+}
+
+TEST(SkylinePackerTest, RefusesWhenFull) {
+  SkylinePacker packer(32, 32);
+  int x, y;
+  for (int i = 0; i < 16; i++) {
+    ASSERT_TRUE(packer.Pack(8, 8, &x, &y)) << i;
+  }
+  EXPECT_EQ(packer.used_area(), 32 * 32);
+  EXPECT_FALSE(packer.Pack(1, 1, &x, &y));
+  EXPECT_EQ(packer.used_area(), 32 * 32);
+
+  packer.Reset();
+  EXPECT_EQ(packer.used_area(), 0);
+  EXPECT_FALSE(packer.Pack(33, 1, &x, &y));
+  EXPECT_FALSE(packer.Pack(1, 33, &x, &y));
+  EXPECT_FALSE(packer.Pack(0, 4, &x, &y));
+  EXPECT_FALSE(packer.Pack(4, -1, &x, &y));
+  ASSERT_TRUE(packer.Pack(24, 32, &x, &y));
+  // Refusals leave the area as it was.
+  EXPECT_FALSE(packer.Pack(16, 1, &x, &y));
+  EXPECT_EQ(packer.segment_count(), 2u);
+  ASSERT_TRUE(packer.Pack(8, 32, &x, &y));
+  EXPECT_EQ(x, 24);
+  EXPECT_EQ(y, 0);
+  EXPECT_EQ(packer.used_area(), 32 * 32);
+}
+
+}  // namespace
+}  // namespace bob_ross
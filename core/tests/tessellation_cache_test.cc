@@ -0,0 +1,182 @@
+#include <bob_ross/tessellation_cache.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+float FromBits(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// 64 bit FNV-1a of the outline's x and y, as the cache hashes it.
+uint64_t Hash(const std::vector<Point> &outline) {
+  uint64_t hash = 14695981039346656037ull;
+  for (const Point &point : outline) {
+    const float xy[2] = {point.x, point.y};
+    auto *bytes = reinterpret_cast<const uint8_t *>(xy);
+    for (size_t i = 0; i < sizeof(xy); i++) {
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+// A concave outline, on quarter pixels so moving it is exact.
+std::vector<Point> Star(float x, float y, float z = 0) {
+  const float offsets[][2] = {{0, -10},       {2.5f, -3.25f}, {9.5f, -3},
+                              {4, 1.75f},     {6, 8.5f},      {0, 4.5f},
+                              {-6, 8.5f},     {-4, 1.75f},    {-9.5f, -3},
+                              {-2.5f, -3.25f}};
+  std::vector<Point> points;
+  for (const auto &offset : offsets) {
+    points.push_back({x + offset[0], y + offset[1], z});
+  }
+  return points;
+}
+
+// A pentagon |size| pixels wide.
+std::vector<Point> Pentagon(float size) {
+  return {{0, 0},
+          {size, 0},
+          {size * 1.5f, size},
+          {size / 2, size * 2},
+          {-size / 2, size}};
+}
+
+// Records an outline without indices in |commands|.
+const PolygonCommand &Record(const std::vector<Point> &points,
+                             CommandBuffer *commands) {
+  auto *polygon =
+      commands->Append<PolygonCommand>(points.size() * sizeof(Point));
+  polygon->point_count = static_cast<uint32_t>(points.size());
+  polygon->index_count = 0;
+  std::memcpy(polygon->points(), points.data(),
+              points.size() * sizeof(Point));
+  return *polygon;
+}
+
+class TessellationCacheTest : public testing::Test {
+ protected:
+  Mesh Draw(const std::vector<Point> &points, uint32_t color = 0xff0000ff) {
+    CommandBuffer commands;
+    Mesh mesh;
+    cache_.TessellatePolygon(Record(points, &commands), color, &triangulator_,
+                             &mesh);
+    return mesh;
+  }
+
+  Triangulator triangulator_;
+  TessellationCache cache_;
+};
+
+TEST_F(TessellationCacheTest, ReusesTrianglesOfMovedOutlines) {
+  Mesh first = Draw(Star(20, 30, 1));
+  EXPECT_EQ(cache_.misses(), 1u);
+  EXPECT_EQ(cache_.hits(), 0u);
+  ASSERT_EQ(first.indices.size(), 3 * (Star(0, 0).size() - 2));
+
+  std::vector<Point> moved = Star(-117.25f, 4000.5f, 3);
+  Mesh second = Draw(moved, 0xff00ff00);
+  EXPECT_EQ(cache_.hits(), 1u);
+  EXPECT_EQ(cache_.misses(), 1u);
+  EXPECT_EQ(cache_.entry_count(), 1u);
+  EXPECT_EQ(second.indices, first.indices);
+  // At the new position, depth and color.
+  ASSERT_EQ(second.vertices.size(), moved.size());
+  for (size_t i = 0; i < moved.size(); i++) {
+    EXPECT_EQ(second.vertices[i].x, moved[i].x);
+    EXPECT_EQ(second.vertices[i].y, moved[i].y);
+    EXPECT_EQ(second.vertices[i].z, 3);
+    EXPECT_EQ(second.vertices[i].color, 0xff00ff00u);
+  }
+
+  // Same as the uncached path, which triangulates where the outline is.
+  CommandBuffer commands;
+  Mesh uncached;
+  TessellatePolygon(Record(moved, &commands), 0xff00ff00, &triangulator_,
+                    &uncached);
+  EXPECT_EQ(second.indices, uncached.indices);
+}
+
+TEST_F(TessellationCacheTest, ComparesOutlinesInFullOnHashHit) {
+  // Two pentagons whose relative outlines share a hash, found by a
+  // collision search.
+  const std::vector<Point> a = {
+      {0, 0}, {10, 0}, {14, 6}, {7, FromBits(0x41050d6f)},
+      {FromBits(0xc01c0fec), FromBits(0x40b3b800)}};
+  const std::vector<Point> b = {
+      {0, 0}, {10, 0}, {14, 6}, {7, FromBits(0x41297948)},
+      {FromBits(0xc00e08c8), FromBits(0x4091c668)}};
+  ASSERT_EQ(Hash(a), Hash(b)) << "Find a new colliding pair";
+
+  Draw(a);
+  Mesh mesh = Draw(b);
+  EXPECT_EQ(cache_.hits(), 0u);
+  EXPECT_EQ(cache_.misses(), 2u);
+  EXPECT_EQ(cache_.entry_count(), 2u);
+  EXPECT_EQ(mesh.vertices[3].y, b[3].y);
+  // Both found again under their shared hash.
+  Draw(a);
+  Draw(b);
+  EXPECT_EQ(cache_.hits(), 2u);
+  EXPECT_EQ(cache_.misses(), 2u);
+}
+
+TEST_F(TessellationCacheTest, EvictsLeastRecentlyUsedWithinBudget) {
+  // Pentagons all take the same bytes.
+  Draw(Pentagon(40));
+  size_t entry_bytes = cache_.size_bytes();
+  ASSERT_GT(entry_bytes, 0u);
+  cache_.Clear();
+  EXPECT_EQ(cache_.entry_count(), 0u);
+  cache_.SetBudget(2 * entry_bytes + entry_bytes / 2);
+
+  Draw(Pentagon(10));
+  Draw(Pentagon(20));
+  EXPECT_EQ(cache_.entry_count(), 2u);
+  // Now more recently used than 20.
+  Draw(Pentagon(10));
+  EXPECT_EQ(cache_.hits(), 1u);
+  // Evicts 20.
+  Draw(Pentagon(30));
+  EXPECT_EQ(cache_.entry_count(), 2u);
+  EXPECT_LE(cache_.size_bytes(), cache_.budget_bytes());
+  Draw(Pentagon(10));
+  Draw(Pentagon(30));
+  EXPECT_EQ(cache_.hits(), 3u);
+  Draw(Pentagon(20));
+  EXPECT_EQ(cache_.hits(), 3u);
+  EXPECT_EQ(cache_.misses(), 5u);
+
+  // Shrinking keeps the most recently used, 20.
+  cache_.SetBudget(entry_bytes);
+  EXPECT_EQ(cache_.entry_count(), 1u);
+  Draw(Pentagon(20));
+  EXPECT_EQ(cache_.hits(), 4u);
+  Draw(Pentagon(30));
+  EXPECT_EQ(cache_.misses(), 6u);
+
+  // Entries larger than the budget are not kept.
+  Draw(Star(0, 0));
+  EXPECT_EQ(cache_.misses(), 7u);
+  EXPECT_EQ(cache_.entry_count(), 1u);
+  Draw(Pentagon(30));
+  EXPECT_EQ(cache_.hits(), 5u);
+
+  // 0 disables the cache.
+  cache_.SetBudget(0);
+  EXPECT_EQ(cache_.entry_count(), 0u);
+  EXPECT_EQ(cache_.size_bytes(), 0u);
+  Draw(Pentagon(30));
+  EXPECT_EQ(cache_.hits(), 5u);
+  EXPECT_EQ(cache_.misses(), 7u);
+}
+
+}  // namespace
+}  // namespace bob_ross
@@ -0,0 +1,160 @@
+#include <bob_ross/triangulator.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+constexpr float kPi = 3.14159265f;
+
+double OutlineArea(const std::vector<Point> &points) {
+  double area = 0;
+  for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++) {
+    area += static_cast<double>(points[j].x) * points[i].y -
+            static_cast<double>(points[i].x) * points[j].y;
+  }
+  return std::abs(area) / 2;
+}
+
+template <typename Index>
+double TrianglesArea(const std::vector<Point> &points,
+                     const std::vector<Index> &indices, Index base) {
+  double area = 0;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    const Point &a = points[indices[i] - base];
+    const Point &b = points[indices[i + 1] - base];
+    const Point &c = points[indices[i + 2] - base];
+    area += std::abs((static_cast<double>(b.x) - a.x) * (c.y - a.y) -
+                     (static_cast<double>(c.x) - a.x) * (b.y - a.y)) /
+            2;
+  }
+  return area;
+}
+
+std::vector<uint32_t> Triangulate(const std::vector<Point> &points) {
+  Triangulator triangulator;
+  std::vector<uint32_t> indices;
+  triangulator.Triangulate(points.data(), points.size(), 0u, &indices);
+  return indices;
+}
+
+// Checks that the triangles cover the outline exactly, and returns how
+// many there are.
+size_t ExpectCover(const std::vector<Point> &points) {
+  std::vector<uint32_t> indices = Triangulate(points);
+  EXPECT_EQ(indices.size() % 3, 0u);
+  for (uint32_t index : indices) {
+    EXPECT_LT(index, points.size());
+  }
+  double area = OutlineArea(points);
+  EXPECT_NEAR(TrianglesArea(points, indices, 0u), area, area * 1e-4);
+  return indices.size() / 3;
+}
+
+std::vector<Point> Star(size_t tips, float outer, float inner) {
+  std::vector<Point> points;
+  for (size_t i = 0; i < tips * 2; i++) {
+    float angle = kPi * i / tips;
+    float radius = i % 2 ? inner : outer;
+    points.push_back({100 + radius * std::cos(angle),
+                      100 + radius * std::sin(angle)});
+  }
+  return points;
+}
+
+TEST(TriangulatorTest, Convex) {
+  std::vector<Point> square = {{0, 0}, {10, 0}, {10, 10}, {0, 10}};
+  EXPECT_EQ(ExpectCover(square), 2u);
+}
+
+TEST(TriangulatorTest, ConcaveHasNMinusTwoTriangles) {
+  std::vector<Point> arrow = {{0, 0}, {10, 5}, {0, 10}, {3, 5}};
+  EXPECT_EQ(ExpectCover(arrow), 2u);
+  std::vector<Point> comb = {{0, 0},  {10, 0}, {10, 10}, {8, 10},
+                             {7, 2},  {6, 10}, {4, 10},  {3, 2},
+                             {2, 10}, {0, 10}};
+  EXPECT_EQ(ExpectCover(comb), comb.size() - 2);
+  std::vector<Point> star = Star(5, 50, 20);
+  EXPECT_EQ(ExpectCover(star), star.size() - 2);
+}
+
+TEST(TriangulatorTest, EitherWinding) {
+  std::vector<Point> star = Star(7, 50, 15);
+  std::vector<Point> reversed(star.rbegin(), star.rend());
+  EXPECT_EQ(ExpectCover(star), star.size() - 2);
+  EXPECT_EQ(ExpectCover(reversed), reversed.size() - 2);
+}
+
+TEST(TriangulatorTest, LargeOutlinesUseTheCurveIndex) {
+  std::vector<Point> star = Star(100, 90, 40);
+  ASSERT_GT(star.size(), Triangulator::kHashThreshold);
+  EXPECT_EQ(ExpectCover(star), star.size() - 2);
+
+  std::vector<Point> circle;
+  for (int i = 0; i < 500; i++) {
+    float angle = 2 * kPi * i / 500;
+    circle.push_back({50 * std::cos(angle), 50 * std::sin(angle)});
+  }
+  EXPECT_EQ(ExpectCover(circle), circle.size() - 2);
+}
+
+TEST(TriangulatorTest, CollinearPointsAreSkipped) {
+  std::vector<Point> square = {{0, 0},   {5, 0}, {10, 0}, {10, 5},
+                               {10, 10}, {5, 10}, {0, 10}, {0, 5}};
+  EXPECT_LE(ExpectCover(square), square.size() - 2);
+}
+
+TEST(TriangulatorTest, DuplicatePoints) {
+  std::vector<Point> square = {{0, 0},   {0, 0},  {10, 0}, {10, 10},
+                               {10, 10}, {0, 10}, {0, 0}};
+  EXPECT_LE(ExpectCover(square), square.size() - 2);
+}
+
+TEST(TriangulatorTest, SelfTouchingOutline) {
+  // Two squares meeting at (10, 10), walked as one outline.
+  std::vector<Point> squares = {{0, 0},   {10, 0},  {10, 10}, {20, 10},
+                                {20, 20}, {10, 20}, {10, 10}, {0, 10}};
+  ExpectCover(squares);
+}
+
+TEST(TriangulatorTest, DegenerateOutlines) {
+  EXPECT_TRUE(Triangulate({}).empty());
+  EXPECT_TRUE(Triangulate({{0, 0}, {1, 1}}).empty());
+  std::vector<Point> line = {{0, 0}, {5, 5}, {10, 10}, {2, 2}};
+  EXPECT_EQ(TrianglesArea(line, Triangulate(line), 0u), 0);
+  std::vector<Point> point = {{3, 3}, {3, 3}, {3, 3}};
+  EXPECT_EQ(TrianglesArea(point, Triangulate(point), 0u), 0);
+}
+
+TEST(TriangulatorTest, IndicesAreOffsetAndAppended) {
+  std::vector<Point> star = Star(5, 50, 20);
+  Triangulator triangulator;
+  std::vector<uint16_t> indices = {7, 7, 7};
+  triangulator.Triangulate(star.data(), star.size(), uint16_t{100},
+                           &indices);
+  ASSERT_EQ(indices.size(), 3 + (star.size() - 2) * 3);
+  std::vector<uint16_t> appended(indices.begin() + 3, indices.end());
+  for (uint16_t index : appended) {
+    EXPECT_GE(index, 100);
+    EXPECT_LT(index, 100 + star.size());
+  }
+  EXPECT_NEAR(TrianglesArea(star, appended, uint16_t{100}),
+              OutlineArea(star), 1e-2);
+}
+
+TEST(TriangulatorTest, ReusedBetweenCalls) {
+  Triangulator triangulator;
+  std::vector<Point> big = Star(100, 90, 40);
+  std::vector<Point> small = {{0, 0}, {10, 0}, {0, 10}};
+  std::vector<uint32_t> indices;
+  triangulator.Triangulate(big.data(), big.size(), 0u, &indices);
+  indices.clear();
+  triangulator.Triangulate(small.data(), small.size(), 0u, &indices);
+  EXPECT_EQ(indices.size(), 3u);
+}
+
+}  // namespace
+}  // namespace bob_ross
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <bob_ross/backend.h>
+#include <bob_ross/draw_sorter.h>
+#include <bob_ross/tessellation_cache.h>
+#include <bob_ross/tessellator.h>
+#include <bob_ross/triangulator.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace bob_ross {
+
+class ThreadPool;
+struct RasterTarget;
+
+struct CpuOptions {
+  // Color the framebuffer is cleared to at every BeginFrame. Frames with
+  // clip rectangles only clear inside them.
+  Color clear_color = {0, 0, 0, 0};
+  bool clear_on_begin_frame = true;
+  // Threads used to rasterize, including the calling one. 0 uses one per
+  // hardware thread.
+  int thread_count = 1;
+  // Memory kept for polygon triangulations reused across frames. 0 turns
+  // the cache off.
+  size_t tessellation_cache_bytes = TessellationCache::kDefaultBudgetBytes;
+};
+
+// Draws BobRoss commands into an RGBA8 framebuffer in memory, without a GPU.
+// Shapes are scan converted into horizontal spans which are filled or
+// blended with SSE2/AVX2/NEON where available. Coverage follows pixel
+// centers with a top-left rule and blending matches GL's
+// GL_SRC_ALPHA/GL_ONE_MINUS_SRC_ALPHA, so the output is deterministic and
+// can serve as a reference image.
+//
+// With more than one thread, every replay is first binned into kTileSize
+// square tiles. Tiles are then rasterized in parallel, each by a single
+// thread, so a tile's pixels stay in cache and no locking is needed.
+// Primitives keep their submission order within a tile, so the output is
+// identical to the single threaded path.
+class CpuBackend : public Backend {
+ public:
+  static constexpr int kTileSize = 64;
+
+  CpuBackend();
+  explicit CpuBackend(const CpuOptions &options);
+  ~CpuBackend() override;
+
+  void Resize(int screen_width, int screen_height) override;
+  void BeginFrame() override;
+  void Replay(const CommandBuffer &commands) override;
+  void SetClipRects(const PixelRect *rects, size_t count) override;
+  void EndFrame() override;
+
+  void Clear(Color color);
+
+  // Row major RGBA8 pixels, |width()| pixels per row, top row first.
+  const uint32_t *pixels() const { return pixels_.data(); }
+  int width() const { return width_; }
+  int height() const { return height_; }
+  int thread_count() const;
+  const TessellationCache &tessellation_cache() const {
+    return tessellation_cache_;
+  }
+
+ private:
+  // A primitive binned into tiles. |params| holds x0, y0, x1, y1 for rects,
+  // center and radius for circles and the three corners of triangles.
+  struct BinnedShape {
+    enum class Kind : uint8_t { kRect, kCircle, kTriangle };
+    Kind kind;
+    uint32_t color;
+    float params[6];
+  };
+
+  void ClearPending();
+  void ReplayDirect(const std::vector<Draw> &draws,
+                    const RasterTarget &target);
+  void ReplayTiled(const std::vector<Draw> &draws);
+  void BinRect(const RectInstance &rect, uint32_t color);
+  void BinCircle(const CircleInstance &circle, uint32_t color);
+  void BinShape(const BinnedShape &shape, float min_x, float min_y,
+                float max_x, float max_y);
+  void RasterizeTile(int tile);
+  void RasterizeTileShapes(int tile, const RasterTarget &target);
+
+  CpuOptions options_;
+  int width_ = 0, height_ = 0;
+  std::vector<uint32_t> pixels_;
+  std::vector<PixelRect> clip_rects_;
+  bool clear_pending_ = false;
+  Mesh mesh_;
+  Triangulator triangulator_;
+  DrawSorter draw_sorter_;
+  TessellationCache tessellation_cache_;
+
+  std::unique_ptr<ThreadPool> pool_;
+  int tiles_x_ = 0, tiles_y_ = 0;
+  std::vector<BinnedShape> shapes_;
+  std::vector<std::vector<uint32_t>> tile_shapes_;
+};
+
+}  // namespace bob_ross
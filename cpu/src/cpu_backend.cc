@@ -0,0 +1,291 @@
+#include <bob_ross/cpu_backend.h>
+#include <bob_ross/trace.h>
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "rasterizer.h"
+#include "span_fill.h"
+#include "thread_pool.h"
+
+namespace bob_ross {
+namespace {
+
+int ResolveThreadCount(int thread_count) {
+  if (thread_count > 0) {
+    return thread_count;
+  }
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+}  // namespace
+
+CpuBackend::CpuBackend() : CpuBackend(CpuOptions()) {}
+
+CpuBackend::CpuBackend(const CpuOptions &options)
+    : options_(options),
+      tessellation_cache_(options.tessellation_cache_bytes),
+      pool_(std::make_unique<ThreadPool>(
+          ResolveThreadCount(options.thread_count))) {}
+
+CpuBackend::~CpuBackend() = default;
+
+int CpuBackend::thread_count() const { return pool_->thread_count(); }
+
+void CpuBackend::Resize(int screen_width, int screen_height) {
+  width_ = std::max(screen_width, 0);
+  height_ = std::max(screen_height, 0);
+  pixels_.assign(static_cast<size_t>(width_) * height_,
+                 PackColor(options_.clear_color));
+  tiles_x_ = (width_ + kTileSize - 1) / kTileSize;
+  tiles_y_ = (height_ + kTileSize - 1) / kTileSize;
+  tile_shapes_.assign(static_cast<size_t>(tiles_x_) * tiles_y_, {});
+  draw_sorter_.Resize(width_, height_);
+  clip_rects_.assign(1, {0, 0, width_, height_});
+}
+
+void CpuBackend::BeginFrame() {
+  clip_rects_.assign(1, {0, 0, width_, height_});
+  // Deferred until the clip rectangles are known.
+  clear_pending_ = options_.clear_on_begin_frame;
+}
+
+void CpuBackend::Replay(const CommandBuffer &commands) {
+  BOB_ROSS_TRACE_SCOPE("CpuBackend::Replay");
+  ClearPending();
+  // There is no GL state to group by, only layers are sorted.
+  const std::vector<Draw> &draws = draw_sorter_.Sort(commands, nullptr);
+  if (pool_->thread_count() > 1) {
+    ReplayTiled(draws);
+  } else {
+    for (const PixelRect &rect : clip_rects_) {
+      ReplayDirect(draws, {pixels_.data(), width_, rect.left, rect.top,
+                           rect.right, rect.bottom});
+    }
+  }
+}
+
+void CpuBackend::SetClipRects(const PixelRect *rects, size_t count) {
+  clip_rects_.clear();
+  for (size_t i = 0; i < count; i++) {
+    clip_rects_.push_back({std::max(rects[i].left, 0),
+                           std::max(rects[i].top, 0),
+                           std::min(rects[i].right, width_),
+                           std::min(rects[i].bottom, height_)});
+  }
+}
+
+void CpuBackend::EndFrame() { ClearPending(); }
+
+void CpuBackend::ClearPending() {
+  if (!clear_pending_) {
+    return;
+  }
+  clear_pending_ = false;
+  if (clip_rects_.size() == 1 && clip_rects_[0].left == 0 &&
+      clip_rects_[0].top == 0 && clip_rects_[0].right == width_ &&
+      clip_rects_[0].bottom == height_) {
+    Clear(options_.clear_color);
+    return;
+  }
+  uint32_t packed = PackColor(options_.clear_color);
+  for (const PixelRect &rect : clip_rects_) {
+    for (int y = rect.top; y < rect.bottom; y++) {
+      FillSpan(pixels_.data() + static_cast<size_t>(y) * width_ + rect.left,
+               rect.right - rect.left, packed);
+    }
+  }
+}
+
+void CpuBackend::Clear(Color color) {
+  uint32_t packed = PackColor(color);
+  pool_->ParallelFor(tiles_y_, [&](int tile_row) {
+    int y0 = tile_row * kTileSize;
+    int y1 = std::min(y0 + kTileSize, height_);
+    FillSpan(pixels_.data() + static_cast<size_t>(y0) * width_,
+             (y1 - y0) * width_, packed);
+  });
+}
+
+void CpuBackend::ReplayDirect(const std::vector<Draw> &draws,
+                              const RasterTarget &target) {
+  for (const Draw &draw : draws) {
+    CommandRef command = draw.command;
+    uint32_t color = draw.color;
+    switch (command.type) {
+      case CommandType::kSetFillColor:
+        // Folded into the draws by the sorter.
+        break;
+      case CommandType::kCircle:
+        RasterizeCircle(target, command.As<CircleCommand>(), color);
+        break;
+      case CommandType::kRect:
+        RasterizeRect(target, command.As<RectCommand>(), color);
+        break;
+      case CommandType::kPolygon: {
+        mesh_.Clear();
+        tessellation_cache_.TessellatePolygon(command.As<PolygonCommand>(),
+                                              color, &triangulator_, &mesh_);
+        const Vertex *vertices = mesh_.vertices.data();
+        for (size_t i = 0; i + 2 < mesh_.indices.size(); i += 3) {
+          RasterizeTriangle(target, &vertices[mesh_.indices[i]].x,
+                            &vertices[mesh_.indices[i + 1]].x,
+                            &vertices[mesh_.indices[i + 2]].x, color);
+        }
+        break;
+      }
+      case CommandType::kCircles: {
+        const auto &circles = command.As<CirclesCommand>();
+        for (uint32_t i = 0; i < circles.count; i++) {
+          RasterizeCircle(target, circles.circles()[i], color);
+        }
+        break;
+      }
+      case CommandType::kRects: {
+        const auto &rects = command.As<RectsCommand>();
+        for (uint32_t i = 0; i < rects.count; i++) {
+          RasterizeRect(target, rects.rects()[i], color);
+        }
+        break;
+      }
+    }
+  }
+}
+
+void CpuBackend::ReplayTiled(const std::vector<Draw> &draws) {
+  shapes_.clear();
+  for (std::vector<uint32_t> &tile : tile_shapes_) {
+    tile.clear();
+  }
+
+  for (const Draw &draw : draws) {
+    CommandRef command = draw.command;
+    uint32_t color = draw.color;
+    switch (command.type) {
+      case CommandType::kSetFillColor:
+        // Folded into the draws by the sorter.
+        break;
+      case CommandType::kCircle:
+        BinCircle(command.As<CircleCommand>(), color);
+        break;
+      case CommandType::kRect:
+        BinRect(command.As<RectCommand>(), color);
+        break;
+      case CommandType::kPolygon: {
+        mesh_.Clear();
+        tessellation_cache_.TessellatePolygon(command.As<PolygonCommand>(),
+                                              color, &triangulator_, &mesh_);
+        const Vertex *vertices = mesh_.vertices.data();
+        for (size_t i = 0; i + 2 < mesh_.indices.size(); i += 3) {
+          const Vertex &a = vertices[mesh_.indices[i]];
+          const Vertex &b = vertices[mesh_.indices[i + 1]];
+          const Vertex &c = vertices[mesh_.indices[i + 2]];
+          BinnedShape shape = {BinnedShape::Kind::kTriangle,
+                               color,
+                               {a.x, a.y, b.x, b.y, c.x, c.y}};
+          BinShape(shape, std::min({a.x, b.x, c.x}), std::min({a.y, b.y, c.y}),
+                   std::max({a.x, b.x, c.x}), std::max({a.y, b.y, c.y}));
+        }
+        break;
+      }
+      case CommandType::kCircles: {
+        const auto &circles = command.As<CirclesCommand>();
+        for (uint32_t i = 0; i < circles.count; i++) {
+          BinCircle(circles.circles()[i], color);
+        }
+        break;
+      }
+      case CommandType::kRects: {
+        const auto &rects = command.As<RectsCommand>();
+        for (uint32_t i = 0; i < rects.count; i++) {
+          BinRect(rects.rects()[i], color);
+        }
+        break;
+      }
+    }
+  }
+
+  BOB_ROSS_TRACE_SCOPE("CpuBackend::RasterizeTiles");
+  pool_->ParallelFor(static_cast<int>(tile_shapes_.size()),
+                     [this](int tile) { RasterizeTile(tile); });
+}
+
+void CpuBackend::BinRect(const RectInstance &rect, uint32_t color) {
+  float x0 = std::min(rect.top_left.x, rect.bottom_right.x);
+  float y0 = std::min(rect.top_left.y, rect.bottom_right.y);
+  float x1 = std::max(rect.top_left.x, rect.bottom_right.x);
+  float y1 = std::max(rect.top_left.y, rect.bottom_right.y);
+  BinShape({BinnedShape::Kind::kRect, color, {x0, y0, x1, y1}}, x0, y0, x1,
+           y1);
+}
+
+void CpuBackend::BinCircle(const CircleInstance &circle, uint32_t color) {
+  float x = circle.origin.x;
+  float y = circle.origin.y;
+  float radius = std::fabs(circle.radius);
+  BinShape({BinnedShape::Kind::kCircle, color, {x, y, radius}}, x - radius,
+           y - radius, x + radius, y + radius);
+}
+
+void CpuBackend::BinShape(const BinnedShape &shape, float min_x, float min_y,
+                          float max_x, float max_y) {
+  // Pixel centers are at +0.5, a bound that touches a tile's edge covers
+  // nothing in it. Comparisons are written to also drop NaN bounds.
+  if (!(max_x > 0 && max_y > 0 && min_x < width_ && min_y < height_)) {
+    return;
+  }
+  int tx0 = static_cast<int>(std::max(min_x, 0.0f)) / kTileSize;
+  int ty0 = static_cast<int>(std::max(min_y, 0.0f)) / kTileSize;
+  int tx1 = std::min(
+      static_cast<int>(std::min(max_x, static_cast<float>(width_))) /
+          kTileSize,
+      tiles_x_ - 1);
+  int ty1 = std::min(
+      static_cast<int>(std::min(max_y, static_cast<float>(height_))) /
+          kTileSize,
+      tiles_y_ - 1);
+  auto index = static_cast<uint32_t>(shapes_.size());
+  shapes_.push_back(shape);
+  for (int ty = ty0; ty <= ty1; ty++) {
+    for (int tx = tx0; tx <= tx1; tx++) {
+      tile_shapes_[ty * tiles_x_ + tx].push_back(index);
+    }
+  }
+}
+
+void CpuBackend::RasterizeTile(int tile) {
+  int tx = tile % tiles_x_;
+  int ty = tile / tiles_x_;
+  for (const PixelRect &rect : clip_rects_) {
+    RasterTarget target = {pixels_.data(),
+                           width_,
+                           std::max(tx * kTileSize, rect.left),
+                           std::max(ty * kTileSize, rect.top),
+                           std::min((tx + 1) * kTileSize, rect.right),
+                           std::min((ty + 1) * kTileSize, rect.bottom)};
+    if (target.x0 < target.x1 && target.y0 < target.y1) {
+      RasterizeTileShapes(tile, target);
+    }
+  }
+}
+
+void CpuBackend::RasterizeTileShapes(int tile, const RasterTarget &target) {
+  for (uint32_t index : tile_shapes_[tile]) {
+    const BinnedShape &shape = shapes_[index];
+    const float *p = shape.params;
+    switch (shape.kind) {
+      case BinnedShape::Kind::kRect:
+        RasterizeRect(target, {{p[0], p[1]}, {p[2], p[3]}}, shape.color);
+        break;
+      case BinnedShape::Kind::kCircle:
+        RasterizeCircle(target, {{p[0], p[1]}, p[2]}, shape.color);
+        break;
+      case BinnedShape::Kind::kTriangle:
+        RasterizeTriangle(target, p, p + 2, p + 4, shape.color);
+        break;
+    }
+  }
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,111 @@
+#include "rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "span_fill.h"
+
+namespace bob_ross {
+namespace {
+
+constexpr float kMaxCoordinate = 1 << 30;
+
+// First pixel whose center is at or after |edge|. Infinite and NaN input is
+// clamped so the conversion to int stays defined.
+inline int FirstCenter(float edge) {
+  float x = std::ceil(edge - 0.5f);
+  return static_cast<int>(
+      std::min(kMaxCoordinate, std::max(-kMaxCoordinate, x)));
+}
+
+inline void DrawRow(const RasterTarget &target, int y, int x0, int x1,
+                    uint32_t color) {
+  x0 = std::max(x0, target.x0);
+  x1 = std::min(x1, target.x1);
+  if (x0 < x1) {
+    DrawSpan(target.pixels + static_cast<size_t>(y) * target.stride + x0,
+             x1 - x0, color);
+  }
+}
+
+// Where a non horizontal edge crosses row center |y|. The endpoints are put
+// in a canonical order first, so triangles sharing the edge compute exactly
+// the same value.
+inline float EdgeX(const float *p, const float *q, float y) {
+  if (p[1] > q[1] || (p[1] == q[1] && p[0] > q[0])) {
+    std::swap(p, q);
+  }
+  return p[0] + (y - p[1]) * (q[0] - p[0]) / (q[1] - p[1]);
+}
+
+}  // namespace
+
+void RasterizeRect(const RasterTarget &target, const RectInstance &rect,
+                   uint32_t color) {
+  int x0 = FirstCenter(std::min(rect.top_left.x, rect.bottom_right.x));
+  int x1 = FirstCenter(std::max(rect.top_left.x, rect.bottom_right.x));
+  int y0 = FirstCenter(std::min(rect.top_left.y, rect.bottom_right.y));
+  int y1 = FirstCenter(std::max(rect.top_left.y, rect.bottom_right.y));
+  y0 = std::max(y0, target.y0);
+  y1 = std::min(y1, target.y1);
+  for (int y = y0; y < y1; y++) {
+    DrawRow(target, y, x0, x1, color);
+  }
+}
+
+void RasterizeCircle(const RasterTarget &target, const CircleInstance &circle,
+                     uint32_t color) {
+  float cx = circle.origin.x;
+  float cy = circle.origin.y;
+  float radius = std::fabs(circle.radius);
+  int y0 = std::max(FirstCenter(cy - radius), target.y0);
+  int y1 = std::min(FirstCenter(cy + radius), target.y1);
+  float radius_squared = radius * radius;
+  for (int y = y0; y < y1; y++) {
+    float dy = y + 0.5f - cy;
+    float half = std::sqrt(std::max(radius_squared - dy * dy, 0.0f));
+    DrawRow(target, y, FirstCenter(cx - half), FirstCenter(cx + half), color);
+  }
+}
+
+void RasterizeTriangle(const RasterTarget &target, const float *a,
+                       const float *b, const float *c, uint32_t color) {
+  float area = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+  if (area == 0) {
+    return;
+  }
+  // With a positive area, edges going down bound the triangle on the right
+  // and edges going up bound it on the left.
+  if (area < 0) {
+    std::swap(b, c);
+  }
+  const float *edges[3][2] = {{a, b}, {b, c}, {c, a}};
+
+  float min_y = std::min({a[1], b[1], c[1]});
+  float max_y = std::max({a[1], b[1], c[1]});
+  int y0 = std::max(FirstCenter(min_y), target.y0);
+  int y1 = std::min(FirstCenter(max_y), target.y1);
+  for (int y = y0; y < y1; y++) {
+    float center = y + 0.5f;
+    float left = -INFINITY, right = INFINITY;
+    for (const auto &edge : edges) {
+      const float *p = edge[0];
+      const float *q = edge[1];
+      if (p[1] == q[1] || center < std::min(p[1], q[1]) ||
+          center > std::max(p[1], q[1])) {
+        continue;
+      }
+      float x = EdgeX(p, q, center);
+      if (q[1] > p[1]) {
+        right = std::min(right, x);
+      } else {
+        left = std::max(left, x);
+      }
+    }
+    if (left < right) {
+      DrawRow(target, y, FirstCenter(left), FirstCenter(right), color);
+    }
+  }
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <bob_ross/types.h>
+
+#include <cstdint>
+
+namespace bob_ross {
+
+// A clipped view into an RGBA8 framebuffer. Only pixels in [x0, x1) x
+// [y0, y1) are touched.
+struct RasterTarget {
+  uint32_t *pixels;
+  int stride;  // In pixels.
+  int x0, y0, x1, y1;
+};
+
+// Pixels are covered when their center is inside the shape. Edges follow a
+// top-left rule, so shapes sharing an edge never both cover a pixel.
+void RasterizeRect(const RasterTarget &target, const RectInstance &rect,
+                   uint32_t color);
+void RasterizeCircle(const RasterTarget &target, const CircleInstance &circle,
+                     uint32_t color);
+void RasterizeTriangle(const RasterTarget &target, const float *a,
+                       const float *b, const float *c, uint32_t color);
+
+}  // namespace bob_ross
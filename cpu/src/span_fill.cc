@@ -0,0 +1,220 @@
+#include "span_fill.h"
+
+#include <algorithm>
+
+#if !defined(BOB_ROSS_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64)
+#define BOB_ROSS_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) && !defined(__AVX2__)
+// AVX2 is compiled per function and picked at runtime.
+#define BOB_ROSS_AVX2_DISPATCH 1
+#include <immintrin.h>
+#endif
+#if defined(__AVX2__)
+#define BOB_ROSS_AVX2 1
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#define BOB_ROSS_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace bob_ross {
+namespace {
+
+// Exact x / 255 for x in [0, 255 * 255], as used by every variant below.
+inline uint32_t Div255(uint32_t x) { return (x + 128 + ((x + 128) >> 8)) >> 8; }
+
+void FillScalar(uint32_t *pixels, int count, uint32_t color) {
+  std::fill(pixels, pixels + count, color);
+}
+
+void BlendScalar(uint32_t *pixels, int count, uint32_t color) {
+  uint32_t alpha = color >> 24;
+  uint32_t inverse = 255 - alpha;
+  uint32_t source[4];
+  for (int c = 0; c < 4; c++) {
+    source[c] = ((color >> (c * 8)) & 0xff) * alpha;
+  }
+  for (int i = 0; i < count; i++) {
+    uint32_t dst = pixels[i];
+    uint32_t out = 0;
+    for (int c = 0; c < 4; c++) {
+      uint32_t channel = (dst >> (c * 8)) & 0xff;
+      out |= Div255(source[c] + channel * inverse) << (c * 8);
+    }
+    pixels[i] = out;
+  }
+}
+
+#if BOB_ROSS_SSE2
+void FillSse2(uint32_t *pixels, int count, uint32_t color) {
+  __m128i value = _mm_set1_epi32(static_cast<int>(color));
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(pixels + i), value);
+  }
+  FillScalar(pixels + i, count - i, color);
+}
+
+inline __m128i Div255Sse2(__m128i x) {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+void BlendSse2(uint32_t *pixels, int count, uint32_t color) {
+  uint32_t alpha = color >> 24;
+  __m128i zero = _mm_setzero_si128();
+  __m128i color16 =
+      _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), zero);
+  __m128i source = _mm_mullo_epi16(color16, _mm_set1_epi16(alpha));
+  __m128i inverse = _mm_set1_epi16(255 - alpha);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto *p = reinterpret_cast<__m128i *>(pixels + i);
+    __m128i dst = _mm_loadu_si128(p);
+    __m128i lo = _mm_unpacklo_epi8(dst, zero);
+    __m128i hi = _mm_unpackhi_epi8(dst, zero);
+    lo = Div255Sse2(_mm_add_epi16(source, _mm_mullo_epi16(lo, inverse)));
+    hi = Div255Sse2(_mm_add_epi16(source, _mm_mullo_epi16(hi, inverse)));
+    _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+  }
+  BlendScalar(pixels + i, count - i, color);
+}
+#endif
+
+#if BOB_ROSS_AVX2 || BOB_ROSS_AVX2_DISPATCH
+#if BOB_ROSS_AVX2_DISPATCH
+#define BOB_ROSS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BOB_ROSS_TARGET_AVX2
+#endif
+
+BOB_ROSS_TARGET_AVX2 void FillAvx2(uint32_t *pixels, int count,
+                                   uint32_t color) {
+  __m256i value = _mm256_set1_epi32(static_cast<int>(color));
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(pixels + i), value);
+  }
+  // The tail and the caller are SSE code, leaving the upper halves dirty
+  // makes every later SSE instruction pay a transition penalty.
+  _mm256_zeroupper();
+  FillScalar(pixels + i, count - i, color);
+}
+
+BOB_ROSS_TARGET_AVX2 inline __m256i Div255Avx2(__m256i x) {
+  x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+BOB_ROSS_TARGET_AVX2 void BlendAvx2(uint32_t *pixels, int count,
+                                    uint32_t color) {
+  uint32_t alpha = color >> 24;
+  __m256i zero = _mm256_setzero_si256();
+  __m256i color16 =
+      _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(color)), zero);
+  __m256i source = _mm256_mullo_epi16(color16, _mm256_set1_epi16(alpha));
+  __m256i inverse = _mm256_set1_epi16(255 - alpha);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    auto *p = reinterpret_cast<__m256i *>(pixels + i);
+    __m256i dst = _mm256_loadu_si256(p);
+    // Unpack and pack both work within 128 bit lanes, so the pixel order
+    // is preserved.
+    __m256i lo = _mm256_unpacklo_epi8(dst, zero);
+    __m256i hi = _mm256_unpackhi_epi8(dst, zero);
+    lo = Div255Avx2(_mm256_add_epi16(source, _mm256_mullo_epi16(lo, inverse)));
+    hi = Div255Avx2(_mm256_add_epi16(source, _mm256_mullo_epi16(hi, inverse)));
+    _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+  }
+  _mm256_zeroupper();
+  BlendScalar(pixels + i, count - i, color);
+}
+#endif
+
+#if BOB_ROSS_NEON
+void FillNeon(uint32_t *pixels, int count, uint32_t color) {
+  uint32x4_t value = vdupq_n_u32(color);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    vst1q_u32(pixels + i, value);
+  }
+  FillScalar(pixels + i, count - i, color);
+}
+
+inline uint8x8_t Div255Neon(uint16x8_t x) {
+  x = vaddq_u16(x, vdupq_n_u16(128));
+  return vshrn_n_u16(vaddq_u16(x, vshrq_n_u16(x, 8)), 8);
+}
+
+void BlendNeon(uint32_t *pixels, int count, uint32_t color) {
+  uint8_t alpha = color >> 24;
+  uint8x8_t color8 = vreinterpret_u8_u32(vdup_n_u32(color));
+  uint16x8_t source = vmull_u8(color8, vdup_n_u8(alpha));
+  uint8x8_t inverse = vdup_n_u8(255 - alpha);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint8x16_t dst = vreinterpretq_u8_u32(vld1q_u32(pixels + i));
+    uint8x8_t lo = Div255Neon(vmlal_u8(source, vget_low_u8(dst), inverse));
+    uint8x8_t hi = Div255Neon(vmlal_u8(source, vget_high_u8(dst), inverse));
+    vst1q_u32(pixels + i, vreinterpretq_u32_u8(vcombine_u8(lo, hi)));
+  }
+  BlendScalar(pixels + i, count - i, color);
+}
+#endif
+
+SpanFunctions SelectSpanFunctions() {
+#if BOB_ROSS_AVX2
+  return {FillAvx2, BlendAvx2, "avx2"};
+#elif BOB_ROSS_AVX2_DISPATCH
+  // Runs during static initialization, before the cpu model is set up.
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {FillAvx2, BlendAvx2, "avx2"};
+  }
+  return {FillSse2, BlendSse2, "sse2"};
+#elif BOB_ROSS_SSE2
+  return {FillSse2, BlendSse2, "sse2"};
+#elif BOB_ROSS_NEON
+  return {FillNeon, BlendNeon, "neon"};
+#else
+  return {FillScalar, BlendScalar, "scalar"};
+#endif
+}
+
+const SpanFunctions kSpanFunctions = SelectSpanFunctions();
+
+}  // namespace
+
+void FillSpan(uint32_t *pixels, int count, uint32_t color) {
+  kSpanFunctions.fill(pixels, count, color);
+}
+
+void BlendSpan(uint32_t *pixels, int count, uint32_t color) {
+  kSpanFunctions.blend(pixels, count, color);
+}
+
+const char *SpanFillIsa() { return kSpanFunctions.isa; }
+
+std::vector<SpanFunctions> SpanFillVariants() {
+  std::vector<SpanFunctions> variants = {{FillScalar, BlendScalar, "scalar"}};
+#if BOB_ROSS_SSE2
+  variants.push_back({FillSse2, BlendSse2, "sse2"});
+#endif
+#if BOB_ROSS_AVX2
+  variants.push_back({FillAvx2, BlendAvx2, "avx2"});
+#elif BOB_ROSS_AVX2_DISPATCH
+  if (__builtin_cpu_supports("avx2")) {
+    variants.push_back({FillAvx2, BlendAvx2, "avx2"});
+  }
+#endif
+#if BOB_ROSS_NEON
+  variants.push_back({FillNeon, BlendNeon, "neon"});
+#endif
+  return variants;
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace bob_ross {
+
+// Fills |count| RGBA8 pixels with |color|.
+void FillSpan(uint32_t *pixels, int count, uint32_t color);
+
+// Blends |color| over |count| RGBA8 pixels the way GL does with
+// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA), alpha included.
+void BlendSpan(uint32_t *pixels, int count, uint32_t color);
+
+// Fills or blends depending on the alpha of |color|.
+inline void DrawSpan(uint32_t *pixels, int count, uint32_t color) {
+  uint32_t alpha = color >> 24;
+  if (alpha == 255) {
+    FillSpan(pixels, count, color);
+  } else if (alpha) {
+    BlendSpan(pixels, count, color);
+  }
+}
+
+// Name of the instruction set the span functions were dispatched to.
+const char *SpanFillIsa();
+
+struct SpanFunctions {
+  void (*fill)(uint32_t *pixels, int count, uint32_t color);
+  void (*blend)(uint32_t *pixels, int count, uint32_t color);
+  const char *isa;
+};
+
+// Every variant built in that this CPU can run, scalar first, so they can
+// be checked against each other.
+std::vector<SpanFunctions> SpanFillVariants();
+
+}  // namespace bob_ross
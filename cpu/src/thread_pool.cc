@@ -0,0 +1,93 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace bob_ross {
+
+ThreadPool::ThreadPool(int thread_count)
+    : queues_(new Queue[std::max(thread_count, 1)]) {
+  for (int worker = 1; worker < thread_count; worker++) {
+    threads_.emplace_back(&ThreadPool::WorkerLoop, this, worker);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int)> &fn) {
+  if (count <= 0) {
+    return;
+  }
+  if (threads_.empty() || count == 1) {
+    for (int i = 0; i < count; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  int threads = thread_count();
+  for (int worker = 0; worker < threads; worker++) {
+    queues_[worker].next.store(count * worker / threads,
+                               std::memory_order_relaxed);
+    queues_[worker].end = count * (worker + 1) / threads;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = &fn;
+    busy_ = static_cast<int>(threads_.size());
+    generation_++;
+  }
+  wake_.notify_all();
+
+  RunQueues(0, fn);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return busy_ == 0; });
+  job_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop(int worker) {
+  uint64_t seen = 0;
+  for (;;) {
+    const std::function<void(int)> *job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [&] { return quit_ || generation_ != seen; });
+      if (quit_) {
+        return;
+      }
+      seen = generation_;
+      job = job_;
+    }
+    RunQueues(worker, *job);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--busy_ == 0) {
+        done_.notify_one();
+      }
+    }
+  }
+}
+
+void ThreadPool::RunQueues(int worker, const std::function<void(int)> &fn) {
+  // Drain our own queue first, then steal from the others in turn.
+  int threads = thread_count();
+  for (int offset = 0; offset < threads; offset++) {
+    Queue &queue = queues_[(worker + offset) % threads];
+    for (int i = queue.next.fetch_add(1, std::memory_order_relaxed);
+         i < queue.end;
+         i = queue.next.fetch_add(1, std::memory_order_relaxed)) {
+      fn(i);
+    }
+  }
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bob_ross {
+
+// Fixed set of worker threads for data parallel loops. Every ParallelFor
+// splits its range into one queue per thread; a thread that runs out of
+// work steals items from the other queues, so uneven items (tiles with many
+// shapes next to empty ones) still keep every thread busy.
+class ThreadPool {
+ public:
+  // |thread_count| includes the calling thread, which takes part in every
+  // ParallelFor.
+  explicit ThreadPool(int thread_count);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int thread_count() const { return static_cast<int>(threads_.size()) + 1; }
+
+  // Calls |fn(i)| for every i in [0, count) and returns once all calls are
+  // done. Calls may run concurrently in any order.
+  void ParallelFor(int count, const std::function<void(int)> &fn);
+
+ private:
+  struct alignas(64) Queue {
+    std::atomic<int> next{0};
+    int end = 0;
+  };
+
+  void WorkerLoop(int worker);
+  void RunQueues(int worker, const std::function<void(int)> &fn);
+
+  std::vector<std::thread> threads_;
+  std::unique_ptr<Queue[]> queues_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(int)> *job_ = nullptr;
+  uint64_t generation_ = 0;
+  int busy_ = 0;
+  bool quit_ = false;
+};
+
+}  // namespace bob_ross
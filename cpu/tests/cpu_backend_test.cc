@@ -0,0 +1,201 @@
+#include <bob_ross/bob_ross.h>
+#include <bob_ross/cpu_backend.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+// Not a multiple of the tile size either way, so the last tiles are
+// partial.
+constexpr int kWidth = 257, kHeight = 193;
+
+class Scene {
+ public:
+  explicit Scene(uint32_t seed) : random_(seed) {}
+
+  // Records random shapes of every kind, many crossing tile edges, with a
+  // flush now and then so frames take several replays.
+  void Draw(BobRoss *bob_ross) {
+    int count = Int(20, 60);
+    for (int i = 0; i < count; i++) {
+      bob_ross->SetFillColor({Int(0, 255), Int(0, 255), Int(0, 255),
+                              Int(0, 3) ? 255 : Int(1, 254)});
+      float z = static_cast<float>(Int(0, 2));
+      switch (Int(0, 6)) {
+        case 0:
+          bob_ross->Rect(RandomPoint(z), RandomPoint(z));
+          break;
+        case 1:
+          bob_ross->Circle(NearTileEdge(z), Float(0.5f, 60));
+          break;
+        case 2: {
+          std::vector<Point> outline;
+          Point center = NearTileEdge(z);
+          int points = Int(3, 12);
+          for (int j = 0; j < points; j++) {
+            // Alternating radii make concave stars.
+            float radius = Float(5, 70) * (j % 2 ? 0.4f : 1.0f);
+            float angle = 6.2831853f * j / points;
+            outline.push_back({center.x + radius * std::cos(angle),
+                               center.y + radius * std::sin(angle), z});
+          }
+          bob_ross->Polygon(outline);
+          break;
+        }
+        case 3:
+          bob_ross->Polygon(
+              {NearTileEdge(z), NearTileEdge(z), NearTileEdge(z),
+               NearTileEdge(z)},
+              {0, 1, 2, 0, 2, 3});
+          break;
+        case 4: {
+          std::vector<RectInstance> rects(Int(1, 20));
+          for (RectInstance &rect : rects) {
+            Point corner = NearTileEdge(z);
+            rect = {corner, {corner.x + Float(-30, 30),
+                             corner.y + Float(-30, 30), z}};
+          }
+          bob_ross->Rects(rects.data(), rects.size());
+          break;
+        }
+        case 5: {
+          std::vector<CircleInstance> circles(Int(1, 20));
+          for (CircleInstance &circle : circles) {
+            circle = {NearTileEdge(z), Float(0.5f, 20)};
+          }
+          bob_ross->Circles(circles.data(), circles.size());
+          break;
+        }
+        default:
+          bob_ross->Flush();
+          break;
+      }
+    }
+  }
+
+  // Up to four disjoint rectangles from a random grid, or none.
+  std::vector<PixelRect> ClipRects() {
+    int x = Int(1, kWidth - 1), y = Int(1, kHeight - 1);
+    std::vector<PixelRect> cells = {{0, 0, x, y},
+                                    {x, 0, kWidth, y},
+                                    {0, y, x, kHeight},
+                                    {x, y, kWidth, kHeight}};
+    std::vector<PixelRect> rects;
+    for (const PixelRect &cell : cells) {
+      if (Int(0, 1)) {
+        int left = Int(cell.left, cell.right - 1);
+        int top = Int(cell.top, cell.bottom - 1);
+        rects.push_back({left, top, Int(left + 1, cell.right),
+                         Int(top + 1, cell.bottom)});
+      }
+    }
+    return rects;
+  }
+
+ private:
+  int Int(int min, int max) {
+    return std::uniform_int_distribution<int>(min, max)(random_);
+  }
+  float Float(float min, float max) {
+    return std::uniform_real_distribution<float>(min, max)(random_);
+  }
+  Point RandomPoint(float z) {
+    return {Float(-20, kWidth + 20), Float(-20, kHeight + 20), z};
+  }
+  // Within a few pixels of a tile boundary, on either side.
+  Point NearTileEdge(float z) {
+    Point point = RandomPoint(z);
+    if (Int(0, 1)) {
+      point.x = Int(0, kWidth / CpuBackend::kTileSize) * CpuBackend::kTileSize +
+                Float(-3, 3);
+    } else {
+      point.y = Int(0, kHeight / CpuBackend::kTileSize) *
+                    CpuBackend::kTileSize +
+                Float(-3, 3);
+    }
+    return point;
+  }
+
+  std::mt19937 random_;
+};
+
+// Draws two frames of a scene, the second clipped, and returns the pixels
+// after each.
+std::vector<std::vector<uint32_t>> Draw(uint32_t seed, int thread_count) {
+  CpuOptions options;
+  options.clear_color = {20, 40, 60, 255};
+  options.thread_count = thread_count;
+  auto backend = std::make_unique<CpuBackend>(options);
+  CpuBackend *cpu = backend.get();
+  EXPECT_EQ(cpu->thread_count(), thread_count);
+  BobRoss bob_ross(kWidth, kHeight, std::move(backend));
+  Scene scene(seed);
+  std::vector<std::vector<uint32_t>> frames;
+  for (int frame = 0; frame < 2; frame++) {
+    bob_ross.BeginFrame();
+    if (frame) {
+      std::vector<PixelRect> clip_rects = scene.ClipRects();
+      cpu->SetClipRects(clip_rects.data(), clip_rects.size());
+    }
+    scene.Draw(&bob_ross);
+    bob_ross.EndFrame();
+    frames.emplace_back(cpu->pixels(), cpu->pixels() + kWidth * kHeight);
+  }
+  return frames;
+}
+
+TEST(CpuBackendTest, TiledMatchesSingleThreaded) {
+  for (uint32_t seed = 1; seed <= 20; seed++) {
+    std::vector<std::vector<uint32_t>> single = Draw(seed, 1);
+    std::vector<std::vector<uint32_t>> tiled = Draw(seed, 8);
+    ASSERT_EQ(single.size(), tiled.size());
+    for (size_t frame = 0; frame < single.size(); frame++) {
+      EXPECT_EQ(single[frame], tiled[frame])
+          << "seed " << seed << " frame " << frame;
+    }
+  }
+}
+
+TEST(CpuBackendTest, ClipRectsLimitDrawingAndClearing) {
+  for (int thread_count : {1, 8}) {
+    CpuOptions options;
+    options.clear_color = {0, 0, 0, 255};
+    options.thread_count = thread_count;
+    auto backend = std::make_unique<CpuBackend>(options);
+    CpuBackend *cpu = backend.get();
+    BobRoss bob_ross(kWidth, kHeight, std::move(backend));
+    bob_ross.BeginFrame();
+    bob_ross.SetFillColor({255, 0, 0, 255});
+    bob_ross.Rect({0, 0}, {kWidth, kHeight});
+    bob_ross.EndFrame();
+
+    // Crosses the tile edges at 64 and 128 both ways.
+    const PixelRect clip = {60, 62, 131, 140};
+    bob_ross.BeginFrame();
+    cpu->SetClipRects(&clip, 1);
+    bob_ross.SetFillColor({0, 0, 255, 255});
+    bob_ross.Circle({100, 100}, 30);
+    bob_ross.EndFrame();
+    for (int y = 0; y < kHeight; y++) {
+      for (int x = 0; x < kWidth; x++) {
+        uint32_t pixel = cpu->pixels()[y * kWidth + x];
+        bool inside = x >= clip.left && x < clip.right && y >= clip.top &&
+                      y < clip.bottom;
+        float dx = x + 0.5f - 100, dy = y + 0.5f - 100;
+        uint32_t expected = !inside                     ? 0xff0000ffu
+                            : dx * dx + dy * dy < 900.0f ? 0xffff0000u
+                                                         : 0xff000000u;
+        ASSERT_EQ(pixel, expected)
+            << thread_count << " threads at " << x << "," << y;
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace bob_ross
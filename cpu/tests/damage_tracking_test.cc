@@ -0,0 +1,91 @@
+#include <bob_ross/bob_ross.h>
+#include <bob_ross/cpu_backend.h>
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+constexpr int kWidth = 96, kHeight = 64;
+
+using Scene = std::function<void(BobRoss *, int frame)>;
+
+// Draws |frame_count| frames of |scene| and returns the pixels after each,
+// with damage tracking on or off. The CPU framebuffer keeps its contents,
+// so tracked frames are repaired with a buffer age of 1.
+std::vector<std::vector<uint32_t>> Draw(const Scene &scene, int frame_count,
+                                        bool track_damage) {
+  CpuOptions options;
+  options.clear_color = {255, 255, 255, 255};
+  auto backend = std::make_unique<CpuBackend>(options);
+  CpuBackend *cpu = backend.get();
+  BobRoss bob_ross(kWidth, kHeight, std::move(backend));
+  bob_ross.EnableDamageTracking(track_damage);
+  std::vector<std::vector<uint32_t>> frames;
+  for (int frame = 0; frame < frame_count; frame++) {
+    bob_ross.BeginFrame();
+    scene(&bob_ross, frame);
+    if (track_damage) {
+      bob_ross.ComputeDamage(1);
+    }
+    bob_ross.EndFrame();
+    frames.emplace_back(cpu->pixels(), cpu->pixels() + kWidth * kHeight);
+  }
+  return frames;
+}
+
+uint32_t Rgba(int r, int g, int b) {
+  return r | g << 8 | b << 16 | 0xffu << 24;
+}
+
+// A higher z rect flushed before a lower z one that overlaps it. The flush
+// keeps them in separate replays, so the second is drawn on top.
+void FlushedLayers(BobRoss *bob_ross, int frame) {
+  bob_ross->SetFillColor({255, 0, 0, 255});
+  bob_ross->Rect({16, 16, 5}, {48, 48, 5});
+  bob_ross->Flush();
+  bob_ross->SetFillColor({0, 0, 255, 255});
+  float x = 24.0f + frame * 8;
+  bob_ross->Rect({x, 24, 0}, {x + 32, 40, 0});
+  // Empty and repeated flushes replay nothing.
+  bob_ross->Flush();
+  bob_ross->Flush();
+  bob_ross->SetFillColor({0, 255, 0, 128});
+  bob_ross->Circle({72, 32, 1}, 12);
+}
+
+TEST(DamageTrackingTest, FlushesSplitReplays) {
+  std::vector<std::vector<uint32_t>> untracked =
+      Draw(FlushedLayers, 1, false);
+  EXPECT_EQ(untracked[0][32 * kWidth + 32], Rgba(0, 0, 255));
+  EXPECT_EQ(Draw(FlushedLayers, 1, true), untracked);
+}
+
+TEST(DamageTrackingTest, RepairedFramesMatchUntracked) {
+  std::vector<std::vector<uint32_t>> untracked =
+      Draw(FlushedLayers, 4, false);
+  std::vector<std::vector<uint32_t>> tracked = Draw(FlushedLayers, 4, true);
+  ASSERT_EQ(tracked.size(), untracked.size());
+  for (size_t i = 0; i < tracked.size(); i++) {
+    EXPECT_EQ(tracked[i], untracked[i]) << "frame " << i;
+  }
+}
+
+TEST(DamageTrackingTest, FillColorCarriesAcrossFlushes) {
+  auto scene = [](BobRoss *bob_ross, int) {
+    bob_ross->SetFillColor({0, 128, 0, 255});
+    bob_ross->Rect({8, 8}, {24, 24});
+    bob_ross->Flush();
+    // No SetFillColor, the color set before the flush still applies.
+    bob_ross->Rect({40, 8}, {56, 24});
+  };
+  std::vector<std::vector<uint32_t>> untracked = Draw(scene, 1, false);
+  EXPECT_EQ(untracked[0][16 * kWidth + 48], Rgba(0, 128, 0));
+  EXPECT_EQ(Draw(scene, 1, true), untracked);
+}
+
+}  // namespace
+}  // namespace bob_ross
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <vector>
+
+#include "rasterizer.h"
+
+namespace bob_ross {
+namespace {
+
+constexpr int kSize = 16;
+constexpr uint32_t kColor = 0xff0000ff;
+
+// Pixels of a kSize square target a drawing covered, as 1s.
+using Mask = std::vector<int>;
+
+Mask Cover(const std::function<void(const RasterTarget &)> &draw,
+           int x0 = 0, int y0 = 0, int x1 = kSize, int y1 = kSize) {
+  std::vector<uint32_t> pixels(kSize * kSize, 0);
+  draw({pixels.data(), kSize, x0, y0, x1, y1});
+  Mask mask(pixels.size());
+  for (size_t i = 0; i < pixels.size(); i++) {
+    mask[i] = pixels[i] != 0;
+  }
+  return mask;
+}
+
+Mask CoverRect(Point top_left, Point bottom_right) {
+  return Cover([&](const RasterTarget &target) {
+    RasterizeRect(target, {top_left, bottom_right}, kColor);
+  });
+}
+
+Mask CoverTriangle(const float *a, const float *b, const float *c) {
+  return Cover([&](const RasterTarget &target) {
+    RasterizeTriangle(target, a, b, c, kColor);
+  });
+}
+
+// Pixels with left <= x < right and top <= y < bottom.
+Mask Block(int left, int top, int right, int bottom) {
+  Mask mask(kSize * kSize, 0);
+  for (int y = top; y < bottom; y++) {
+    for (int x = left; x < right; x++) {
+      mask[y * kSize + x] = 1;
+    }
+  }
+  return mask;
+}
+
+Mask Sum(const Mask &a, const Mask &b) {
+  Mask sum(a.size());
+  for (size_t i = 0; i < a.size(); i++) {
+    sum[i] = a[i] + b[i];
+  }
+  return sum;
+}
+
+int Count(const Mask &mask) {
+  int count = 0;
+  for (int covered : mask) {
+    count += covered;
+  }
+  return count;
+}
+
+TEST(RasterizerTest, RectsCoverPixelCenters) {
+  // Centers on the left and top edges are in, on the right and bottom out.
+  EXPECT_EQ(CoverRect({1.5f, 1.5f}, {4.5f, 3.5f}), Block(1, 1, 4, 3));
+  EXPECT_EQ(CoverRect({1, 1}, {4, 3}), Block(1, 1, 4, 3));
+  // Corners in any order.
+  EXPECT_EQ(CoverRect({4, 3}, {1, 1}), Block(1, 1, 4, 3));
+  // No center inside.
+  EXPECT_EQ(Count(CoverRect({1.6f, 1.6f}, {2.4f, 2.4f})), 0);
+  EXPECT_EQ(CoverRect({1.4f, 1.4f}, {1.6f, 1.6f}), Block(1, 1, 2, 2));
+  EXPECT_EQ(Count(CoverRect({2.5f, 2.5f}, {2.5f, 6.5f})), 0);
+}
+
+TEST(RasterizerTest, RectsSharingAnEdgeCoverEachPixelOnce) {
+  for (float split : {5.0f, 5.5f, 5.25f}) {
+    EXPECT_EQ(Sum(CoverRect({0, 0}, {split, kSize}),
+                  CoverRect({split, 0}, {kSize, kSize})),
+              Block(0, 0, kSize, kSize))
+        << split;
+    EXPECT_EQ(Sum(CoverRect({0, 0}, {kSize, split}),
+                  CoverRect({0, split}, {kSize, kSize})),
+              Block(0, 0, kSize, kSize))
+        << split;
+  }
+}
+
+TEST(RasterizerTest, TrianglesFollowTopLeftRule) {
+  // Edges through pixel centers. The top edge and the diagonal, a left
+  // edge, are in. The right and bottom edges are out.
+  const float a[] = {0.5f, 0.5f}, b[] = {8.5f, 0.5f}, c[] = {8.5f, 8.5f},
+              d[] = {0.5f, 8.5f};
+  Mask upper = CoverTriangle(a, b, c);
+  Mask lower = CoverTriangle(a, c, d);
+  EXPECT_EQ(Count(upper), 36);
+  EXPECT_EQ(Count(lower), 28);
+  EXPECT_EQ(upper[0], 1);
+  EXPECT_EQ(upper[7 * kSize + 7], 1);
+  EXPECT_EQ(lower[7 * kSize + 0], 1);
+  EXPECT_EQ(Sum(upper, lower), Block(0, 0, 8, 8));
+}
+
+TEST(RasterizerTest, WindingDoesNotChangeCoverage) {
+  const float a[] = {1.3f, 2.1f}, b[] = {13.7f, 4.4f}, c[] = {5.2f, 14.9f};
+  Mask clockwise = CoverTriangle(a, b, c);
+  EXPECT_GT(Count(clockwise), 0);
+  EXPECT_EQ(CoverTriangle(a, c, b), clockwise);
+  EXPECT_EQ(CoverTriangle(b, c, a), clockwise);
+}
+
+TEST(RasterizerTest, TriangleFanCoversEachPixelOnce) {
+  // Around a center off the pixel grid, with a shared edge through
+  // centers.
+  const float center[] = {7.3f, 8.1f};
+  const float ring[][2] = {{1, 1},       {7.5f, 0.5f}, {15, 2},
+                           {14.5f, 8.5f}, {13, 15},    {7.5f, 15.5f},
+                           {0.5f, 12},    {0.5f, 8.5f}};
+  constexpr int kRing = sizeof(ring) / sizeof(ring[0]);
+  Mask total(kSize * kSize, 0);
+  for (int i = 0; i < kRing; i++) {
+    total = Sum(total, CoverTriangle(center, ring[i], ring[(i + 1) % kRing]));
+  }
+  for (size_t i = 0; i < total.size(); i++) {
+    ASSERT_LE(total[i], 1) << "pixel " << i % kSize << "," << i / kSize;
+  }
+  // No hole at the shared center.
+  EXPECT_EQ(total[8 * kSize + 7], 1);
+}
+
+TEST(RasterizerTest, DegenerateTrianglesCoverNothing) {
+  const float a[] = {1, 1}, b[] = {8, 8}, c[] = {15, 15};
+  EXPECT_EQ(Count(CoverTriangle(a, b, c)), 0);
+  EXPECT_EQ(Count(CoverTriangle(a, a, c)), 0);
+}
+
+TEST(RasterizerTest, CirclesCoverCentersInside) {
+  const float cx = 8, cy = 7.75f, radius = 5.3f;
+  Mask mask = Cover([&](const RasterTarget &target) {
+    RasterizeCircle(target, {{cx, cy}, radius}, kColor);
+  });
+  for (int y = 0; y < kSize; y++) {
+    for (int x = 0; x < kSize; x++) {
+      float dx = x + 0.5f - cx, dy = y + 0.5f - cy;
+      EXPECT_EQ(mask[y * kSize + x], dx * dx + dy * dy < radius * radius)
+          << x << "," << y;
+    }
+  }
+}
+
+TEST(RasterizerTest, StaysInsideTarget) {
+  const float a[] = {-5, -5}, b[] = {30, 0}, c[] = {0, 30};
+  auto draw = [&](const RasterTarget &target) {
+    RasterizeRect(target, {{-10, -10}, {40, 40}}, kColor);
+    RasterizeCircle(target, {{8, 8}, 30}, kColor);
+    RasterizeTriangle(target, a, b, c, kColor);
+  };
+  EXPECT_EQ(Cover(draw, 3, 4, 11, 9), Block(3, 4, 11, 9));
+}
+
+TEST(RasterizerTest, TranslucentShapesBlend) {
+  std::vector<uint32_t> pixels(kSize * kSize, 0xffff0000);
+  RasterTarget target = {pixels.data(), kSize, 0, 0, kSize, kSize};
+  // Half transparent red over opaque blue.
+  RasterizeRect(target, {{0, 0}, {4, 4}}, 0x800000ff);
+  // Red is 255 * 128 / 255 and blue 255 * 127 / 255. Alpha blends like the
+  // other channels, 128 * 128 / 255 + 255 * 127 / 255 rounds to 191.
+  EXPECT_EQ(pixels[0], 0xbf7f0080u);
+  EXPECT_EQ(pixels[5 * kSize], 0xffff0000u);
+}
+
+}  // namespace
+}  // namespace bob_ross
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "span_fill.h"
+
+namespace bob_ross {
+namespace {
+
+constexpr uint32_t kGuard = 0xdeadbeef;
+// Room for the longest span at every misalignment, plus a guard each side.
+constexpr int kMaxCount = 67;
+constexpr int kBufferSize = kMaxCount + 8;
+
+uint32_t Channel(uint32_t pixel, int c) { return (pixel >> (c * 8)) & 0xff; }
+
+std::vector<uint32_t> RandomPixels(std::mt19937 *random) {
+  std::vector<uint32_t> pixels(kBufferSize);
+  for (uint32_t &pixel : pixels) {
+    pixel = (*random)();
+  }
+  pixels.front() = pixels.back() = kGuard;
+  return pixels;
+}
+
+// Colors with every alpha the variants treat specially, and random ones.
+std::vector<uint32_t> TestColors(std::mt19937 *random) {
+  std::vector<uint32_t> colors;
+  for (uint32_t alpha : {0u, 1u, 127u, 128u, 254u, 255u}) {
+    colors.push_back(((*random)() & 0xffffff) | alpha << 24);
+  }
+  for (int i = 0; i < 16; i++) {
+    colors.push_back((*random)());
+  }
+  return colors;
+}
+
+TEST(SpanFillTest, VariantsMatchScalar) {
+  std::vector<SpanFunctions> variants = SpanFillVariants();
+  ASSERT_FALSE(variants.empty());
+  ASSERT_STREQ(variants[0].isa, "scalar");
+  std::mt19937 random(7);
+  std::vector<uint32_t> colors = TestColors(&random);
+  for (const SpanFunctions &variant : variants) {
+    for (uint32_t color : colors) {
+      for (int offset = 1; offset <= 4; offset++) {
+        for (int count = 0; count <= kMaxCount; count++) {
+          SCOPED_TRACE(std::string(variant.isa) + " color " +
+                       std::to_string(color) + " offset " +
+                       std::to_string(offset) + " count " +
+                       std::to_string(count));
+          std::vector<uint32_t> expected = RandomPixels(&random);
+          std::vector<uint32_t> pixels = expected;
+          variants[0].blend(expected.data() + offset, count, color);
+          variant.blend(pixels.data() + offset, count, color);
+          ASSERT_EQ(pixels, expected);
+
+          variants[0].fill(expected.data() + offset, count, color);
+          variant.fill(pixels.data() + offset, count, color);
+          ASSERT_EQ(pixels, expected);
+          ASSERT_EQ(pixels.front(), kGuard);
+          ASSERT_EQ(pixels.back(), kGuard);
+        }
+      }
+    }
+  }
+}
+
+TEST(SpanFillTest, DispatchesToAVariant) {
+  std::vector<std::string> names;
+  for (const SpanFunctions &variant : SpanFillVariants()) {
+    names.push_back(variant.isa);
+  }
+  // The dispatched one is the last, and best, the CPU supports.
+  EXPECT_EQ(names.back(), SpanFillIsa());
+}
+
+// GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA on normalized values, alpha
+// included, rounded to the nearest 8 bit value.
+TEST(SpanFillTest, BlendsLikeGl) {
+  std::vector<uint32_t> pixels(256);
+  for (uint32_t alpha = 0; alpha <= 255; alpha++) {
+    for (uint32_t source = 0; source <= 255; source += 15) {
+      uint32_t color = source | (255 - source) << 8 | 51 << 16 | alpha << 24;
+      for (uint32_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = i | (255 - i) << 8 | (i * 7 & 0xff) << 16 | i << 24;
+      }
+      std::vector<uint32_t> destination = pixels;
+      BlendSpan(pixels.data(), static_cast<int>(pixels.size()), color);
+      for (size_t i = 0; i < pixels.size(); i++) {
+        for (int c = 0; c < 4; c++) {
+          double a = alpha / 255.0;
+          double exact = Channel(color, c) * a +
+                         Channel(destination[i], c) * (1 - a);
+          ASSERT_LE(std::fabs(Channel(pixels[i], c) - exact), 0.5 + 1e-9)
+              << "alpha " << alpha << " channel " << c << " over "
+              << Channel(destination[i], c);
+        }
+      }
+    }
+  }
+}
+
+TEST(SpanFillTest, DrawSpanSkipsTransparentAndFillsOpaque) {
+  std::vector<uint32_t> pixels(9, 0x11223344);
+  DrawSpan(pixels.data(), 9, 0x00ffffff);
+  EXPECT_EQ(pixels, std::vector<uint32_t>(9, 0x11223344));
+  DrawSpan(pixels.data(), 9, 0xff0000ff);
+  EXPECT_EQ(pixels, std::vector<uint32_t>(9, 0xff0000ff));
+}
+
+}  // namespace
+}  // namespace bob_ross
@@ -0,0 +1,111 @@
+#include "model.hpp"
+
+#include <bob_ross/trace.h>
+
+namespace {
+/*!
+ * Maps the texture coordinates of @a count vertices into @a region of an
+ * atlas page. Returns the vertices as they are for textures of their own.
+ */
+const Vertex *mapToRegion(const bob_ross::AtlasRegion &region,
+                          const Vertex *vertices, size_t count,
+                          std::vector<Vertex> *mapped) {
+  if (region.u0 == 0 && region.v0 == 0 && region.u1 == 1 && region.v1 == 1) {
+    return vertices;
+  }
+  mapped->assign(vertices, vertices + count);
+  for (Vertex &vertex : *mapped) {
+    vertex.uv.u = region.u0 + vertex.uv.u * (region.u1 - region.u0);
+    vertex.uv.v = region.v0 + vertex.uv.v * (region.v1 - region.v0);
+  }
+  return mapped->data();
+}
+}  // namespace
+
+Model::Model(const std::vector<Vertex> &vertices,
+             const std::vector<Index> &indices,
+             std::shared_ptr<TextureAsset> spTexture, MeshUsage usage)
+    : usage_(usage == MeshUsage::Static ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW),
+      spTexture_(std::move(spTexture)) {
+  glGenBuffers(1, &vertexBuffer_);
+  glGenBuffers(1, &indexBuffer_);
+  vertexArray_ = ModelVertexLayout::CreateVertexArray(vertexBuffer_);
+
+  // The element array binding is part of the vertex array, so it only has to
+  // be made once.
+  glBindVertexArray(vertexArray_);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+  glBindVertexArray(0);
+
+  setMesh(vertices, indices);
+}
+
+Model::~Model() { release(); }
+
+Model::Model(Model &&other) noexcept
+    : usage_(other.usage_),
+      vertexBuffer_(std::exchange(other.vertexBuffer_, 0)),
+      indexBuffer_(std::exchange(other.indexBuffer_, 0)),
+      vertexArray_(std::exchange(other.vertexArray_, 0)),
+      vertexCount_(std::exchange(other.vertexCount_, 0)),
+      indexCount_(std::exchange(other.indexCount_, 0)),
+      spTexture_(std::move(other.spTexture_)) {}
+
+Model &Model::operator=(Model &&other) noexcept {
+  if (this != &other) {
+    release();
+    usage_ = other.usage_;
+    vertexBuffer_ = std::exchange(other.vertexBuffer_, 0);
+    indexBuffer_ = std::exchange(other.indexBuffer_, 0);
+    vertexArray_ = std::exchange(other.vertexArray_, 0);
+    vertexCount_ = std::exchange(other.vertexCount_, 0);
+    indexCount_ = std::exchange(other.indexCount_, 0);
+    spTexture_ = std::move(other.spTexture_);
+  }
+  return *this;
+}
+
+void Model::updateVertices(size_t first, const Vertex *vertices,
+                           size_t count) {
+  BOB_ROSS_TRACE_SCOPE("Model::updateVertices");
+  std::vector<Vertex> mapped;
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+  glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(Vertex),
+                  count * sizeof(Vertex),
+                  mapToRegion(spTexture_->getRegion(), vertices, count,
+                              &mapped));
+}
+
+void Model::updateIndices(size_t first, const Index *indices, size_t count) {
+  BOB_ROSS_TRACE_SCOPE("Model::updateIndices");
+  // Binding the element array buffer outside the vertex array keeps other
+  // vertex arrays from picking it up.
+  glBindVertexArray(0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+  glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, first * sizeof(Index),
+                  count * sizeof(Index), indices);
+}
+
+void Model::setMesh(const std::vector<Vertex> &vertices,
+                    const std::vector<Index> &indices) {
+  BOB_ROSS_TRACE_SCOPE("Model::setMesh");
+  std::vector<Vertex> mapped;
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer_);
+  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex),
+               mapToRegion(spTexture_->getRegion(), vertices.data(),
+                           vertices.size(), &mapped),
+               usage_);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer_);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(Index),
+               indices.data(), usage_);
+  vertexCount_ = vertices.size();
+  indexCount_ = indices.size();
+}
+
+void Model::release() {
+  glDeleteVertexArrays(1, &vertexArray_);
+  glDeleteBuffers(1, &indexBuffer_);
+  glDeleteBuffers(1, &vertexBuffer_);
+  vertexArray_ = indexBuffer_ = vertexBuffer_ = 0;
+}
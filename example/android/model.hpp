@@ -1,5 +1,9 @@
 #pragma once
 
+#include <bob_ross/shader_variants.h>
+#include <bob_ross/vertex_layout.h>
+
+#include <cstddef>
 #include <vector>
 #include <utility>
 #include <memory>
@@ -31,26 +35,85 @@ struct Vertex {
   Vector2 uv;
 };
 
+/*!
+ * Attributes of a Vertex, at the locations of the painter's textured
+ * program variants.
+ */
+using ModelVertexLayout = bob_ross::VertexLayout<
+    Vertex,
+    bob_ross::Attribute<bob_ross::kPositionLocation, float, 3,
+                        offsetof(Vertex, position)>,
+    bob_ross::Attribute<bob_ross::kUVLocation, float, 2, offsetof(Vertex, uv)>>;
+
 typedef uint16_t Index;
 
+/*!
+ * How often a model's mesh changes, a hint for where the driver keeps it.
+ */
+enum class MeshUsage {
+  // Uploaded once and drawn many times.
+  Static,
+  // Updated every few frames with Model::updateVertices and friends.
+  Dynamic,
+};
+
+/*!
+ * A textured mesh kept in GL buffers. The mesh is uploaded when the model is
+ * created, so drawing it copies nothing. Texture coordinates are given for
+ * the whole image and mapped into its atlas region, if it has one, on
+ * upload. Must be created, updated and destroyed with a current GL context.
+ */
 class Model {
  public:
-  inline Model(std::vector<Vertex> vertices, std::vector<Index> indices,
-               std::shared_ptr<TextureAsset> spTexture)
-      : vertices_(std::move(vertices)),
-        indices_(std::move(indices)),
-        spTexture_(std::move(spTexture)) {}
+  Model(const std::vector<Vertex> &vertices, const std::vector<Index> &indices,
+        std::shared_ptr<TextureAsset> spTexture,
+        MeshUsage usage = MeshUsage::Static);
+  ~Model();
+
+  Model(Model &&other) noexcept;
+  Model &operator=(Model &&other) noexcept;
+  Model(const Model &) = delete;
+  Model &operator=(const Model &) = delete;
 
-  inline const Vertex *getVertexData() const { return vertices_.data(); }
+  /*!
+   * Overwrites @a count vertices starting at vertex @a first, which must be
+   * within the mesh.
+   */
+  void updateVertices(size_t first, const Vertex *vertices, size_t count);
 
-  inline const size_t getIndexCount() const { return indices_.size(); }
+  /*!
+   * Overwrites @a count indices starting at index @a first, which must be
+   * within the mesh.
+   */
+  void updateIndices(size_t first, const Index *indices, size_t count);
 
-  inline const Index *getIndexData() const { return indices_.data(); }
+  /*!
+   * Replaces the whole mesh, which may change its size.
+   */
+  void setMesh(const std::vector<Vertex> &vertices,
+               const std::vector<Index> &indices);
+
+  /*!
+   * @return a vertex array with the mesh bound as ModelVertexLayout and its
+   * index buffer. Attribute locations are the same for every shader, so
+   * one vertex array serves them all.
+   */
+  inline GLuint getVertexArray() const { return vertexArray_; }
+
+  inline size_t getVertexCount() const { return vertexCount_; }
+
+  inline size_t getIndexCount() const { return indexCount_; }
 
   inline const TextureAsset &getTexture() const { return *spTexture_; }
 
  private:
-  std::vector<Vertex> vertices_;
-  std::vector<Index> indices_;
+  void release();
+
+  GLenum usage_;
+  GLuint vertexBuffer_ = 0;
+  GLuint indexBuffer_ = 0;
+  GLuint vertexArray_ = 0;
+  size_t vertexCount_ = 0;
+  size_t indexCount_ = 0;
   std::shared_ptr<TextureAsset> spTexture_;
 };
@@ -4,52 +4,42 @@
 //  extern
 
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
 #include <GLES3/gl3.h>
 #include <android/asset_manager.h>
 #include <android/imagedecoder.h>
 #include <android_native_app_glue.h>
+#include <bob_ross/bob_ross.h>
+#include <bob_ross/frame_uniforms.h>
+#include <bob_ross/gles3_backend.h>
+#include <bob_ross/gpu_timer.h>
+#include <bob_ross/program_cache.h>
+#include <bob_ross/shader_variants.h>
+#include <bob_ross/texture_atlas.h>
+#include <bob_ross/texture_cache.h>
+#include <bob_ross/texture_loader.h>
+#include <bob_ross/trace.h>
 #include <jni.h>
+#include <unistd.h>
 
 #include <android_out.hpp>
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <ctime>
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "model.hpp"
 #include "shader.hpp"
 
 #define CORNFLOWER_BLUE 100 / 255.f, 149 / 255.f, 237 / 255.f, 1
-// Vertex shader, you'd typically load this from assets
-static const char *vertex = R"vertex(#version 300 es
-in vec3 inPosition;
-in vec2 inUV;
-
-out vec2 fragUV;
-
-uniform mat4 uProjection;
-
-void main() {
-    fragUV = inUV;
-    gl_Position = uProjection * vec4(inPosition, 1.0);
-}
-)vertex";
-
-// Fragment shader, you'd typically load this from assets
-static const char *fragment = R"fragment(#version 300 es
-precision mediump float;
-
-in vec2 fragUV;
-
-uniform sampler2D uTexture;
-
-out vec4 outColor;
-
-void main() {
-    outColor = texture(uTexture, fragUV);
-}
-)fragment";
-
+// Frames slower than this dump the trace ring buffer, at most once per
+// kTraceDumpIntervalNs.
+constexpr int64_t kSpikeFrameNs = 50'000'000;
+constexpr int64_t kTraceDumpIntervalNs = 10'000'000'000;
 namespace {
 float *buildOrthographicMatrix(float *outMatrix, float halfHeight, float aspect,
                                float near, float far) {
@@ -119,18 +109,51 @@ class Renderer {
  public:
   void Init(android_app *app);
   void Render();
+  // Releases what can be loaded again when the system runs low on memory.
+  void OnLowMemory();
   EGLDisplay display_;
   EGLSurface surface_;
   EGLContext context_;
 
  private:
   void LoadModels(android_app *app);
+  void LoadSwapExtensions();
   void update_render_area();
-
-  int width_, height_;
+  void RenderFrame();
+  void DrawStatusBar();
+  void DrawModels();
+  void Present(const std::vector<bob_ross::PixelRect> &damage);
+  void DumpTraceOnSpike(int64_t frame_start_ns);
+
+  int width_ = 0, height_ = 0;
+  std::unique_ptr<bob_ross::ProgramBinaryCache> program_cache_;
+  // Programs and per-frame constants shared by the models and the painter.
+  std::unique_ptr<bob_ross::ShaderVariants> shader_variants_;
+  std::unique_ptr<bob_ross::FrameUniforms> frame_uniforms_;
   std::unique_ptr<Shader> shader_;
-  bool shaderNeedsNewProjectionMatrix_;
+  // Set once the shader is built. Frames before that are drawn without the
+  // models.
+  bool modelsVisible_ = false;
+  // Decodes and uploads the models' large images off the render thread.
+  // Outlives them.
+  std::unique_ptr<bob_ross::TextureLoader> texture_loader_;
+  // Shares one texture between the models' small images. Outlives them.
+  std::unique_ptr<bob_ross::TextureAtlas> atlas_;
+  // Every model texture, shared between models loading the same image.
+  // Holds on to the loader's and the atlas' textures, so it is destroyed
+  // before them.
+  std::unique_ptr<bob_ross::TextureCache> texture_cache_;
+  // Sorted by texture, so models sharing an atlas page draw back to back.
   std::vector<Model> models_;
+  std::unique_ptr<bob_ross::BobRoss> painter_;
+  bool has_buffer_age_ = false;
+  PFNEGLSETDAMAGEREGIONKHRPROC set_damage_region_ = nullptr;
+  PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC swap_buffers_with_damage_ = nullptr;
+  // Damage in EGL's x, y, width, height from the bottom left.
+  std::vector<EGLint> egl_damage_;
+  std::unique_ptr<bob_ross::GpuTimer> gpu_timer_;
+  std::string trace_path_;
+  int64_t last_trace_dump_ns_ = 0;
   // void DrawExample();
 };
 
@@ -145,16 +168,8 @@ void Renderer::update_render_area() {
     width_ = width;
     height_ = height;
     glViewport(0, 0, width, height);
+    painter_->UpdateScreenDimension(width, height);
 
-    // make sure that we lazily recreate the projection matrix before we render
-    shaderNeedsNewProjectionMatrix_ = true;
-  }
-}
-
-void Renderer::Render() {
-  update_render_area();
-
-  if (shaderNeedsNewProjectionMatrix_) {
     // a placeholder projection matrix allocated on the stack. Column-major
     // memory layout
     float projectionMatrix[16] = {0};
@@ -163,22 +178,169 @@ void Renderer::Render() {
     buildOrthographicMatrix(projectionMatrix, 2.f,
                             static_cast<float>(width_) / height_, -1.f, 1.f);
 
-    // send the matrix to the shader
-    // Note: the shader must be active for this to work. Since we only have one
-    // shader for this demo, we can assume that it's active.
-    shader_->setProjectionMatrix(projectionMatrix);
+    // Uploaded with the frame's other constants the next time they are bound.
+    frame_uniforms_->SetProjection(projectionMatrix);
+  }
+}
+
+void Renderer::Render() {
+  int64_t frame_start_ns = bob_ross::Tracer::NowNs();
+  {
+    BOB_ROSS_TRACE_SCOPE("Renderer::Render");
+    gpu_timer_->Collect();
+    RenderFrame();
+  }
+  DumpTraceOnSpike(frame_start_ns);
+}
+
+// Textures the models use stay, the rest are loaded again when needed.
+void Renderer::OnLowMemory() {
+  texture_cache_->Purge();
+  bob_ross::TextureResidency residency = texture_cache_->residency();
+  aout << "Low memory, " << residency.resident_bytes << " bytes in "
+       << residency.texture_count << " textures left" << std::endl;
+}
+
+// Only the parts of the screen that changed since the back buffer was last
+// drawn are cleared and redrawn, and the compositor is told which ones. The
+// models are static, so redrawing them inside the damage is enough.
+void Renderer::RenderFrame() {
+  update_render_area();
+  if (!modelsVisible_ && shader_->poll()) {
+    modelsVisible_ = true;
+    // The models are missing from the frames drawn so far, outside of
+    // anything BobRoss would damage.
+    painter_->InvalidateDamage();
+  }
+  if (texture_loader_->Pump()) {
+    // A model's image replaced its placeholder.
+    painter_->InvalidateDamage();
+  }
+  // Images that finished loading count against the budget from now on.
+  texture_cache_->Trim();
+  if (modelsVisible_) {
+    shader_->activate();
+    frame_uniforms_->Bind();
+  }
+
+  painter_->BeginFrame();
+  DrawStatusBar();
+  EGLint buffer_age = 0;
+  if (has_buffer_age_) {
+    eglQuerySurface(display_, surface_, EGL_BUFFER_AGE_KHR, &buffer_age);
+  }
+  const std::vector<bob_ross::PixelRect> &damage =
+      painter_->ComputeDamage(buffer_age);
+  if (damage.empty()) {
+    // Nothing changed, the last frame stays on screen.
+    painter_->EndFrame();
+    return;
+  }
+  egl_damage_.clear();
+  for (const bob_ross::PixelRect &rect : damage) {
+    egl_damage_.insert(egl_damage_.end(),
+                       {rect.left, height_ - rect.bottom,
+                        rect.right - rect.left, rect.bottom - rect.top});
+  }
+  // Has to come before anything is drawn to the surface.
+  if (set_damage_region_) {
+    set_damage_region_(display_, surface_, egl_damage_.data(), damage.size());
+  }
+
+  {
+    bob_ross::GpuTraceScope gpu_scope(gpu_timer_.get(), "Renderer::drawModels");
+    glEnable(GL_SCISSOR_TEST);
+    for (size_t i = 0; i < damage.size(); i++) {
+      const EGLint *rect = &egl_damage_[i * 4];
+      glScissor(rect[0], rect[1], rect[2], rect[3]);
+      glClear(GL_COLOR_BUFFER_BIT);
+      if (modelsVisible_) {
+        DrawModels();
+      }
+    }
+    glDisable(GL_SCISSOR_TEST);
+  }
+  painter_->EndFrame();
+  Present(damage);
+}
+
+// A row of 60 ticks with the current second highlighted, so only two ticks
+// change every second.
+void Renderer::DrawStatusBar() {
+  int second = static_cast<int>(time(nullptr) % 60);
+  float tick = width_ / 60.f;
+  float top = height_ - tick * 2;
+  painter_->SetFillColor({0, 0, 0, 96});
+  painter_->Rect({0, top}, {static_cast<float>(width_),
+                            static_cast<float>(height_)});
+  for (int i = 0; i < 60; i++) {
+    painter_->SetFillColor(i == second ? bob_ross::Color{255, 200, 0, 255}
+                                       : bob_ross::Color{255, 255, 255, 128});
+    painter_->Rect({i * tick + 2, top + tick / 2},
+                   {(i + 1) * tick - 2, top + tick * 1.5f});
+  }
+}
 
-    // make sure the matrix isn't generated every frame
-    shaderNeedsNewProjectionMatrix_ = false;
+void Renderer::DrawModels() {
+  for (const auto &model : models_) {
+    shader_->drawModel(model);
   }
-  glClear(GL_COLOR_BUFFER_BIT);
+}
 
-  if (!models_.empty()) {
-    for (const auto &model : models_) {
-      shader_->drawModel(model);
+void Renderer::Present(const std::vector<bob_ross::PixelRect> &damage) {
+  BOB_ROSS_TRACE_SCOPE("eglSwapBuffers");
+  if (swap_buffers_with_damage_) {
+    swap_buffers_with_damage_(display_, surface_, egl_damage_.data(),
+                              damage.size());
+  } else {
+    eglSwapBuffers(display_, surface_);
+  }
+}
+
+void Renderer::LoadSwapExtensions() {
+  const char *extensions = eglQueryString(display_, EGL_EXTENSIONS);
+  auto has = [extensions](const char *name) {
+    size_t length = strlen(name);
+    for (const char *found = extensions;
+         found && (found = strstr(found, name)); found += length) {
+      if (found[length] == ' ' || found[length] == '\0') {
+        return true;
+      }
     }
+    return false;
+  };
+  has_buffer_age_ =
+      has("EGL_EXT_buffer_age") || has("EGL_KHR_partial_update");
+  if (has("EGL_KHR_partial_update")) {
+    set_damage_region_ = reinterpret_cast<PFNEGLSETDAMAGEREGIONKHRPROC>(
+        eglGetProcAddress("eglSetDamageRegionKHR"));
+  }
+  if (has("EGL_KHR_swap_buffers_with_damage")) {
+    swap_buffers_with_damage_ =
+        reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+            eglGetProcAddress("eglSwapBuffersWithDamageKHR"));
+  } else if (has("EGL_EXT_swap_buffers_with_damage")) {
+    swap_buffers_with_damage_ =
+        reinterpret_cast<PFNEGLSWAPBUFFERSWITHDAMAGEKHRPROC>(
+            eglGetProcAddress("eglSwapBuffersWithDamageEXT"));
+  }
+  aout << "Buffer age " << has_buffer_age_ << ", partial update "
+       << (set_damage_region_ != nullptr) << ", swap with damage "
+       << (swap_buffers_with_damage_ != nullptr) << std::endl;
+}
+
+void Renderer::DumpTraceOnSpike(int64_t frame_start_ns) {
+  int64_t now_ns = bob_ross::Tracer::NowNs();
+  if (now_ns - frame_start_ns < kSpikeFrameNs ||
+      (last_trace_dump_ns_ &&
+       now_ns - last_trace_dump_ns_ < kTraceDumpIntervalNs)) {
+    return;
+  }
+  last_trace_dump_ns_ = now_ns;
+  if (bob_ross::Tracer::Get().WriteChromeJson(trace_path_.c_str())) {
+    aout << "Frame took " << (now_ns - frame_start_ns) / 1000000
+         << "ms, trace written to " << trace_path_ << std::endl;
   }
-  eglSwapBuffers(display_, surface_);
 }
 
 void Renderer::LoadModels(android_app *app) {
@@ -200,15 +362,30 @@ void Renderer::LoadModels(android_app *app) {
 
   // loads an image and assigns it to the square.
   //
-  // Note: there is no texture management in this sample, so if you reuse an
-  // image be careful not to load it repeatedly. Since you get a shared_ptr you
-  // can safely reuse it in many models.
+  // Textures come from the cache, so loading an image again for another
+  // model reuses its texture.
+  //
+  // The build converts images to ETC2 KTX2 files when it has the texture
+  // tool, those upload as they are. Otherwise images too large for the
+  // atlas load in the background, the model shows a placeholder until its
+  // image is ready.
   auto assetManager = app->activity->assetManager;
-  auto spAndroidRobotTexture =
-      TextureAsset::loadAsset(assetManager, "brick_01.png");
+  auto spAndroidRobotTexture = TextureAsset::loadCached(
+      texture_cache_.get(), assetManager, "brick_01.png",
+      TextureAsset::kLoadCompressed | TextureAsset::kLoadAsync, atlas_.get(),
+      texture_loader_.get());
 
   // Create a model and put it in the back of the render list.
   models_.emplace_back(vertices, indices, spAndroidRobotTexture);
+
+  // Mipmaps the atlas pages once, for everything loaded above. Images still
+  // loading all show the placeholder, so sorting only groups atlas pages.
+  atlas_->Flush();
+  std::stable_sort(models_.begin(), models_.end(),
+                   [](const Model &a, const Model &b) {
+                     return a.getTexture().getTextureID() <
+                            b.getTexture().getTextureID();
+                   });
 }
 
 void Renderer::Init(android_app *app) {
@@ -282,16 +459,48 @@ void Renderer::Init(android_app *app) {
   // make width and height invalid so it gets updated the first frame in @a
   // updateRenderArea()
 
-  // setup any other gl related global states
-  shader_ = std::unique_ptr<Shader>(Shader::loadShader(
-      vertex, fragment, "inPosition", "inUV", "uProjection"));
-  shader_->activate();
+  // Linked programs are kept in app storage, so only the first launch after
+  // an install or a driver update compiles GLSL.
+  program_cache_ = std::make_unique<bob_ross::ProgramBinaryCache>(
+      app->activity->internalDataPath);
+
+  // setup any other gl related global states. The shader and the painter's
+  // programs are variants of the same sources and compile side by side. The
+  // painter waits for its own at the first frame, the models show up
+  // whenever the shader is ready.
+  shader_variants_ =
+      std::make_unique<bob_ross::ShaderVariants>(program_cache_.get());
+  frame_uniforms_ = std::make_unique<bob_ross::FrameUniforms>();
+  shader_ = Shader::loadShader(shader_variants_.get());
   glClearColor(CORNFLOWER_BLUE);
 
   // enable alpha globally for now, you probably don't want to do this in a game
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  texture_loader_ = std::make_unique<bob_ross::TextureLoader>();
+  atlas_ = std::make_unique<bob_ross::TextureAtlas>();
+  // Textures no model uses get at most a 16th of RAM, low-RAM devices are
+  // the ones killed for holding on to them.
+  size_t ram = static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) *
+               static_cast<size_t>(sysconf(_SC_PAGE_SIZE));
+  texture_cache_ = std::make_unique<bob_ross::TextureCache>(std::min(
+      ram / 16, bob_ross::TextureCache::kDefaultBudgetBytes));
   LoadModels(app);
+
+  LoadSwapExtensions();
+  bob_ross::Gles3Options options;
+  options.shader_variants = shader_variants_.get();
+  options.frame_uniforms = frame_uniforms_.get();
+  painter_ = std::make_unique<bob_ross::BobRoss>(
+      0, 0, std::make_unique<bob_ross::Gles3Backend>(options));
+  painter_->EnableDamageTracking(true);
+
+  // Keep recent frames around so a slow one can be dumped with its
+  // predecessors.
+  trace_path_ =
+      std::string(app->activity->internalDataPath) + "/bob_ross_trace.json";
+  gpu_timer_ = std::make_unique<bob_ross::GpuTimer>();
+  bob_ross::Tracer::Get().Enable();
 }
 
 struct GameState {
@@ -314,6 +523,13 @@ void handle_cmd(android_app *pApp, int32_t cmd) {
       pApp->userData = state;
       break;
     }
+    case APP_CMD_LOW_MEMORY: {
+      if (pApp->userData) {
+        reinterpret_cast<GameState *>(pApp->userData)
+            ->renderer_->OnLowMemory();
+      }
+      break;
+    }
     case APP_CMD_TERM_WINDOW: {
       if (pApp->userData) {
         auto *state = reinterpret_cast<GameState *>(pApp->userData);
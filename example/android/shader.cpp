@@ -2,147 +2,59 @@
 #include "android_out.hpp"
 #include "model.hpp"
 #include <GLES3/gl3.h>
+#include <bob_ross/trace.h>
 
-Shader *Shader::loadShader(const std::string &vertexSource,
-                           const std::string &fragmentSource,
-                           const std::string &positionAttributeName,
-                           const std::string &uvAttributeName,
-                           const std::string &projectionMatrixUniformName) {
-  Shader *shader = nullptr;
+std::unique_ptr<Shader> Shader::loadShader(bob_ross::ShaderVariants *variants) {
+  BOB_ROSS_TRACE_SCOPE("Shader::loadShader");
+  variants->Prepare(kFeatures);
+  return std::unique_ptr<Shader>(new Shader(variants));
+}
 
-  GLuint vertexShader = loadShader(GL_VERTEX_SHADER, vertexSource);
-  if (!vertexShader) {
-    return nullptr;
-  }
+Shader::Shader(bob_ross::ShaderVariants *variants) : variants_(variants) {}
 
-  GLuint fragmentShader = loadShader(GL_FRAGMENT_SHADER, fragmentSource);
-  if (!fragmentShader) {
-    glDeleteShader(vertexShader);
-    return nullptr;
+bool Shader::poll() {
+  if (program_) {
+    return true;
   }
-
-  GLuint program = glCreateProgram();
-  if (program) {
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
-
-    glLinkProgram(program);
-    GLint linkStatus = GL_FALSE;
-    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
-    if (linkStatus != GL_TRUE) {
-      GLint logLength = 0;
-      glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
-
-      // If we fail to link the shader program, log the result for debugging
-      if (logLength) {
-        GLchar *log = new GLchar[logLength];
-        glGetProgramInfoLog(program, logLength, nullptr, log);
-        aout << "Failed to link program with:\n" << log << std::endl;
-        delete[] log;
-      }
-
-      glDeleteProgram(program);
-    } else {
-      // Get the attribute and uniform locations by name. You may also choose to
-      // hardcode indices with layout= in your shader, but it is not done in
-      // this sample
-      GLint positionAttribute =
-          glGetAttribLocation(program, positionAttributeName.c_str());
-      GLint uvAttribute = glGetAttribLocation(program, uvAttributeName.c_str());
-      GLint projectionMatrixUniform =
-          glGetUniformLocation(program, projectionMatrixUniformName.c_str());
-
-      // Only create a new shader if all the attributes are found.
-      if (positionAttribute != -1 && uvAttribute != -1 &&
-          projectionMatrixUniform != -1) {
-        shader = new Shader(program, positionAttribute, uvAttribute,
-                            projectionMatrixUniform);
-      } else {
-        glDeleteProgram(program);
-      }
-    }
+  if (variants_->Ready(kFeatures)) {
+    program_ = variants_->Get(kFeatures);
+    return true;
   }
-
-  // The shaders are no longer needed once the program is linked. Release their
-  // memory.
-  glDeleteShader(vertexShader);
-  glDeleteShader(fragmentShader);
-
-  return shader;
-}
-
-GLuint Shader::loadShader(GLenum shaderType, const std::string &shaderSource) {
-  // Utility::assertGlError();
-  GLuint shader = glCreateShader(shaderType);
-  if (shader) {
-    auto *shaderRawString =
-        reinterpret_cast<const GLchar *>(shaderSource.c_str());
-    GLint shaderLength = shaderSource.length();
-    glShaderSource(shader, 1, &shaderRawString, &shaderLength);
-    glCompileShader(shader);
-
-    GLint shaderCompiled = 0;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &shaderCompiled);
-
-    // If the shader doesn't compile, log the result to the terminal for
-    // debugging
-    if (!shaderCompiled) {
-      GLint infoLength = 0;
-      glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &infoLength);
-
-      if (infoLength) {
-        auto *infoLog = new GLchar[infoLength];
-        glGetShaderInfoLog(shader, infoLength, nullptr, infoLog);
-        aout << "Failed to compile with:\n" << infoLog << std::endl;
-        delete[] infoLog;
-      }
-
-      glDeleteShader(shader);
-      shader = 0;
-    }
+  if (variants_->Failed(kFeatures) && !logged_) {
+    // If we fail to build the shader program, log the result for debugging
+    aout << "Failed to build program with:\n"
+         << variants_->error(kFeatures) << std::endl;
+    logged_ = true;
   }
-  return shader;
+  return false;
 }
 
-void Shader::activate() const { glUseProgram(program_); }
+void Shader::activate() const {
+  glUseProgram(program_);
+  // Anything may have been bound since the last frame.
+  boundTexture_ = 0;
+}
 
 void Shader::deactivate() const { glUseProgram(0); }
 
 void Shader::drawModel(const Model &model) const {
-  // The position attribute is 3 floats
-  glVertexAttribPointer(
-      position_,             // attrib
-      3,                     // elements
-      GL_FLOAT,              // of type float
-      GL_FALSE,              // don't normalize
-      sizeof(Vertex),        // stride is Vertex bytes
-      model.getVertexData()  // pull from the start of the vertex data
-  );
-  glEnableVertexAttribArray(position_);
-
-  // The uv attribute is 2 floats
-  glVertexAttribPointer(uv_,             // attrib
-                        2,               // elements
-                        GL_FLOAT,        // of type float
-                        GL_FALSE,        // don't normalize
-                        sizeof(Vertex),  // stride is Vertex bytes
-                        ((uint8_t *)model.getVertexData()) +
-                            sizeof(Vector3)  // offset Vector3 from the start
-  );
-  glEnableVertexAttribArray(uv_);
+  BOB_ROSS_TRACE_SCOPE("Shader::drawModel");
+  // The model's vertex array holds its attribute setup and index buffer, so
+  // nothing is uploaded or re-specified per draw.
+  glBindVertexArray(model.getVertexArray());
 
   // Setup the texture
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, model.getTexture().getTextureID());
+  GLuint texture = model.getTexture().getTextureID();
+  if (texture != boundTexture_) {
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    boundTexture_ = texture;
+  }
 
   // Draw as indexed triangles
   glDrawElements(GL_TRIANGLES, model.getIndexCount(), GL_UNSIGNED_SHORT,
-                 model.getIndexData());
-
-  glDisableVertexAttribArray(uv_);
-  glDisableVertexAttribArray(position_);
-}
+                 nullptr);
 
-void Shader::setProjectionMatrix(float *projectionMatrix) const {
-  glUniformMatrix4fv(projectionMatrix_, 1, false, projectionMatrix);
+  // Keep later element buffer bindings out of the model's vertex array.
+  glBindVertexArray(0);
 }
@@ -1,37 +1,46 @@
 #pragma once
 #include <GLES3/gl3.h>
-#include <string>
+#include <bob_ross/shader_variants.h>
+#include <memory>
 #include "model.hpp"
 
+/*!
+ * A program for drawing Models, the textured and projected variant of the
+ * painter's programs. It is created in a pending state while the driver
+ * compiles it, so the renderer can go on drawing other things until @a poll
+ * reports it ready.
+ *
+ * The projection comes from the BobRossFrame uniform block, so the
+ * bob_ross::FrameUniforms holding it must be bound before drawing.
+ */
 class Shader {
  public:
+  static constexpr uint32_t kFeatures =
+      bob_ross::kShaderTextured | bob_ross::kShaderProjected;
+
   /*!
-   * Loads a shader given the full sourcecode and names for necessary attributes
-   * and uniforms to link to. Returns a valid shader on success or null on
-   * failure. Shader resources are automatically cleaned up on destruction.
+   * Starts building the shader's variant unless it already is. Returns
+   * without waiting for the driver, the shader can only be used once @a poll
+   * returns true.
    *
-   * @param vertexSource The full source code for your vertex program
-   * @param fragmentSource The full source code of your fragment program
-   * @param positionAttributeName The name of the position attribute in your
-   * vertex program
-   * @param uvAttributeName The name of the uv coordinate attribute in your
-   * vertex program
-   * @param projectionMatrixUniformName The name of your model/view/projection
-   * matrix uniform
-   * @return a valid Shader on success, otherwise null.
+   * @param variants where the program is built and kept. Must outlive the
+   * shader.
+   * @return a pending Shader.
+   */
+  static std::unique_ptr<Shader> loadShader(bob_ross::ShaderVariants *variants);
+
+  /*!
+   * Checks whether the program is built. Doesn't block when the driver
+   * supports KHR_parallel_shader_compile, otherwise waits for the driver
+   * the first time it is called.
+   * @return true once the shader can be used.
    */
-  static Shader *loadShader(const std::string &vertexSource,
-                            const std::string &fragmentSource,
-                            const std::string &positionAttributeName,
-                            const std::string &uvAttributeName,
-                            const std::string &projectionMatrixUniformName);
+  bool poll();
 
-  inline ~Shader() {
-    if (program_) {
-      glDeleteProgram(program_);
-      program_ = 0;
-    }
-  }
+  /*!
+   * @return true if the program didn't build, the shader will never be ready.
+   */
+  inline bool failed() const { return variants_->Failed(kFeatures); }
 
   /*!
    * Prepares the shader for use, call this before executing any draw commands
@@ -44,45 +53,21 @@ class Shader {
   void deactivate() const;
 
   /*!
-   * Renders a single model
+   * Renders a single model. Its texture is only bound if the previous model
+   * drawn since @a activate used another, so models sharing an atlas page
+   * should be drawn back to back.
    * @param model a model to render
    */
   void drawModel(const Model &model) const;
 
-  /*!
-   * Sets the model/view/projection matrix in the shader.
-   * @param projectionMatrix sixteen floats, column major, defining an OpenGL
-   * projection matrix.
-   */
-  void setProjectionMatrix(float *projectionMatrix) const;
-
  private:
-  /*!
-   * Helper function to load a shader of a given type
-   * @param shaderType The OpenGL shader type. Should either be GL_VERTEX_SHADER
-   * or GL_FRAGMENT_SHADER
-   * @param shaderSource The full source of the shader
-   * @return the id of the shader, as returned by glCreateShader, or 0 in the
-   * case of an error
-   */
-  static GLuint loadShader(GLenum shaderType, const std::string &shaderSource);
-
   /*!
    * Constructs a new instance of a shader. Use @a loadShader
-   * @param program the GL program id of the shader
-   * @param position the attribute location of the position
-   * @param uv the attribute location of the uv coordinates
-   * @param projectionMatrix the uniform location of the projection matrix
    */
-  constexpr Shader(GLuint program, GLint position, GLint uv,
-                   GLint projectionMatrix)
-      : program_(program),
-        position_(position),
-        uv_(uv),
-        projectionMatrix_(projectionMatrix) {}
+  explicit Shader(bob_ross::ShaderVariants *variants);
 
-  GLuint program_;
-  GLint position_;
-  GLint uv_;
-  GLint projectionMatrix_;
+  bob_ross::ShaderVariants *variants_;
+  bool logged_ = false;
+  GLuint program_ = 0;
+  mutable GLuint boundTexture_ = 0;
 };
@@ -1,6 +1,8 @@
 #include "texture_asset.hpp"
 
 #include <android/imagedecoder.h>
+#include <bob_ross/compressed_texture.h>
+#include <bob_ross/ktx2.h>
 
 #include "android_out.hpp"
 
@@ -10,17 +12,30 @@ void assert(bool passed, std::string message) {
   }
 }
 
-std::shared_ptr<TextureAsset> TextureAsset::loadAsset(
-    AAssetManager *assetManager, const std::string &assetPath) {
+namespace {
+/*!
+ * Decodes an image asset to RGBA. Only touches the asset manager, which is
+ * safe to use from any thread.
+ * @return false if the asset can't be opened or decoded
+ */
+bool decodeAsset(AAssetManager *assetManager, const std::string &assetPath,
+                 bob_ross::DecodedImage *image) {
   // Get the image from asset manager
   auto pAndroidRobotPng =
       AAssetManager_open(assetManager, assetPath.c_str(), AASSET_MODE_BUFFER);
+  if (!pAndroidRobotPng) {
+    return false;
+  }
 
   // Make a decoder to turn it into a texture
   AImageDecoder *pAndroidDecoder = nullptr;
   auto result =
       AImageDecoder_createFromAAsset(pAndroidRobotPng, &pAndroidDecoder);
   assert(result == ANDROID_IMAGE_DECODER_SUCCESS, "Failed to load asset");
+  if (result != ANDROID_IMAGE_DECODER_SUCCESS) {
+    AAsset_close(pAndroidRobotPng);
+    return false;
+  }
 
   // make sure we get 8 bits per channel out. RGBA order.
   AImageDecoder_setAndroidBitmapFormat(pAndroidDecoder,
@@ -31,19 +46,41 @@ std::shared_ptr<TextureAsset> TextureAsset::loadAsset(
   pAndroidHeader = AImageDecoder_getHeaderInfo(pAndroidDecoder);
 
   // important metrics for sending to GL
-  auto width = AImageDecoderHeaderInfo_getWidth(pAndroidHeader);
-  auto height = AImageDecoderHeaderInfo_getHeight(pAndroidHeader);
-  auto stride = AImageDecoder_getMinimumStride(pAndroidDecoder);
+  image->width = AImageDecoderHeaderInfo_getWidth(pAndroidHeader);
+  image->height = AImageDecoderHeaderInfo_getHeight(pAndroidHeader);
+  image->stride = AImageDecoder_getMinimumStride(pAndroidDecoder);
 
   // Get the bitmap data of the image
-  auto upAndroidImageData =
-      std::make_unique<std::vector<uint8_t>>(height * stride);
+  image->pixels.resize(image->height * image->stride);
   auto decodeResult =
-      AImageDecoder_decodeImage(pAndroidDecoder, upAndroidImageData->data(),
-                                stride, upAndroidImageData->size());
+      AImageDecoder_decodeImage(pAndroidDecoder, image->pixels.data(),
+                                image->stride, image->pixels.size());
   assert(decodeResult == ANDROID_IMAGE_DECODER_SUCCESS,
          "Failed to decode asset");
 
+  // cleanup helpers
+  AImageDecoder_delete(pAndroidDecoder);
+  AAsset_close(pAndroidRobotPng);
+  return decodeResult == ANDROID_IMAGE_DECODER_SUCCESS;
+}
+}  // namespace
+
+std::shared_ptr<TextureAsset> TextureAsset::loadAsset(
+    AAssetManager *assetManager, const std::string &assetPath,
+    bob_ross::TextureAtlas *atlas) {
+  bob_ross::DecodedImage image;
+  decodeAsset(assetManager, assetPath, &image);
+
+  // Small images share a page of the atlas, the atlas mipmaps it when
+  // flushed.
+  if (atlas) {
+    bob_ross::AtlasRegion region = atlas->Add(
+        image.pixels.data(), image.width, image.height, image.stride);
+    if (region.texture) {
+      return std::shared_ptr<TextureAsset>(new TextureAsset(region, false, 0));
+    }
+  }
+
   // Get an opengl texture
   GLuint textureId;
   glGenTextures(1, &textureId);
@@ -61,26 +98,107 @@ std::shared_ptr<TextureAsset> TextureAsset::loadAsset(
   glTexImage2D(GL_TEXTURE_2D,     // target
                0,                 // mip level
                GL_RGBA,           // internal format, often advisable to use BGR
-               width,             // width of the texture
-               height,            // height of the texture
+               image.width,       // width of the texture
+               image.height,      // height of the texture
                0,                 // border (always 0)
                GL_RGBA,           // format
                GL_UNSIGNED_BYTE,  // type
-               upAndroidImageData->data());  // Data to upload
+               image.pixels.data());  // Data to upload
 
   // generate mip levels. Not really needed for 2D, but good to do
   glGenerateMipmap(GL_TEXTURE_2D);
 
-  // cleanup helpers
-  AImageDecoder_delete(pAndroidDecoder);
-  AAsset_close(pAndroidRobotPng);
-
   // Create a shared pointer so it can be cleaned up easily/automatically
-  return std::shared_ptr<TextureAsset>(new TextureAsset(textureId));
+  bob_ross::AtlasRegion region;
+  region.texture = textureId;
+  return std::shared_ptr<TextureAsset>(new TextureAsset(
+      region, true, bob_ross::Rgba8TextureBytes(image.width, image.height)));
+}
+
+std::shared_ptr<TextureAsset> TextureAsset::loadAssetAsync(
+    AAssetManager *assetManager, const std::string &assetPath,
+    bob_ross::TextureLoader *loader) {
+  auto texture = loader->Load(
+      [assetManager, assetPath](bob_ross::DecodedImage *image) {
+        return decodeAsset(assetManager, assetPath, image);
+      });
+  return std::shared_ptr<TextureAsset>(new TextureAsset(std::move(texture)));
+}
+
+std::shared_ptr<TextureAsset> TextureAsset::loadCompressedAsset(
+    AAssetManager *assetManager, const std::string &assetPath) {
+  // Uncompressed assets are mapped rather than read in buffer mode.
+  auto asset =
+      AAssetManager_open(assetManager, assetPath.c_str(), AASSET_MODE_BUFFER);
+  if (!asset) {
+    return nullptr;
+  }
+  auto data = static_cast<const uint8_t *>(AAsset_getBuffer(asset));
+  auto size = static_cast<size_t>(AAsset_getLength(asset));
+
+  // Parsing only points into the mapping, the upload is the one copy.
+  bob_ross::Ktx2Texture texture;
+  std::string error;
+  GLuint textureId = 0;
+  if (data && bob_ross::ParseKtx2(data, size, &texture, &error)) {
+    textureId = bob_ross::UploadCompressedTexture(texture, &error);
+  }
+  AAsset_close(asset);
+  if (!textureId) {
+    aout << assetPath << ": " << error << std::endl;
+    return nullptr;
+  }
+
+  size_t gpuBytes = 0;
+  for (const bob_ross::Ktx2Texture::Level &level : texture.levels) {
+    gpuBytes += level.size;
+  }
+  bob_ross::AtlasRegion region;
+  region.texture = textureId;
+  return std::shared_ptr<TextureAsset>(
+      new TextureAsset(region, true, gpuBytes));
+}
+
+std::shared_ptr<TextureAsset> TextureAsset::loadCached(
+    bob_ross::TextureCache *cache, AAssetManager *assetManager,
+    const std::string &assetPath, uint32_t flags,
+    bob_ross::TextureAtlas *atlas, bob_ross::TextureLoader *loader) {
+  auto texture = cache->Get(assetPath, flags, [&]() {
+    std::shared_ptr<TextureAsset> asset;
+    if (flags & kLoadCompressed) {
+      // image.png has its compressed copy in image.ktx2.
+      std::string compressedPath =
+          assetPath.substr(0, assetPath.rfind('.')) + ".ktx2";
+      asset = loadCompressedAsset(assetManager, compressedPath);
+    }
+    if (!asset && (flags & kLoadAsync)) {
+      asset = loadAssetAsync(assetManager, assetPath, loader);
+    }
+    if (!asset) {
+      asset = loadAsset(assetManager, assetPath,
+                        flags & kLoadAtlas ? atlas : nullptr);
+    }
+    return asset;
+  });
+  return std::static_pointer_cast<TextureAsset>(texture);
+}
+
+size_t TextureAsset::gpu_bytes() const {
+  // The loader allocates storage once the image is decoded, as big as an
+  // uncompressed texture of its own.
+  if (async_) {
+    return async_->width() ? bob_ross::Rgba8TextureBytes(async_->width(),
+                                                         async_->height())
+                           : 0;
+  }
+  return gpuBytes_;
 }
 
 TextureAsset::~TextureAsset() {
-  // return texture resources
-  glDeleteTextures(1, &textureID_);
-  textureID_ = 0;
+  // return texture resources. Atlas pages belong to the atlas, async
+  // textures clean up after themselves.
+  if (ownsTexture_) {
+    glDeleteTextures(1, &region_.texture);
+  }
+  region_.texture = 0;
 }
@@ -2,33 +2,127 @@
 
 #include <GLES3/gl3.h>
 #include <android/asset_manager.h>
+#include <bob_ross/texture_atlas.h>
+#include <bob_ross/texture_cache.h>
+#include <bob_ross/texture_loader.h>
 
 #include <memory>
 #include <string>
 #include <vector>
 
-class TextureAsset {
+class TextureAsset : public bob_ross::CachedTexture {
  public:
+  /*!
+   * How loadCached loads an asset. Part of the cache key, since each gives
+   * a different texture.
+   */
+  enum LoadFlags : uint32_t {
+    // Pack the image into the atlas if it fits, see loadAsset.
+    kLoadAtlas = 1,
+    // Decode and upload in the background, see loadAssetAsync.
+    kLoadAsync = 2,
+    // Use the KTX2 file next to the image if there is one, see
+    // loadCompressedAsset.
+    kLoadCompressed = 4,
+  };
+
+  /*!
+   * Returns the texture of an asset from the cache, loading it on the first
+   * call. Models sharing an image share one texture, and the cache keeps
+   * textures no model uses within its budget.
+   * @param cache Cache to look the texture up in
+   * @param assetManager Asset manager to use
+   * @param assetPath The path to the image asset
+   * @param flags LoadFlags to load with
+   * @param atlas Atlas for kLoadAtlas, must outlive the cache
+   * @param loader Loader for kLoadAsync, must outlive the cache
+   * @return a shared pointer to a texture asset, null if it can't be loaded
+   */
+  static std::shared_ptr<TextureAsset> loadCached(
+      bob_ross::TextureCache *cache, AAssetManager *assetManager,
+      const std::string &assetPath, uint32_t flags,
+      bob_ross::TextureAtlas *atlas, bob_ross::TextureLoader *loader);
+
   /*!
    * Loads a texture asset from the assets/ directory
    * @param assetManager Asset manager to use
    * @param assetPath The path to the asset
+   * @param atlas Where small images are packed together with others, so
+   * models using them share a texture. Images the atlas refuses get a
+   * texture of their own. May be null, must outlive the texture asset.
+   * @return a shared pointer to a texture asset, resources will be reclaimed
+   * when it's cleaned up
+   */
+  static std::shared_ptr<TextureAsset> loadAsset(
+      AAssetManager *assetManager, const std::string &assetPath,
+      bob_ross::TextureAtlas *atlas = nullptr);
+
+  /*!
+   * Starts loading a texture asset from the assets/ directory without
+   * waiting for it. The image is decoded on the loader's threads and
+   * uploaded as the loader is pumped, the texture is the loader's
+   * placeholder until then.
+   * @param assetManager Asset manager to use
+   * @param assetPath The path to the asset
+   * @param loader Loader to decode and upload with, must outlive the texture
+   * asset
    * @return a shared pointer to a texture asset, resources will be reclaimed
    * when it's cleaned up
    */
-  static std::shared_ptr<TextureAsset> loadAsset(AAssetManager *assetManager,
-                                                 const std::string &assetPath);
+  static std::shared_ptr<TextureAsset> loadAssetAsync(
+      AAssetManager *assetManager, const std::string &assetPath,
+      bob_ross::TextureLoader *loader);
 
-  ~TextureAsset();
+  /*!
+   * Loads a KTX2 asset made by bob_ross_texture_tool. Its mip levels are
+   * block compressed already and go to GL straight from the mapped asset,
+   * without decoding or generating anything, so the asset should be stored
+   * uncompressed in the APK.
+   * @param assetManager Asset manager to use
+   * @param assetPath The path to the asset
+   * @return a shared pointer to a texture asset, or null if the asset is
+   * missing or its format isn't supported by the device
+   */
+  static std::shared_ptr<TextureAsset> loadCompressedAsset(
+      AAssetManager *assetManager, const std::string &assetPath);
+
+  ~TextureAsset() override;
+
+  /*!
+   * @return bytes of GPU memory the texture owns. Atlas pages belong to the
+   * atlas, images still loading own nothing until their storage exists.
+   */
+  size_t gpu_bytes() const override;
+
+  /*!
+   * @return the texture id for use with OpenGL, an atlas page for packed
+   * images or the placeholder for images still loading
+   */
+  inline GLuint getTextureID() const {
+    return async_ ? async_->texture() : region_.texture;
+  }
+
+  /*!
+   * @return false while the image is still loading
+   */
+  inline bool isReady() const { return !async_ || async_->ready(); }
 
   /*!
-   * @return the texture id for use with OpenGL
+   * @return where the image is in its texture. Texture coordinates of the
+   * image have to be mapped into it, see Model.
    */
-  constexpr GLuint getTextureID() const { return textureID_; }
+  constexpr const bob_ross::AtlasRegion &getRegion() const { return region_; }
 
  private:
-  explicit inline TextureAsset(GLuint textureId) : textureID_(textureId) {}
+  inline TextureAsset(const bob_ross::AtlasRegion &region, bool ownsTexture,
+                      size_t gpuBytes)
+      : region_(region), ownsTexture_(ownsTexture), gpuBytes_(gpuBytes) {}
+  explicit inline TextureAsset(std::shared_ptr<bob_ross::AsyncTexture> async)
+      : ownsTexture_(false), async_(std::move(async)) {}
 
-  GLuint textureID_;
+  bob_ross::AtlasRegion region_;
+  bool ownsTexture_;
+  size_t gpuBytes_ = 0;
+  std::shared_ptr<bob_ross::AsyncTexture> async_;
 };
 
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <bob_ross/command_buffer.h>
+#include <bob_ross/types.h>
+
+#include <cstddef>
+
+namespace bob_ross {
+
+// A backend turns recorded commands into pixels. BobRoss calls Replay at
+// every Flush, possibly several times per frame, between BeginFrame and
+// EndFrame. The fill color state does not carry over between replays.
+class Backend {
+ public:
+  virtual ~Backend() = default;
+
+  virtual void Resize(int screen_width, int screen_height) = 0;
+  virtual void BeginFrame() = 0;
+  virtual void Replay(const CommandBuffer &commands) = 0;
+  // Restricts the replays until the end of the frame to |count| disjoint
+  // rectangles, none of them when |count| is 0. Frames start unclipped.
+  virtual void SetClipRects(const PixelRect *rects, size_t count) = 0;
+  virtual void EndFrame() = 0;
+};
+
+}  // namespace bob_ross
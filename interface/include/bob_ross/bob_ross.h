@@ -1,28 +1,118 @@
 #pragma once
 
+#include <bob_ross/backend.h>
+#include <bob_ross/command_buffer.h>
+#include <bob_ross/types.h>
+
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace bob_ross {
 
-struct Point {
-  float x, y, z = 0.0f;
-};
-
-struct Color {
-  int r, g, b, a;
-};
+struct Bounds;
+class DamageTracker;
+class SpatialIndex;
 
+// Records drawing calls into a per-frame command buffer. Nothing is drawn
+// until the commands are handed to the backend by Flush or EndFrame.
+//
+// Shapes entirely outside the screen are dropped as they are recorded, so
+// they never reach tessellation or the GPU.
+//
+// Shapes are painted in call order, except that among the shapes replayed
+// together those with a greater z cover those with a smaller one. A shape's
+// z is that of its first point, and bulk calls take the z of their first
+// element. Backends are free to reorder shapes that don't overlap.
 class BobRoss {
  public:
   BobRoss(int screen_width, int screen_height);
+  BobRoss(int screen_width, int screen_height,
+          std::unique_ptr<Backend> backend);
+  ~BobRoss();
+
   void UpdateScreenDimension(int screen_width, int screen_height);
+
+  // Starts a new frame, dropping anything recorded but not flushed.
+  void BeginFrame();
+  // Flushes the remaining commands and finishes the frame.
+  void EndFrame();
+  // Replays everything recorded so far on the backend.
+  void Flush();
+
+  // While damage tracking is on, every frame is compared to the previous one
+  // and only the regions that changed are redrawn. Flushes before
+  // ComputeDamage are deferred until EndFrame, which then makes the same
+  // replays they would have, so the frame looks the same as untracked.
+  void EnableDamageTracking(bool enable);
+  // Returns the regions to redraw for a back buffer |buffer_age| frames old,
+  // as reported by EGL_BUFFER_AGE_KHR or 0 if unknown, and clips the replay
+  // at EndFrame to them. Call once after recording the frame, then clear
+  // the rectangles and present them with eglSwapBuffersWithDamageKHR. Empty
+  // when nothing changed and the frame doesn't need to be presented. Covers
+  // the whole screen while tracking is off. The reference stays valid until
+  // the next call.
+  const std::vector<PixelRect> &ComputeDamage(int buffer_age);
+  // Damages the whole screen in the next ComputeDamage, for when pixels
+  // drawn outside BobRoss change.
+  void InvalidateDamage();
+
   void SetFillColor(Color color);
+  // Every shape drawn in a frame gets an id, counting up from 0 at
+  // BeginFrame in call order. The elements of bulk calls count one each.
+  // Culled shapes get ids too, so they always match the caller's order.
   void Circle(Point origin, float radius);
-  void Polygon(std::vector<Point> points, std::vector<Point> indexes);
+  // Fills the simple polygon outlined by |points|, which may be concave. The
+  // backend triangulates it.
+  void Polygon(const std::vector<Point> &points);
+  void Polygon(const Point *points, size_t point_count);
+  // Fills triangles given as three |indexes| each into |points|.
+  void Polygon(const std::vector<Point> &points,
+               const std::vector<uint32_t> &indexes);
+  void Polygon(const Point *points, size_t point_count,
+               const uint32_t *indexes, size_t index_count);
   void Rect(Point top_left, Point bottom_right);
 
+  // Bulk versions of the calls above, all filled with the current color. The
+  // arrays are copied once into the command buffer and can be reused as soon
+  // as the call returns.
+  void Circles(const CircleInstance *circles, size_t count);
+  void Rects(const RectInstance *rects, size_t count);
+  void Polygons(const PolygonOutline *polygons, size_t count);
+
+  // Indexes the shapes of every frame so the last finished one can be
+  // hit-tested.
+  void EnableHitTesting(bool enable);
+  // Id of the topmost shape of the last finished frame containing |point|,
+  // or -1 if there is none or hit testing is off. Shapes flushed later are
+  // above earlier ones, then those with the greatest z, then the greatest
+  // id, as they are drawn.
+  int64_t HitTest(Point point) const;
+
+  const CommandBuffer &commands() const { return commands_; }
+
  private:
+  void EmitFillColor();
+  bool IsOnScreen(const Bounds &bounds) const;
+
   int screen_width_, screen_height_;
+  std::unique_ptr<Backend> backend_;
+  CommandBuffer commands_;
+  std::unique_ptr<DamageTracker> damage_tracker_;
+  bool damage_computed_ = false;
+  // Where in commands_ the Flush calls deferred until ComputeDamage were,
+  // as byte offsets. Each ends a replay.
+  std::vector<size_t> deferred_flushes_;
+  // One deferred replay at a time, copied out of commands_.
+  CommandBuffer replay_;
+  // Returned by ComputeDamage while tracking is off.
+  std::vector<PixelRect> untracked_damage_;
+  Color fill_color_ = {0, 0, 0, 255};
+  bool fill_color_dirty_ = true;
+  uint32_t next_shape_id_ = 0;
+  // Shapes of the frame being recorded, and of the last finished one.
+  std::unique_ptr<SpatialIndex> recording_index_;
+  std::unique_ptr<SpatialIndex> hit_index_;
 };
 
 }  // namespace bob_ross
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <bob_ross/types.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+namespace bob_ross {
+
+enum class CommandType : uint8_t {
+  kSetFillColor,
+  kCircle,
+  kRect,
+  kPolygon,
+  kCircles,
+  kRects,
+};
+
+// Every command is a trivially copyable record laid out back to back in the
+// buffer. Variable length payloads (polygon points and indices) follow the
+// fixed part of the command.
+struct SetFillColorCommand {
+  static constexpr CommandType kType = CommandType::kSetFillColor;
+  Color color;
+};
+
+struct CircleCommand : CircleInstance {
+  static constexpr CommandType kType = CommandType::kCircle;
+};
+
+struct RectCommand : RectInstance {
+  static constexpr CommandType kType = CommandType::kRect;
+};
+
+// Followed by |count| CircleInstances.
+struct CirclesCommand {
+  static constexpr CommandType kType = CommandType::kCircles;
+  uint32_t count;
+
+  const CircleInstance *circles() const {
+    return reinterpret_cast<const CircleInstance *>(this + 1);
+  }
+  CircleInstance *circles() {
+    return reinterpret_cast<CircleInstance *>(this + 1);
+  }
+};
+
+// Followed by |count| RectInstances.
+struct RectsCommand {
+  static constexpr CommandType kType = CommandType::kRects;
+  uint32_t count;
+
+  const RectInstance *rects() const {
+    return reinterpret_cast<const RectInstance *>(this + 1);
+  }
+  RectInstance *rects() { return reinterpret_cast<RectInstance *>(this + 1); }
+};
+
+// Followed by |point_count| Points and |index_count| uint32_t triangle
+// indices. Without indices the points are a simple polygon outline that the
+// backend triangulates.
+struct PolygonCommand {
+  static constexpr CommandType kType = CommandType::kPolygon;
+  uint32_t point_count;
+  uint32_t index_count;
+
+  const Point *points() const {
+    return reinterpret_cast<const Point *>(this + 1);
+  }
+  Point *points() { return reinterpret_cast<Point *>(this + 1); }
+  const uint32_t *indices() const {
+    return reinterpret_cast<const uint32_t *>(points() + point_count);
+  }
+  uint32_t *indices() {
+    return reinterpret_cast<uint32_t *>(points() + point_count);
+  }
+};
+
+struct CommandHeader {
+  CommandType type;
+  // Size of the record following the header, padded to kCommandAlignment.
+  uint32_t size;
+};
+
+constexpr size_t kCommandAlignment = 8;
+
+// A view of a single recorded command.
+struct CommandRef {
+  CommandType type;
+  const void *data;
+
+  template <typename T>
+  const T &As() const {
+    assert(T::kType == type);
+    return *static_cast<const T *>(data);
+  }
+};
+
+// Flat, arena backed list of drawing commands for one frame. Memory is kept
+// between frames, so once the buffer has grown to the size of a typical frame
+// recording does not allocate.
+class CommandBuffer {
+ public:
+  class Iterator {
+   public:
+    explicit Iterator(const uint8_t *cursor) : cursor_(cursor) {}
+
+    CommandRef operator*() const {
+      auto *header = reinterpret_cast<const CommandHeader *>(cursor_);
+      return {header->type, cursor_ + sizeof(CommandHeader)};
+    }
+    Iterator &operator++() {
+      auto *header = reinterpret_cast<const CommandHeader *>(cursor_);
+      cursor_ += sizeof(CommandHeader) + header->size;
+      return *this;
+    }
+    bool operator!=(const Iterator &other) const {
+      return cursor_ != other.cursor_;
+    }
+
+   private:
+    const uint8_t *cursor_;
+  };
+
+  CommandBuffer() = default;
+  CommandBuffer(const CommandBuffer &) = delete;
+  CommandBuffer &operator=(const CommandBuffer &) = delete;
+
+  // Appends a command of type T followed by |payload_bytes| of uninitialized
+  // storage. The returned pointer is valid until the next Append or Reset.
+  template <typename T>
+  T *Append(size_t payload_bytes = 0) {
+    void *record = Allocate(T::kType, sizeof(T) + payload_bytes);
+    return new (record) T();
+  }
+
+  // Shrinks the payload of the last appended command, a T, to
+  // |payload_bytes|, so a command can be appended at its largest and
+  // trimmed once filled in.
+  template <typename T>
+  void ShrinkLast(size_t payload_bytes) {
+    Shrink(sizeof(T) + payload_bytes);
+  }
+  // Removes the last appended command.
+  void DropLast();
+
+  // Appends copies of the commands |source| recorded between the byte
+  // offsets |begin| and |end|, both byte_size() values of |source|.
+  void AppendRange(const CommandBuffer &source, size_t begin, size_t end);
+
+  // Drops all commands but keeps the allocated storage.
+  void Reset();
+
+  bool empty() const { return size_ == 0; }
+  size_t command_count() const { return command_count_; }
+  size_t byte_size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+
+  Iterator begin() const { return Iterator(storage_.get()); }
+  Iterator end() const { return Iterator(storage_.get() + size_); }
+
+ private:
+  void *Allocate(CommandType type, size_t size);
+  void Shrink(size_t size);
+  void Grow(size_t min_capacity);
+
+  std::unique_ptr<uint8_t[]> storage_;
+  size_t size_ = 0;
+  // Where the last appended command's header is.
+  size_t last_ = 0;
+  size_t capacity_ = 0;
+  size_t command_count_ = 0;
+};
+
+}  // namespace bob_ross
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+namespace bob_ross {
+
+struct Point {
+  float x, y, z = 0.0f;
+};
+
+struct Color {
+  int r, g, b, a;
+};
+
+// Element types of the bulk drawing calls. The calls copy the elements, the
+// caller's arrays can be freed once they return.
+struct RectInstance {
+  Point top_left;
+  Point bottom_right;
+};
+
+struct CircleInstance {
+  Point origin;
+  float radius;
+};
+
+// Integer pixel rectangle covering [left, right) x [top, bottom), with the
+// origin at the top left of the screen.
+struct PixelRect {
+  int left, top, right, bottom;
+};
+
+struct PolygonOutline {
+  const Point *points;
+  size_t point_count;
+};
+
+}  // namespace bob_ross
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+#include <bob_ross/ktx2.h>
+
+#include <cstdint>
+#include <string>
+
+namespace bob_ross {
+
+// GL internal format of a Ktx2Format, 0 when the current context can't
+// sample it. ETC2 is core in GLES 3, ASTC needs
+// GL_KHR_texture_compression_astc_ldr.
+GLenum CompressedTextureFormat(uint32_t format);
+
+// Creates a texture from the block compressed levels of |texture|, passed
+// straight to glCompressedTexImage2D, so they are never decoded on the CPU
+// and no levels are generated. Wraps clamped to the edge and filters
+// trilinearly when there are mip levels. Returns 0 with a reason in |error|
+// when the format is unsupported or GL refuses the data. Call with a
+// current GL context.
+GLuint UploadCompressedTexture(const Ktx2Texture &texture, std::string *error);
+
+}  // namespace bob_ross
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+
+namespace bob_ross {
+
+// The BobRossFrame uniform block every ShaderVariants program declares, in
+// std140 layout.
+struct FrameConstants {
+  // Column major, for programs with kShaderProjected.
+  float projection[16];
+  // In pixels, for programs drawing in pixels.
+  float screen_size[2];
+  float padding[2];
+};
+
+// Holds the per-frame constants of all programs in one uniform buffer, so
+// they are uploaded once a frame instead of once per program. Must be
+// created and used with a current GL context.
+class FrameUniforms {
+ public:
+  // Uniform buffer binding point of the BobRossFrame block.
+  static constexpr GLuint kBinding = 0;
+
+  FrameUniforms();
+  ~FrameUniforms();
+  FrameUniforms(const FrameUniforms &) = delete;
+  FrameUniforms &operator=(const FrameUniforms &) = delete;
+
+  // Sixteen floats, column major.
+  void SetProjection(const float *matrix);
+  void SetScreenSize(int screen_width, int screen_height);
+
+  // Uploads the constants if they changed and binds the buffer to
+  // kBinding. Call before drawing with programs that use it.
+  void Bind();
+
+  const FrameConstants &constants() const { return constants_; }
+
+ private:
+  GLuint buffer_ = 0;
+  FrameConstants constants_ = {};
+  bool dirty_ = true;
+};
+
+}  // namespace bob_ross
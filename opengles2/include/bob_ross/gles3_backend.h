@@ -0,0 +1,152 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+#include <bob_ross/backend.h>
+#include <bob_ross/draw_sorter.h>
+#include <bob_ross/gpu_timer.h>
+#include <bob_ross/program_cache.h>
+#include <bob_ross/tessellation_cache.h>
+#include <bob_ross/tessellator.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace bob_ross {
+
+class FrameUniforms;
+class ShaderVariants;
+class StreamBuffer;
+struct ShapeInstance;
+
+struct Gles3Options {
+  // Draws Rect and Circle as instances of a unit quad instead of tessellating
+  // them. Polygons always use the triangle mesh path.
+  bool instanced_shapes = true;
+  // Tolerance in pixels used when circles are tessellated.
+  float max_tessellation_error = kDefaultMaxError;
+  // Memory kept for polygon triangulations reused across frames. 0 turns
+  // the cache off.
+  size_t tessellation_cache_bytes = TessellationCache::kDefaultBudgetBytes;
+  // Reorders shapes that don't overlap so those drawn with the same program
+  // share draw calls. See DrawSorter.
+  bool reorder_draws = true;
+  // Streams the triangles of batches whose positions fit 16 bit fixed
+  // point with 8 byte vertices instead of 16 byte ones. Each batch gets as
+  // many subpixel steps as its extent allows, at least 4 and at most 256.
+  bool compact_vertices = true;
+  // Loads the backend's programs from and stores them to this cache instead
+  // of always compiling them. Not owned, must outlive the backend's
+  // constructor.
+  ProgramBinaryCache *program_cache = nullptr;
+  // Programs to draw with, shared with the app's own drawing. Not owned,
+  // must outlive the backend. The backend makes its own, with
+  // program_cache, when null.
+  ShaderVariants *shader_variants = nullptr;
+  // Per-frame constants the backend sets the screen size of on Resize.
+  // Not owned, must outlive the backend. The backend makes its own when
+  // null.
+  FrameUniforms *frame_uniforms = nullptr;
+};
+
+// Draws BobRoss commands with OpenGL ES 3. Must be created and used with a
+// current GL context.
+//
+// Every replay is tessellated into one streaming vertex and index buffer.
+// Shapes are first put in DrawSorter order, which groups those that share
+// GL state where overlap allows. Consecutive shapes that share GL state are
+// then merged into a single glDrawElements, so draw calls grow with state
+// changes, not shape count.
+// With instanced shapes enabled, runs of Rect and Circle are instead drawn
+// with one glDrawArraysInstanced over a shared unit quad.
+// Shapes blend with straight alpha. The backend enables GL_BLEND with
+// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA) whenever it draws and
+// leaves it that way.
+//
+// The GL programs are ShaderVariants. They start building when the backend
+// is created and are only waited for at the first Replay, see
+// PendingProgram.
+class Gles3Backend : public Backend {
+ public:
+  Gles3Backend();
+  explicit Gles3Backend(const Gles3Options &options);
+  ~Gles3Backend() override;
+
+  void Resize(int screen_width, int screen_height) override;
+  void BeginFrame() override;
+  void Replay(const CommandBuffer &commands) override;
+  void SetClipRects(const PixelRect *rects, size_t count) override;
+  void EndFrame() override;
+
+  // Number of draw calls issued since BeginFrame.
+  int draw_calls() const { return draw_calls_; }
+  // Vertex, index and instance bytes streamed to GL since BeginFrame.
+  size_t bytes_uploaded() const { return bytes_uploaded_; }
+  const TessellationCache &tessellation_cache() const {
+    return tessellation_cache_;
+  }
+
+ private:
+  // GL state a batch is drawn with. Shapes can only share a draw call when
+  // their pipelines match.
+  enum class Pipeline { kSolid, kInstancedShape };
+
+  // |first| and |count| are indices into the mesh for kSolid and instances
+  // for kInstancedShape. kSolid batches also know their vertices in the
+  // mesh and, once packed, where they start in the vertex stream and their
+  // format: subpixel steps of compact positions, or 0 for floats.
+  struct Batch {
+    Pipeline pipeline;
+    size_t first;
+    size_t count;
+    size_t first_vertex = 0;
+    size_t vertex_count = 0;
+    size_t vertex_offset = 0;
+    int subpixels = 0;
+  };
+
+  template <typename Shape>
+  void AddInstances(const Shape *shapes, uint32_t count, uint32_t color);
+  void AddToBatch(Pipeline pipeline, size_t first, size_t count,
+                  size_t first_vertex = 0);
+  void FinishPrograms();
+  bool PackVertices();
+  void DrawBatches();
+  void IssueBatches(size_t vertex_offset, size_t index_offset,
+                    size_t instance_offset);
+  void SetupMeshAttributes(size_t vertex_offset, int subpixels);
+  void SetupInstanceAttributes(size_t instance_offset);
+
+  Gles3Options options_;
+  std::unique_ptr<ShaderVariants> own_shader_variants_;
+  ShaderVariants *shader_variants_ = nullptr;
+  std::unique_ptr<FrameUniforms> own_frame_uniforms_;
+  FrameUniforms *frame_uniforms_ = nullptr;
+  // Owned by shader_variants_, set at the first Replay.
+  bool programs_finished_ = false;
+  GLuint program_ = 0;
+  GLint position_scale_uniform_ = -1;
+  GLuint instanced_program_ = 0;
+  GLuint vertex_array_ = 0;
+  GLuint instanced_vertex_array_ = 0;
+  GLuint quad_buffer_ = 0;
+  std::unique_ptr<StreamBuffer> vertex_buffer_;
+  std::unique_ptr<StreamBuffer> index_buffer_;
+  std::unique_ptr<StreamBuffer> instance_buffer_;
+  int screen_width_ = 0, screen_height_ = 0;
+  bool clipped_ = false;
+  std::vector<PixelRect> clip_rects_;
+  int draw_calls_ = 0;
+  size_t bytes_uploaded_ = 0;
+  GpuTimer gpu_timer_;
+  Mesh mesh_;
+  // Vertices of the mesh in the format of their batch.
+  std::vector<uint8_t> packed_vertices_;
+  Triangulator triangulator_;
+  DrawSorter draw_sorter_;
+  TessellationCache tessellation_cache_;
+  std::vector<ShapeInstance> instances_;
+  std::vector<Batch> batches_;
+};
+
+}  // namespace bob_ross
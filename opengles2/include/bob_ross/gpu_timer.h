@@ -0,0 +1,64 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace bob_ross {
+
+// Measures GPU time of GL commands with GL_EXT_disjoint_timer_query and
+// records it to the Tracer's GPU track. Results are polled a few frames
+// later instead of stalling on them. Does nothing while tracing is disabled
+// or when the extension is missing.
+//
+// Time elapsed queries can't nest, so only one scope may be open at a time
+// per context. Must be created and used with a current GL context.
+class GpuTimer {
+ public:
+  GpuTimer();
+  ~GpuTimer();
+  GpuTimer(const GpuTimer &) = delete;
+  GpuTimer &operator=(const GpuTimer &) = delete;
+
+  bool available() const { return available_; }
+
+  // Starts timing the commands issued until End. |name| must outlive the
+  // tracer.
+  void Begin(const char *name);
+  void End();
+
+  // Records every finished query to the tracer. Call once a frame. Events
+  // are placed at the CPU time of their Begin since GL doesn't relate the
+  // two clocks.
+  void Collect();
+
+ private:
+  struct Pending {
+    GLuint query;
+    const char *name;
+    int64_t start_ns;
+  };
+
+  bool available_ = false;
+  bool open_ = false;
+  std::vector<GLuint> free_queries_;
+  std::deque<Pending> pending_;
+};
+
+// Times GL commands issued in the enclosing block.
+class GpuTraceScope {
+ public:
+  GpuTraceScope(GpuTimer *timer, const char *name) : timer_(timer) {
+    timer_->Begin(name);
+  }
+  ~GpuTraceScope() { timer_->End(); }
+  GpuTraceScope(const GpuTraceScope &) = delete;
+  GpuTraceScope &operator=(const GpuTraceScope &) = delete;
+
+ private:
+  GpuTimer *timer_;
+};
+
+}  // namespace bob_ross
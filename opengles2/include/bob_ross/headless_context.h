@@ -0,0 +1,54 @@
+#pragma once
+
+#include <EGL/egl.h>
+#include <GLES3/gl3.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace bob_ross {
+
+// An OpenGL ES 3 context without a window, for benchmarks, regression
+// checks and server side rendering. Rendering goes to an offscreen
+// framebuffer object that can be read back. On Linux this prefers Mesa's
+// surfaceless platform, which also works with llvmpipe on machines without
+// a GPU, and falls back to a pbuffer on the default display.
+class HeadlessContext {
+ public:
+  // Creates a context and makes it current on the calling thread, with a
+  // |width| by |height| framebuffer bound and the viewport covering it.
+  // Returns null if no display or GLES 3 context is available.
+  static std::unique_ptr<HeadlessContext> Create(int width, int height);
+
+  ~HeadlessContext();
+  HeadlessContext(const HeadlessContext &) = delete;
+  HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+  // Reallocates the framebuffer, its contents become undefined.
+  void Resize(int width, int height);
+
+  void MakeCurrent() const;
+
+  // Waits for rendering to finish and copies the framebuffer into |pixels|
+  // as RGBA8, top row first.
+  void ReadPixels(std::vector<uint32_t> *pixels) const;
+
+  int width() const { return width_; }
+  int height() const { return height_; }
+  EGLDisplay display() const { return display_; }
+  const char *renderer() const;
+
+ private:
+  HeadlessContext() = default;
+
+  EGLDisplay display_ = EGL_NO_DISPLAY;
+  EGLContext context_ = EGL_NO_CONTEXT;
+  EGLSurface surface_ = EGL_NO_SURFACE;
+  GLuint framebuffer_ = 0;
+  GLuint color_buffer_ = 0;
+  GLuint depth_buffer_ = 0;
+  int width_ = 0, height_ = 0;
+};
+
+}  // namespace bob_ross
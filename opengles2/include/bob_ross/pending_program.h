@@ -0,0 +1,72 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+#include <bob_ross/program_cache.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bob_ross {
+
+struct ProgramSource {
+  std::string vertex;
+  std::string fragment;
+  // Vertex inputs bound to a location before linking, for shaders that
+  // don't declare their locations.
+  std::vector<std::pair<GLuint, std::string>> attribute_locations;
+};
+
+// Builds a GL program without waiting for the driver. Creating one only
+// issues the compile and link commands, so several programs can be started
+// back to back and compiled by the driver at the same time. Asking for the
+// compile status right away would wait for each one in turn.
+//
+// With KHR_parallel_shader_compile, Poll asks the driver whether the build
+// is done with GL_COMPLETION_STATUS_KHR, which never blocks. Without it the
+// status is queried on the first Poll, so polling as late as possible
+// leaves the driver the most time.
+//
+// Must be created and used with a current GL context.
+class PendingProgram {
+ public:
+  enum class Status { kCompiling, kReady, kFailed };
+
+  PendingProgram() = default;
+  // Starts building |source|, or loads it from |cache| when it holds it.
+  // A built program is stored to |cache|. |cache| may be null and must
+  // outlive the build.
+  PendingProgram(const ProgramSource &source, ProgramBinaryCache *cache);
+  ~PendingProgram();
+  PendingProgram(PendingProgram &&other) noexcept;
+  PendingProgram &operator=(PendingProgram &&other) noexcept;
+  PendingProgram(const PendingProgram &) = delete;
+  PendingProgram &operator=(const PendingProgram &) = delete;
+
+  Status Poll();
+  // Blocks until the build is done.
+  Status Wait();
+
+  // Hands the linked program over to the caller. 0 unless ready.
+  GLuint Release();
+
+  // Compile or link log of a failed build.
+  const std::string &error() const { return error_; }
+  // Whether Poll can tell that the build is done without blocking.
+  bool parallel() const { return parallel_; }
+
+ private:
+  void Finish();
+  void Reset();
+
+  ProgramBinaryCache *cache_ = nullptr;
+  std::string cache_key_;
+  bool parallel_ = false;
+  GLuint program_ = 0;
+  GLuint vertex_shader_ = 0;
+  GLuint fragment_shader_ = 0;
+  Status status_ = Status::kFailed;
+  std::string error_;
+};
+
+}  // namespace bob_ross
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+namespace bob_ross {
+
+// Keeps linked GL programs on disk with glGetProgramBinary, so later runs
+// create them with glProgramBinary instead of compiling GLSL again.
+//
+// Each program is stored in its own file named after the hash of its key.
+// The file also holds the full key and the GL vendor, renderer and version
+// strings of the driver that produced it. A binary is only used when both
+// match, so a hash collision or a driver update is a miss, and storing the
+// rebuilt program replaces the stale file. Drivers may still reject a
+// binary they wrote, in which case the file is removed.
+//
+// Must be created and used with a current GL context. Does nothing when the
+// driver supports no binary formats.
+class ProgramBinaryCache {
+ public:
+  // Binaries are stored in |directory|, which must exist.
+  explicit ProgramBinaryCache(std::string directory);
+
+  // Joins everything a program is built from into a key: its sources and
+  // anything else that changes the linked program, like attribute names
+  // bound before linking.
+  static std::string MakeKey(std::initializer_list<std::string_view> parts);
+
+  bool available() const { return available_; }
+
+  // Returns a linked program created from the binary stored for |key|, or
+  // 0 if there is none the driver accepts.
+  GLuint Load(const std::string &key);
+
+  // Call between creating and linking a program that will be stored.
+  void PrepareForLink(GLuint program) const;
+
+  // Writes the binary of the linked |program| for |key|. Returns false if
+  // the driver or the file system didn't cooperate.
+  bool Store(const std::string &key, GLuint program);
+
+  // Loads since construction.
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  std::string PathFor(const std::string &key) const;
+
+  std::string directory_;
+  // Vendor, renderer and version of the driver, which binaries are only
+  // valid for.
+  std::string driver_;
+  bool available_ = false;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+}  // namespace bob_ross
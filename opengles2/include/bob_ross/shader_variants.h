@@ -0,0 +1,97 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+#include <bob_ross/pending_program.h>
+#include <bob_ross/program_cache.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace bob_ross {
+
+// Flags a program variant is generated from. A solid fill with the vertex
+// color is none of them.
+enum ShaderFeature : uint32_t {
+  // Replaces the vertex color with uTexture sampled at inUV. Can't be
+  // combined with kShaderInstanced.
+  kShaderTextured = 1 << 0,
+  // Replaces the vertex color with a linear gradient from
+  // uGradientStartColor at uGradientLine.xy to uGradientEndColor at
+  // uGradientLine.zw, which modulates the texture when textured.
+  kShaderGradient = 1 << 1,
+  // Antialiases rounded rectangles by their signed distance. Requires
+  // kShaderInstanced.
+  kShaderSdf = 1 << 2,
+  // Draws one rectangle per instance over a unit quad instead of vertices.
+  kShaderInstanced = 1 << 3,
+  // Transforms positions by the frame's projection instead of taking them
+  // in pixels with the origin at the top left.
+  kShaderProjected = 1 << 4,
+};
+
+constexpr uint32_t kShaderFeatureCount = 5;
+
+// Vertex input locations of the generated programs.
+constexpr GLuint kPositionLocation = 0;
+constexpr GLuint kColorLocation = 1;
+constexpr GLuint kUVLocation = 2;
+// Per instance inputs, next to the unit quad corner.
+constexpr GLuint kCornerLocation = 0;
+constexpr GLuint kRectLocation = 1;
+constexpr GLuint kRadiusDepthLocation = 2;
+constexpr GLuint kInstanceColorLocation = 3;
+
+// Generates GL programs from one set of GLSL sources, one per combination
+// of ShaderFeature flags, and keeps them for the lifetime of the context.
+// Features are compiled in with #defines, so every variant only pays for
+// what it uses.
+//
+// All variants take their per-frame constants from the BobRossFrame block
+// bound at FrameUniforms::kBinding, see FrameUniforms. Pixel space
+// variants without instancing also have uPositionScale, which positions
+// are multiplied by and must be set before drawing.
+//
+// Variants build with PendingProgram, so starting several with Prepare
+// lets the driver compile them side by side. Must be created and used with
+// a current GL context.
+class ShaderVariants {
+ public:
+  // |cache| may be null and must outlive the variants.
+  explicit ShaderVariants(ProgramBinaryCache *cache = nullptr);
+  ~ShaderVariants();
+  ShaderVariants(const ShaderVariants &) = delete;
+  ShaderVariants &operator=(const ShaderVariants &) = delete;
+
+  static bool IsValid(uint32_t features);
+  static ProgramSource Source(uint32_t features);
+
+  // Starts building the variant unless it already is. Doesn't block.
+  void Prepare(uint32_t features);
+  // Whether the variant is built, polling its build without blocking
+  // where the driver allows. Starts building it if needed.
+  bool Ready(uint32_t features);
+  // The program of the variant, waiting for its build if needed. 0 if the
+  // features are invalid or the build failed.
+  GLuint Get(uint32_t features);
+  // Whether the variant's features are invalid or its build failed.
+  bool Failed(uint32_t features) const;
+  // Why the variant failed to build, if it did.
+  const std::string &error(uint32_t features) const;
+
+ private:
+  struct Variant {
+    std::unique_ptr<PendingProgram> pending;
+    GLuint program = 0;
+    bool failed = false;
+    std::string error;
+  };
+
+  void Finish(Variant *variant);
+
+  ProgramBinaryCache *cache_;
+  std::array<Variant, 1u << kShaderFeatureCount> variants_;
+};
+
+}  // namespace bob_ross
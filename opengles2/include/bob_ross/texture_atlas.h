@@ -0,0 +1,81 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+#include <bob_ross/skyline_packer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bob_ross {
+
+struct TextureAtlasOptions {
+  // Width and height of every page in pixels.
+  int page_size = 1024;
+  // Last mip level of the pages. Images are aligned to and surrounded by
+  // 2^max_mip_level pixels, so no level up to it blends neighbors.
+  int max_mip_level = 2;
+  // Images wider or taller than this are left to textures of their own.
+  int max_image_size = 256;
+  // Pages created at most. Images that fit in none are refused.
+  int max_pages = 4;
+};
+
+// Where an image ended up in a TextureAtlas.
+struct AtlasRegion {
+  // The page texture, 0 if the image wasn't added.
+  GLuint texture = 0;
+  // Corners of the image in texture coordinates, u0 and v0 at its first
+  // pixel.
+  float u0 = 0, v0 = 0, u1 = 1, v1 = 1;
+};
+
+// Packs small RGBA images into a few large textures, so draws with
+// different images can share a texture binding.
+//
+// Every image is copied into a page with SkylinePacker, inside a gutter of
+// its own edge pixels. Filtering, mipmapped or not, only ever reaches into
+// that gutter, so images look as they would in textures of their own with
+// clamp to edge wrapping. Pages are mipmapped up to max_mip_level, lazily
+// in Flush. Images are never removed, the atlas suits sets loaded together
+// and released together. Must be created and used with a current GL
+// context.
+class TextureAtlas {
+ public:
+  explicit TextureAtlas(const TextureAtlasOptions &options = {});
+  ~TextureAtlas();
+  TextureAtlas(const TextureAtlas &) = delete;
+  TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+  // Copies a |width| by |height| image of RGBA8 pixels with rows |stride|
+  // bytes apart into a page. The region's texture is 0 when the image is
+  // too large or no page has room.
+  AtlasRegion Add(const uint8_t *pixels, int width, int height,
+                  size_t stride);
+
+  // Regenerates the mip levels of pages changed since the last call. Call
+  // before drawing with images added since.
+  void Flush();
+
+  size_t page_count() const { return pages_.size(); }
+  // Fraction of the pages' area covered by images and their gutters.
+  float occupancy() const;
+
+ private:
+  struct Page {
+    GLuint texture;
+    SkylinePacker packer;
+    bool dirty;
+  };
+
+  Page *CreatePage();
+
+  TextureAtlasOptions options_;
+  // Images are aligned to it, and at least this far apart from each other.
+  int gutter_;
+  std::vector<Page> pages_;
+  // Image with its gutter, as uploaded.
+  std::vector<uint8_t> staging_;
+};
+
+}  // namespace bob_ross
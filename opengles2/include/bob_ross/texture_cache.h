@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace bob_ross {
+
+// A texture a TextureCache can hold.
+class CachedTexture {
+ public:
+  virtual ~CachedTexture() = default;
+
+  // GPU memory the texture takes. May change while the texture loads, the
+  // cache asks again whenever it trims.
+  virtual size_t gpu_bytes() const = 0;
+};
+
+// Bytes of a |width| by |height| RGBA8 texture, with all its mip levels
+// when |mipmapped|.
+size_t Rgba8TextureBytes(int width, int height, bool mipmapped = true);
+
+// Where the memory of a TextureCache goes, counted when asked for.
+struct TextureResidency {
+  size_t texture_count = 0;
+  size_t resident_bytes = 0;
+  // Textures also held outside the cache, which can't be evicted.
+  size_t referenced_count = 0;
+  size_t referenced_bytes = 0;
+};
+
+// Shares textures loaded from the same asset, and caps the GPU memory of
+// those no longer used.
+//
+// Textures are keyed by their path and options, whatever else changes the
+// loaded texture, so the same image loaded two ways is two textures. The
+// cache holds a reference to every texture it hands out, one only the
+// cache holds is unreferenced. Unreferenced textures stay cached for the
+// next Get until the cache is over |budget_bytes|, then the least recently
+// used are evicted. Referenced textures are never evicted, the cache stays
+// over budget while they don't fit.
+//
+// Must be used and destroyed with a current GL context, evicting a texture
+// destroys it.
+class TextureCache {
+ public:
+  static constexpr size_t kDefaultBudgetBytes = 64 << 20;
+
+  // Loads a texture on a miss. Returns null on failure.
+  using Loader = std::function<std::shared_ptr<CachedTexture>()>;
+
+  explicit TextureCache(size_t budget_bytes = kDefaultBudgetBytes);
+  TextureCache(const TextureCache &) = delete;
+  TextureCache &operator=(const TextureCache &) = delete;
+
+  // Returns the texture cached for |path| and |options|, or the one
+  // |loader| returns, which is cached unless it is null.
+  std::shared_ptr<CachedTexture> Get(const std::string &path,
+                                     uint32_t options, const Loader &loader);
+
+  // Evicts unreferenced textures until the cache fits its budget. Call
+  // once a frame, textures released or grown since are only accounted for
+  // by it.
+  void Trim();
+  // Trims to |budget_bytes| from now on.
+  void SetBudget(size_t budget_bytes);
+  // Evicts every unreferenced texture, for when memory runs low.
+  void Purge();
+
+  TextureResidency residency() const;
+  size_t budget_bytes() const { return budget_bytes_; }
+  // Since construction, for tuning the budget.
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+  uint64_t evictions() const { return evictions_; }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<CachedTexture> texture;
+  };
+
+  void EvictToBudget(size_t budget_bytes);
+
+  size_t budget_bytes_;
+  uint64_t hits_ = 0, misses_ = 0, evictions_ = 0;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace bob_ross
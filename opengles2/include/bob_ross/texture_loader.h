@@ -0,0 +1,144 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bob_ross {
+
+// An image decoded to RGBA8, rows |stride| bytes apart.
+struct DecodedImage {
+  int width = 0, height = 0;
+  size_t stride = 0;
+  std::vector<uint8_t> pixels;
+};
+
+struct TextureLoaderOptions {
+  // Threads decoding images.
+  int worker_count = 2;
+  // Size of the pixel buffer ring uploads are staged in. Images larger
+  // than it are uploaded in bands of rows over several frames.
+  size_t ring_bytes = 4 << 20;
+  // Bytes staged per Pump at most, so a burst of loads is spread over
+  // frames instead of stalling one.
+  size_t upload_bytes_per_pump = 1 << 20;
+  // RGBA of the 1x1 texture shown until an image is ready.
+  uint8_t placeholder[4] = {128, 128, 128, 255};
+};
+
+// A texture a TextureLoader fills in later. Until it is ready, texture()
+// is the loader's placeholder. Must be destroyed with a current GL context.
+class AsyncTexture {
+ public:
+  enum class Status { kLoading, kReady, kFailed };
+
+  ~AsyncTexture();
+  AsyncTexture(const AsyncTexture &) = delete;
+  AsyncTexture &operator=(const AsyncTexture &) = delete;
+
+  Status status() const { return status_; }
+  bool ready() const { return status_ == Status::kReady; }
+  GLuint texture() const { return ready() ? texture_ : placeholder_; }
+  // 0 until the image is decoded.
+  int width() const { return width_; }
+  int height() const { return height_; }
+
+ private:
+  friend class TextureLoader;
+
+  explicit AsyncTexture(GLuint placeholder) : placeholder_(placeholder) {}
+
+  GLuint placeholder_;
+  GLuint texture_ = 0;
+  int width_ = 0, height_ = 0;
+  Status status_ = Status::kLoading;
+};
+
+// Loads textures without blocking the render thread.
+//
+// Images are decoded on worker threads by a function the caller provides,
+// then staged on the GL thread into a ring of pixel unpack buffer space and
+// copied into their texture by glTexSubImage2D, which the driver can carry
+// out asynchronously. A fence after every upload tells when its part of the
+// ring can be written again, so staging never waits for the GPU and the
+// ring is written without synchronization. Textures turn ready, with mip
+// levels generated, once their last upload's fence has signaled.
+//
+// Create, Pump and destroy with a current GL context. Load may be called
+// from any thread.
+class TextureLoader {
+ public:
+  // Decodes an image on a worker thread. Returns false on failure.
+  using Decoder = std::function<bool(DecodedImage *image)>;
+
+  explicit TextureLoader(const TextureLoaderOptions &options = {});
+  ~TextureLoader();
+  TextureLoader(const TextureLoader &) = delete;
+  TextureLoader &operator=(const TextureLoader &) = delete;
+
+  // Queues |decoder| and returns the texture it fills. Images whose
+  // texture is released before they are decoded or uploaded are dropped.
+  // The loader must outlive the textures, which show its placeholder.
+  std::shared_ptr<AsyncTexture> Load(Decoder decoder);
+
+  // Stages decoded images within the per pump budget and completes
+  // uploads the GPU has finished. Call once a frame. Returns how many
+  // textures turned ready or failed, which may change what is drawn.
+  int Pump();
+
+  GLuint placeholder() const { return placeholder_; }
+  // Images queued, decoding or uploading. Call on the GL thread.
+  size_t pending() const;
+
+ private:
+  struct Job {
+    std::weak_ptr<AsyncTexture> texture;
+    Decoder decoder;
+  };
+  struct Decoded {
+    std::weak_ptr<AsyncTexture> texture;
+    DecodedImage image;
+    bool ok;
+  };
+  // Part of the ring in use by an upload until |fence| signals.
+  struct Upload {
+    size_t begin, end;
+    GLsync fence;
+    // Whether this is the last upload of |texture|.
+    bool last;
+    std::weak_ptr<AsyncTexture> texture;
+  };
+
+  void WorkerLoop();
+  bool Allocate(size_t size, size_t *offset);
+  void Reclaim(int *finished);
+  bool Stage(Decoded *decoded, size_t *budget, int *finished);
+
+  TextureLoaderOptions options_;
+  GLuint placeholder_ = 0;
+  GLuint ring_ = 0;
+  // Uploads in ring order.
+  std::deque<Upload> uploads_;
+  // Decoded images in the order they are staged. The first may be staged
+  // in several bands of rows, |staged_rows_| so far.
+  std::deque<Decoded> staging_;
+  int staged_rows_ = 0;
+
+  std::vector<std::thread> workers_;
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<Job> jobs_;
+  std::deque<Decoded> decoded_;
+  int decoding_ = 0;
+  bool quit_ = false;
+};
+
+}  // namespace bob_ross
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bob_ross {
+
+// GL type of an attribute component.
+template <typename Component>
+struct GlType;
+template <>
+struct GlType<float> {
+  static constexpr GLenum kValue = GL_FLOAT;
+};
+template <>
+struct GlType<int8_t> {
+  static constexpr GLenum kValue = GL_BYTE;
+};
+template <>
+struct GlType<uint8_t> {
+  static constexpr GLenum kValue = GL_UNSIGNED_BYTE;
+};
+template <>
+struct GlType<int16_t> {
+  static constexpr GLenum kValue = GL_SHORT;
+};
+template <>
+struct GlType<uint16_t> {
+  static constexpr GLenum kValue = GL_UNSIGNED_SHORT;
+};
+template <>
+struct GlType<int32_t> {
+  static constexpr GLenum kValue = GL_INT;
+};
+template <>
+struct GlType<uint32_t> {
+  static constexpr GLenum kValue = GL_UNSIGNED_INT;
+};
+
+// One vertex attribute: |Components| values of type |Component| starting
+// |Offset| bytes into the vertex, read by the shader input at |Location|.
+// Integers are converted to floats, mapped to [0, 1] or [-1, 1] when
+// |Normalized|.
+template <GLuint Location, typename Component, GLint Components, size_t Offset,
+          bool Normalized = false>
+struct Attribute {
+  static_assert(Components >= 1 && Components <= 4,
+                "Attributes have one to four components");
+  static_assert(Offset % alignof(Component) == 0,
+                "Attribute offset is misaligned for its component type");
+  static_assert(!Normalized || GlType<Component>::kValue != GL_FLOAT,
+                "Only integer attributes can be normalized");
+
+  static constexpr GLuint kLocation = Location;
+  static constexpr size_t kOffset = Offset;
+  static constexpr size_t kSize = sizeof(Component) * Components;
+
+  // |vertices| is a buffer offset or a client memory address.
+  static void Point(GLsizei stride, uintptr_t vertices) {
+    glVertexAttribPointer(Location, Components, GlType<Component>::kValue,
+                          Normalized ? GL_TRUE : GL_FALSE, stride,
+                          reinterpret_cast<const void *>(vertices + Offset));
+  }
+};
+
+namespace internal {
+
+template <size_t N>
+constexpr bool Distinct(const GLuint (&locations)[N]) {
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = i + 1; j < N; j++) {
+      if (locations[i] == locations[j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Whether no two of the byte ranges [begins[i], ends[i]) intersect.
+template <size_t N>
+constexpr bool Disjoint(const size_t (&begins)[N], const size_t (&ends)[N]) {
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = i + 1; j < N; j++) {
+      if (begins[i] < ends[j] && begins[j] < ends[i]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace internal
+
+// Describes how the attributes of a vertex struct are laid out, so their
+// GL setup is generated from the struct instead of written out by hand.
+// Attributes are checked at compile time to lie within the struct, not to
+// overlap and to use distinct locations. Every call compiles down to the
+// GL calls it stands for.
+//
+// |Divisor| is 0 for per-vertex data and 1 for per-instance data, see
+// VertexLayout and InstanceLayout.
+template <GLuint Divisor, typename Element, typename... Attributes>
+class BasicVertexLayout {
+ public:
+  static constexpr GLsizei kStride = sizeof(Element);
+  static constexpr size_t kAttributeCount = sizeof...(Attributes);
+
+  static_assert(kAttributeCount > 0, "A vertex layout needs attributes");
+  static_assert(
+      ((Attributes::kOffset + Attributes::kSize <= sizeof(Element)) && ...),
+      "Attribute reaches past the end of the vertex");
+  static_assert(
+      internal::Distinct<kAttributeCount>({Attributes::kLocation...}),
+      "Two attributes share a location");
+  static_assert(internal::Disjoint<kAttributeCount>(
+                    {Attributes::kOffset...},
+                    {(Attributes::kOffset + Attributes::kSize)...}),
+                "Two attributes overlap");
+
+  // Enables the attributes on the bound vertex array, with their divisor.
+  static void Enable() { (EnableAttribute(Attributes::kLocation), ...); }
+
+  static void Disable() {
+    (glDisableVertexAttribArray(Attributes::kLocation), ...);
+  }
+
+  // Points the attributes at vertices starting |offset| bytes into the
+  // buffer bound to GL_ARRAY_BUFFER.
+  static void Point(size_t offset) {
+    (Attributes::Point(kStride, offset), ...);
+  }
+
+  // Points the attributes at |vertices| in client memory, which GL only
+  // reads while no GL_ARRAY_BUFFER and no vertex array are bound.
+  static void Point(const void *vertices) {
+    auto address = reinterpret_cast<uintptr_t>(vertices);
+    (Attributes::Point(kStride, address), ...);
+  }
+
+  // Creates a vertex array with the attributes enabled and, if |buffer|
+  // isn't 0, pointing at its start. Leaves no vertex array bound.
+  static GLuint CreateVertexArray(GLuint buffer = 0) {
+    GLuint vertex_array = 0;
+    glGenVertexArrays(1, &vertex_array);
+    glBindVertexArray(vertex_array);
+    Enable();
+    if (buffer) {
+      glBindBuffer(GL_ARRAY_BUFFER, buffer);
+      Point(size_t{0});
+    }
+    glBindVertexArray(0);
+    return vertex_array;
+  }
+
+  // Pairs the shader inputs named |names|, given in attribute order, with
+  // the attribute locations, to bind them before linking. See
+  // ProgramSource.
+  static std::vector<std::pair<GLuint, std::string>> AttribLocations(
+      const char *const (&names)[kAttributeCount]) {
+    const GLuint locations[] = {Attributes::kLocation...};
+    std::vector<std::pair<GLuint, std::string>> pairs;
+    for (size_t i = 0; i < kAttributeCount; i++) {
+      pairs.emplace_back(locations[i], names[i]);
+    }
+    return pairs;
+  }
+
+ private:
+  static void EnableAttribute(GLuint location) {
+    glEnableVertexAttribArray(location);
+    glVertexAttribDivisor(location, Divisor);
+  }
+};
+
+template <typename Element, typename... Attributes>
+using VertexLayout = BasicVertexLayout<0, Element, Attributes...>;
+
+template <typename Element, typename... Attributes>
+using InstanceLayout = BasicVertexLayout<1, Element, Attributes...>;
+
+}  // namespace bob_ross
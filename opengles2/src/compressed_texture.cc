@@ -0,0 +1,103 @@
+#include <bob_ross/compressed_texture.h>
+#include <bob_ross/trace.h>
+
+#include <GLES2/gl2ext.h>
+
+#include <cstring>
+
+namespace bob_ross {
+namespace {
+
+bool HasExtension(const char *name) {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; i++) {
+    auto extension =
+        reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+    if (extension && !std::strcmp(extension, name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+GLenum AstcFormat(GLenum format) {
+  static const bool supported =
+      HasExtension("GL_KHR_texture_compression_astc_ldr");
+  return supported ? format : 0;
+}
+
+}  // namespace
+
+GLenum CompressedTextureFormat(uint32_t format) {
+  switch (format) {
+    case kKtx2Etc2Rgb8:
+      return GL_COMPRESSED_RGB8_ETC2;
+    case kKtx2Etc2Rgb8Srgb:
+      return GL_COMPRESSED_SRGB8_ETC2;
+    case kKtx2Etc2Rgba8:
+      return GL_COMPRESSED_RGBA8_ETC2_EAC;
+    case kKtx2Etc2Rgba8Srgb:
+      return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+    case kKtx2Astc4x4:
+      return AstcFormat(GL_COMPRESSED_RGBA_ASTC_4x4_KHR);
+    case kKtx2Astc4x4Srgb:
+      return AstcFormat(GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR);
+    case kKtx2Astc6x6:
+      return AstcFormat(GL_COMPRESSED_RGBA_ASTC_6x6_KHR);
+    case kKtx2Astc6x6Srgb:
+      return AstcFormat(GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR);
+    case kKtx2Astc8x8:
+      return AstcFormat(GL_COMPRESSED_RGBA_ASTC_8x8_KHR);
+    case kKtx2Astc8x8Srgb:
+      return AstcFormat(GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR);
+    default:
+      return 0;
+  }
+}
+
+GLuint UploadCompressedTexture(const Ktx2Texture &texture,
+                               std::string *error) {
+  BOB_ROSS_TRACE_SCOPE("UploadCompressedTexture");
+  GLenum internal_format = CompressedTextureFormat(texture.format);
+  if (!internal_format) {
+    *error = "Format " + std::to_string(texture.format) + " isn't supported";
+    return 0;
+  }
+  if (texture.levels.empty()) {
+    *error = "No levels";
+    return 0;
+  }
+  // Drain errors left by earlier calls, so they aren't blamed on the upload.
+  while (glGetError() != GL_NO_ERROR) {
+  }
+
+  GLuint id;
+  glGenTextures(1, &id);
+  glBindTexture(GL_TEXTURE_2D, id);
+  // The data comes from client memory, not a bound unpack buffer.
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  for (size_t i = 0; i < texture.levels.size(); i++) {
+    const Ktx2Texture::Level &level = texture.levels[i];
+    glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i),
+                           internal_format, level.width, level.height, 0,
+                           static_cast<GLsizei>(level.size), level.data);
+  }
+  auto max_level = static_cast<GLint>(texture.levels.size() - 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, max_level);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                  max_level ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  GLenum result = glGetError();
+  if (result != GL_NO_ERROR) {
+    glDeleteTextures(1, &id);
+    *error = "glCompressedTexImage2D failed with " + std::to_string(result);
+    return 0;
+  }
+  return id;
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,51 @@
+#include <bob_ross/frame_uniforms.h>
+
+#include <cstring>
+
+namespace bob_ross {
+
+static_assert(sizeof(FrameConstants) == 80,
+              "FrameConstants must match the std140 BobRossFrame block");
+
+FrameUniforms::FrameUniforms() {
+  // Identity until set.
+  for (int i = 0; i < 4; i++) {
+    constants_.projection[i * 5] = 1;
+  }
+  glGenBuffers(1, &buffer_);
+  glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(constants_), nullptr,
+               GL_DYNAMIC_DRAW);
+}
+
+FrameUniforms::~FrameUniforms() { glDeleteBuffers(1, &buffer_); }
+
+void FrameUniforms::SetProjection(const float *matrix) {
+  if (std::memcmp(constants_.projection, matrix,
+                  sizeof(constants_.projection))) {
+    std::memcpy(constants_.projection, matrix, sizeof(constants_.projection));
+    dirty_ = true;
+  }
+}
+
+void FrameUniforms::SetScreenSize(int screen_width, int screen_height) {
+  auto width = static_cast<float>(screen_width);
+  auto height = static_cast<float>(screen_height);
+  if (constants_.screen_size[0] != width ||
+      constants_.screen_size[1] != height) {
+    constants_.screen_size[0] = width;
+    constants_.screen_size[1] = height;
+    dirty_ = true;
+  }
+}
+
+void FrameUniforms::Bind() {
+  if (dirty_) {
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(constants_), &constants_);
+    dirty_ = false;
+  }
+  glBindBufferBase(GL_UNIFORM_BUFFER, kBinding, buffer_);
+}
+
+}  // namespace bob_ross
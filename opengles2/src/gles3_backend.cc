@@ -0,0 +1,383 @@
+#include <bob_ross/gles3_backend.h>
+#include <bob_ross/frame_uniforms.h>
+#include <bob_ross/shader_variants.h>
+#include <bob_ross/trace.h>
+#include <bob_ross/vertex_layout.h>
+
+#include <cstddef>
+
+#include "shape_instance.h"
+#include "stream_buffer.h"
+#include "vertex_format.h"
+
+namespace bob_ross {
+namespace {
+
+// Features of the programs each pipeline draws with.
+constexpr uint32_t kSolidFeatures = 0;
+constexpr uint32_t kShapeFeatures = kShaderInstanced | kShaderSdf;
+
+using MeshLayout = VertexLayout<
+    Vertex, Attribute<kPositionLocation, float, 3, offsetof(Vertex, x)>,
+    Attribute<kColorLocation, uint8_t, 4, offsetof(Vertex, color), true>>;
+
+// z is left to its default of 0.
+using CompactMeshLayout = VertexLayout<
+    CompactVertex,
+    Attribute<kPositionLocation, int16_t, 2, offsetof(CompactVertex, x)>,
+    Attribute<kColorLocation, uint8_t, 4, offsetof(CompactVertex, color),
+              true>>;
+
+struct Corner {
+  float x, y;
+};
+
+using QuadLayout = VertexLayout<
+    Corner, Attribute<kCornerLocation, float, 2, offsetof(Corner, x)>>;
+
+using ShapeInstanceLayout = InstanceLayout<
+    ShapeInstance,
+    Attribute<kRectLocation, float, 4, offsetof(ShapeInstance, center_x)>,
+    Attribute<kRadiusDepthLocation, float, 2,
+              offsetof(ShapeInstance, corner_radius)>,
+    Attribute<kInstanceColorLocation, uint8_t, 4,
+              offsetof(ShapeInstance, color), true>>;
+
+constexpr Corner kUnitQuad[] = {{-1, -1}, {1, -1}, {-1, 1}, {1, 1}};
+
+}  // namespace
+
+Gles3Backend::Gles3Backend() : Gles3Backend(Gles3Options()) {}
+
+Gles3Backend::Gles3Backend(const Gles3Options &options)
+    : options_(options),
+      vertex_buffer_(std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER)),
+      index_buffer_(std::make_unique<StreamBuffer>(GL_ELEMENT_ARRAY_BUFFER)),
+      instance_buffer_(std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER)),
+      tessellation_cache_(options.tessellation_cache_bytes) {
+  shader_variants_ = options_.shader_variants;
+  if (!shader_variants_) {
+    own_shader_variants_ =
+        std::make_unique<ShaderVariants>(options_.program_cache);
+    shader_variants_ = own_shader_variants_.get();
+  }
+  frame_uniforms_ = options_.frame_uniforms;
+  if (!frame_uniforms_) {
+    own_frame_uniforms_ = std::make_unique<FrameUniforms>();
+    frame_uniforms_ = own_frame_uniforms_.get();
+  }
+  // Both programs build while the app goes on starting up. Their status is
+  // only asked for at the first Replay.
+  shader_variants_->Prepare(kSolidFeatures);
+  shader_variants_->Prepare(kShapeFeatures);
+  // Both mesh layouts use the same locations, so either enables them.
+  vertex_array_ = MeshLayout::CreateVertexArray();
+  glGenBuffers(1, &quad_buffer_);
+  glBindBuffer(GL_ARRAY_BUFFER, quad_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(kUnitQuad), kUnitQuad, GL_STATIC_DRAW);
+  instanced_vertex_array_ = QuadLayout::CreateVertexArray(quad_buffer_);
+  glBindVertexArray(instanced_vertex_array_);
+  ShapeInstanceLayout::Enable();
+  glBindVertexArray(0);
+}
+
+Gles3Backend::~Gles3Backend() {
+  glDeleteBuffers(1, &quad_buffer_);
+  glDeleteVertexArrays(1, &instanced_vertex_array_);
+  glDeleteVertexArrays(1, &vertex_array_);
+}
+
+void Gles3Backend::Resize(int screen_width, int screen_height) {
+  screen_width_ = screen_width;
+  screen_height_ = screen_height;
+  frame_uniforms_->SetScreenSize(screen_width, screen_height);
+  draw_sorter_.Resize(screen_width, screen_height);
+}
+
+void Gles3Backend::BeginFrame() {
+  vertex_buffer_->Reset();
+  index_buffer_->Reset();
+  instance_buffer_->Reset();
+  gpu_timer_.Collect();
+  clipped_ = false;
+  draw_calls_ = 0;
+  bytes_uploaded_ = 0;
+}
+
+void Gles3Backend::Replay(const CommandBuffer &commands) {
+  if (!programs_finished_) {
+    FinishPrograms();
+  }
+  if (!program_) {
+    return;
+  }
+  // Tessellation is the time not spent in the nested DrawBatches scope.
+  BOB_ROSS_TRACE_SCOPE("Gles3Backend::Replay");
+  mesh_.Clear();
+  instances_.clear();
+  batches_.clear();
+
+  bool instanced = options_.instanced_shapes;
+  auto solid = static_cast<uint8_t>(Pipeline::kSolid);
+  auto shape = static_cast<uint8_t>(instanced ? Pipeline::kInstancedShape
+                                              : Pipeline::kSolid);
+  // Indexed by CommandType.
+  const uint8_t pipelines[] = {solid, shape, shape, solid, shape, shape};
+  const std::vector<Draw> &draws = draw_sorter_.Sort(
+      commands, options_.reorder_draws ? pipelines : nullptr);
+  for (const Draw &draw : draws) {
+    CommandRef command = draw.command;
+    uint32_t color = draw.color;
+    size_t first_index = mesh_.indices.size();
+    size_t first_vertex = mesh_.vertices.size();
+    switch (command.type) {
+      case CommandType::kSetFillColor:
+        // Folded into the draws by the sorter.
+        continue;
+      case CommandType::kCircle:
+        if (instanced) {
+          instances_.push_back(
+              MakeShapeInstance(command.As<CircleCommand>(), color));
+          AddToBatch(Pipeline::kInstancedShape, instances_.size() - 1, 1);
+          continue;
+        }
+        TessellateCircle(command.As<CircleCommand>(), color,
+                         options_.max_tessellation_error, &mesh_);
+        break;
+      case CommandType::kRect:
+        if (instanced) {
+          instances_.push_back(
+              MakeShapeInstance(command.As<RectCommand>(), color));
+          AddToBatch(Pipeline::kInstancedShape, instances_.size() - 1, 1);
+          continue;
+        }
+        TessellateRect(command.As<RectCommand>(), color, &mesh_);
+        break;
+      case CommandType::kPolygon:
+        tessellation_cache_.TessellatePolygon(command.As<PolygonCommand>(),
+                                              color, &triangulator_, &mesh_);
+        break;
+      case CommandType::kCircles: {
+        const auto &circles = command.As<CirclesCommand>();
+        if (instanced) {
+          AddInstances(circles.circles(), circles.count, color);
+          continue;
+        }
+        for (uint32_t i = 0; i < circles.count; i++) {
+          TessellateCircle(circles.circles()[i], color,
+                           options_.max_tessellation_error, &mesh_);
+        }
+        break;
+      }
+      case CommandType::kRects: {
+        const auto &rects = command.As<RectsCommand>();
+        if (instanced) {
+          AddInstances(rects.rects(), rects.count, color);
+          continue;
+        }
+        for (uint32_t i = 0; i < rects.count; i++) {
+          TessellateRect(rects.rects()[i], color, &mesh_);
+        }
+        break;
+      }
+    }
+    AddToBatch(Pipeline::kSolid, first_index,
+               mesh_.indices.size() - first_index, first_vertex);
+  }
+  DrawBatches();
+}
+
+void Gles3Backend::FinishPrograms() {
+  programs_finished_ = true;
+  program_ = shader_variants_->Get(kSolidFeatures);
+  position_scale_uniform_ = glGetUniformLocation(program_, "uPositionScale");
+  instanced_program_ = shader_variants_->Get(kShapeFeatures);
+  if (!instanced_program_) {
+    options_.instanced_shapes = false;
+  }
+}
+
+void Gles3Backend::SetClipRects(const PixelRect *rects, size_t count) {
+  clip_rects_.assign(rects, rects + count);
+  clipped_ = true;
+}
+
+void Gles3Backend::EndFrame() {}
+
+template <typename Shape>
+void Gles3Backend::AddInstances(const Shape *shapes, uint32_t count,
+                                uint32_t color) {
+  size_t first = instances_.size();
+  instances_.resize(first + count);
+  ShapeInstance *instance = instances_.data() + first;
+  for (uint32_t i = 0; i < count; i++) {
+    *instance++ = MakeShapeInstance(shapes[i], color);
+  }
+  AddToBatch(Pipeline::kInstancedShape, first, count);
+}
+
+void Gles3Backend::AddToBatch(Pipeline pipeline, size_t first, size_t count,
+                              size_t first_vertex) {
+  if (!count) {
+    return;
+  }
+  if (!batches_.empty() && batches_.back().pipeline == pipeline) {
+    batches_.back().count += count;
+  } else {
+    batches_.push_back({pipeline, first, count, first_vertex});
+  }
+}
+
+// Picks the vertex format of every kSolid batch and packs their vertices
+// back to back into packed_vertices_, rebasing each batch's indices to its
+// own first vertex. Returns false, leaving the mesh as is, when no batch
+// fits the compact format. Both loops over vertices are vectorized in
+// vertex_format.cc.
+bool Gles3Backend::PackVertices() {
+  // Batches hold consecutive vertices, so each kSolid batch ends where the
+  // next one starts.
+  size_t end = mesh_.vertices.size();
+  bool any_compact = false;
+  for (auto batch = batches_.rbegin(); batch != batches_.rend(); ++batch) {
+    if (batch->pipeline != Pipeline::kSolid) {
+      continue;
+    }
+    batch->vertex_count = end - batch->first_vertex;
+    end = batch->first_vertex;
+    if (options_.compact_vertices) {
+      batch->subpixels = CompactSubpixels(
+          mesh_.vertices.data() + batch->first_vertex, batch->vertex_count);
+      any_compact |= batch->subpixels != 0;
+    }
+  }
+  if (!any_compact) {
+    return false;
+  }
+
+  packed_vertices_.clear();
+  for (Batch &batch : batches_) {
+    if (batch.pipeline != Pipeline::kSolid) {
+      continue;
+    }
+    size_t count = batch.vertex_count;
+    const Vertex *vertices = mesh_.vertices.data() + batch.first_vertex;
+    size_t offset = packed_vertices_.size();
+    if (batch.subpixels) {
+      packed_vertices_.resize(offset + count * sizeof(CompactVertex));
+      PackCompact(vertices, count, batch.subpixels,
+                  reinterpret_cast<CompactVertex *>(packed_vertices_.data() +
+                                                    offset));
+    } else {
+      auto *bytes = reinterpret_cast<const uint8_t *>(vertices);
+      packed_vertices_.insert(packed_vertices_.end(), bytes,
+                              bytes + count * sizeof(Vertex));
+    }
+    batch.vertex_offset = offset;
+    auto base = static_cast<uint32_t>(batch.first_vertex);
+    uint32_t *indices = mesh_.indices.data() + batch.first;
+    for (size_t i = 0; i < batch.count; i++) {
+      indices[i] -= base;
+    }
+  }
+  return true;
+}
+
+void Gles3Backend::DrawBatches() {
+  if (batches_.empty() || (clipped_ && clip_rects_.empty())) {
+    return;
+  }
+  BOB_ROSS_TRACE_SCOPE("Gles3Backend::DrawBatches");
+  GpuTraceScope gpu_scope(&gpu_timer_, "Gles3Backend::DrawBatches");
+  size_t vertex_offset = 0, index_offset = 0, instance_offset = 0;
+  if (!mesh_.indices.empty()) {
+    const void *vertices = mesh_.vertices.data();
+    size_t vertex_bytes = mesh_.vertices.size() * sizeof(Vertex);
+    if (PackVertices()) {
+      vertices = packed_vertices_.data();
+      vertex_bytes = packed_vertices_.size();
+    }
+    size_t index_bytes = mesh_.indices.size() * sizeof(uint32_t);
+    vertex_offset = vertex_buffer_->Append(vertices, vertex_bytes);
+    // The element buffer binding is part of the vertex array.
+    glBindVertexArray(vertex_array_);
+    index_offset = index_buffer_->Append(mesh_.indices.data(), index_bytes);
+    bytes_uploaded_ += vertex_bytes + index_bytes;
+  }
+  if (!instances_.empty()) {
+    size_t instance_bytes = instances_.size() * sizeof(ShapeInstance);
+    instance_offset = instance_buffer_->Append(instances_.data(),
+                                               instance_bytes);
+    bytes_uploaded_ += instance_bytes;
+  }
+
+  frame_uniforms_->Bind();
+  // Colors are straight alpha, and the antialiased edges of instanced
+  // shapes only blend with this. Left enabled for the app's own drawing.
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  if (!clipped_) {
+    IssueBatches(vertex_offset, index_offset, instance_offset);
+    return;
+  }
+  // The clip rectangles are disjoint, so drawing everything once per
+  // rectangle blends no pixel twice.
+  glEnable(GL_SCISSOR_TEST);
+  for (const PixelRect &rect : clip_rects_) {
+    glScissor(rect.left, screen_height_ - rect.bottom, rect.right - rect.left,
+              rect.bottom - rect.top);
+    IssueBatches(vertex_offset, index_offset, instance_offset);
+  }
+  glDisable(GL_SCISSOR_TEST);
+}
+
+void Gles3Backend::IssueBatches(size_t vertex_offset, size_t index_offset,
+                                size_t instance_offset) {
+  Pipeline bound = Pipeline::kSolid;
+  bool any_bound = false;
+  for (const Batch &batch : batches_) {
+    if (!any_bound || batch.pipeline != bound) {
+      bound = batch.pipeline;
+      any_bound = true;
+      bool solid = bound == Pipeline::kSolid;
+      glUseProgram(solid ? program_ : instanced_program_);
+      glBindVertexArray(solid ? vertex_array_ : instanced_vertex_array_);
+    }
+    if (bound == Pipeline::kSolid) {
+      SetupMeshAttributes(vertex_offset + batch.vertex_offset,
+                          batch.subpixels);
+      glUniform1f(position_scale_uniform_,
+                  batch.subpixels ? 1.0f / batch.subpixels : 1.0f);
+      glDrawElements(
+          GL_TRIANGLES, batch.count, GL_UNSIGNED_INT,
+          reinterpret_cast<void *>(index_offset +
+                                   batch.first * sizeof(uint32_t)));
+    } else {
+      // GLES3 has no base instance, so point the per-instance attributes at
+      // the batch instead.
+      SetupInstanceAttributes(instance_offset +
+                              batch.first * sizeof(ShapeInstance));
+      glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, batch.count);
+    }
+    draw_calls_++;
+  }
+  glBindVertexArray(0);
+}
+
+// Indices are relative to the first vertex of their batch, so point the
+// attributes at that vertex instead of rebasing every index. Compact
+// positions are integers scaled by uPositionScale.
+void Gles3Backend::SetupMeshAttributes(size_t vertex_offset, int subpixels) {
+  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_->id());
+  if (subpixels) {
+    CompactMeshLayout::Point(vertex_offset);
+  } else {
+    MeshLayout::Point(vertex_offset);
+  }
+}
+
+void Gles3Backend::SetupInstanceAttributes(size_t instance_offset) {
+  glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_->id());
+  ShapeInstanceLayout::Point(instance_offset);
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,106 @@
+#include <bob_ross/gpu_timer.h>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+#include <bob_ross/trace.h>
+
+#include <cstring>
+
+namespace bob_ross {
+namespace {
+
+// Queries beyond this are dropped instead of piling up when nothing
+// collects them.
+constexpr size_t kMaxPendingQueries = 64;
+
+PFNGLGETQUERYOBJECTUI64VEXTPROC get_query_object_ui64v = nullptr;
+
+bool HasExtension(const char *name) {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; i++) {
+    auto extension =
+        reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+    if (extension && !std::strcmp(extension, name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+GpuTimer::GpuTimer() {
+  if (!HasExtension("GL_EXT_disjoint_timer_query")) {
+    return;
+  }
+  get_query_object_ui64v = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(
+      eglGetProcAddress("glGetQueryObjectui64vEXT"));
+  available_ = get_query_object_ui64v != nullptr;
+}
+
+GpuTimer::~GpuTimer() {
+  for (const Pending &pending : pending_) {
+    free_queries_.push_back(pending.query);
+  }
+  if (!free_queries_.empty()) {
+    glDeleteQueries(free_queries_.size(), free_queries_.data());
+  }
+}
+
+void GpuTimer::Begin(const char *name) {
+  if (!available_ || open_ || !Tracer::enabled() ||
+      pending_.size() >= kMaxPendingQueries) {
+    return;
+  }
+  GLuint query;
+  if (free_queries_.empty()) {
+    glGenQueries(1, &query);
+  } else {
+    query = free_queries_.back();
+    free_queries_.pop_back();
+  }
+  glBeginQuery(GL_TIME_ELAPSED_EXT, query);
+  pending_.push_back({query, name, Tracer::NowNs()});
+  open_ = true;
+}
+
+void GpuTimer::End() {
+  if (!open_) {
+    return;
+  }
+  glEndQuery(GL_TIME_ELAPSED_EXT);
+  open_ = false;
+}
+
+void GpuTimer::Collect() {
+  if (!available_) {
+    return;
+  }
+  GLint disjoint = 0;
+  glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+  // Queries finish in order, so stop at the first one still running. The
+  // open one is never waited for.
+  size_t finished = pending_.size() - (open_ ? 1 : 0);
+  for (; finished; finished--) {
+    const Pending &pending = pending_.front();
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      break;
+    }
+    GLuint64 elapsed_ns = 0;
+    get_query_object_ui64v(pending.query, GL_QUERY_RESULT, &elapsed_ns);
+    // A disjoint operation such as a frequency change makes the results of
+    // queries in flight meaningless.
+    if (!disjoint && Tracer::enabled()) {
+      Tracer::Get().Record(pending.name, pending.start_ns,
+                           static_cast<int64_t>(elapsed_ns),
+                           Tracer::kGpuTrack);
+    }
+    free_queries_.push_back(pending.query);
+    pending_.pop_front();
+  }
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,167 @@
+#include <bob_ross/headless_context.h>
+
+#include <EGL/eglext.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace bob_ross {
+namespace {
+
+bool HasExtension(const char *extensions, const char *name) {
+  if (!extensions) {
+    return false;
+  }
+  size_t length = std::strlen(name);
+  for (const char *start = extensions;
+       (start = std::strstr(start, name)) != nullptr; start += length) {
+    bool starts = start == extensions || start[-1] == ' ';
+    bool ends = start[length] == ' ' || start[length] == '\0';
+    if (starts && ends) {
+      return true;
+    }
+  }
+  return false;
+}
+
+EGLDisplay OpenDisplay() {
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+  const char *client_extensions =
+      eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if (HasExtension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+    auto get_platform_display =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (get_platform_display) {
+      EGLDisplay display = get_platform_display(
+          EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+      if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+        return display;
+      }
+    }
+  }
+#endif
+  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr)) {
+    return display;
+  }
+  return EGL_NO_DISPLAY;
+}
+
+}  // namespace
+
+std::unique_ptr<HeadlessContext> HeadlessContext::Create(int width,
+                                                         int height) {
+  EGLDisplay display = OpenDisplay();
+  if (display == EGL_NO_DISPLAY) {
+    return nullptr;
+  }
+  std::unique_ptr<HeadlessContext> context(new HeadlessContext());
+  context->display_ = display;
+  eglBindAPI(EGL_OPENGL_ES_API);
+
+  const char *extensions = eglQueryString(display, EGL_EXTENSIONS);
+  bool surfaceless = HasExtension(extensions, "EGL_KHR_surfaceless_context");
+
+  constexpr EGLint attribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+                                EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+                                EGL_NONE};
+  EGLConfig config = nullptr;
+  EGLint config_count = 0;
+  eglChooseConfig(display, attribs, &config, 1, &config_count);
+  if (!config_count) {
+    // Surfaceless platforms may expose no configs at all.
+    if (!surfaceless ||
+        !HasExtension(extensions, "EGL_KHR_no_config_context")) {
+      return nullptr;
+    }
+    config = EGL_NO_CONFIG_KHR;
+  }
+
+  constexpr EGLint context_attribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3,
+                                        EGL_NONE};
+  context->context_ =
+      eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+  if (context->context_ == EGL_NO_CONTEXT) {
+    return nullptr;
+  }
+  if (!surfaceless) {
+    constexpr EGLint pbuffer_attribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1,
+                                          EGL_NONE};
+    context->surface_ =
+        eglCreatePbufferSurface(display, config, pbuffer_attribs);
+    if (context->surface_ == EGL_NO_SURFACE) {
+      return nullptr;
+    }
+  }
+  if (!eglMakeCurrent(display, context->surface_, context->surface_,
+                      context->context_)) {
+    return nullptr;
+  }
+
+  glGenFramebuffers(1, &context->framebuffer_);
+  glGenRenderbuffers(1, &context->color_buffer_);
+  glGenRenderbuffers(1, &context->depth_buffer_);
+  context->Resize(width, height);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    return nullptr;
+  }
+  return context;
+}
+
+HeadlessContext::~HeadlessContext() {
+  if (context_ != EGL_NO_CONTEXT) {
+    MakeCurrent();
+    glDeleteRenderbuffers(1, &depth_buffer_);
+    glDeleteRenderbuffers(1, &color_buffer_);
+    glDeleteFramebuffers(1, &framebuffer_);
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display_, context_);
+  }
+  if (surface_ != EGL_NO_SURFACE) {
+    eglDestroySurface(display_, surface_);
+  }
+  eglTerminate(display_);
+}
+
+void HeadlessContext::Resize(int width, int height) {
+  width_ = std::max(width, 1);
+  height_ = std::max(height, 1);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  glBindRenderbuffer(GL_RENDERBUFFER, color_buffer_);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, color_buffer_);
+  glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer_);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width_,
+                        height_);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                            GL_RENDERBUFFER, depth_buffer_);
+  glViewport(0, 0, width_, height_);
+}
+
+void HeadlessContext::MakeCurrent() const {
+  eglMakeCurrent(display_, surface_, surface_, context_);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+}
+
+void HeadlessContext::ReadPixels(std::vector<uint32_t> *pixels) const {
+  pixels->resize(static_cast<size_t>(width_) * height_);
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE,
+               pixels->data());
+  // GL's origin is the bottom left, BobRoss' the top left.
+  for (int y = 0; y < height_ / 2; y++) {
+    std::swap_ranges(pixels->begin() + static_cast<size_t>(y) * width_,
+                     pixels->begin() + static_cast<size_t>(y + 1) * width_,
+                     pixels->begin() +
+                         static_cast<size_t>(height_ - 1 - y) * width_);
+  }
+}
+
+const char *HeadlessContext::renderer() const {
+  return reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+}
+
+}  // namespace bob_ross
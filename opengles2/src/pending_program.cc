@@ -0,0 +1,197 @@
+#include <bob_ross/pending_program.h>
+#include <bob_ross/trace.h>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+
+#include <cstring>
+
+namespace bob_ross {
+namespace {
+
+bool HasExtension(const char *name) {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; i++) {
+    auto extension =
+        reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+    if (extension && !std::strcmp(extension, name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+GLuint StartShader(GLenum type, const std::string &source) {
+  GLuint shader = glCreateShader(type);
+  const char *text = source.c_str();
+  auto length = static_cast<GLint>(source.size());
+  glShaderSource(shader, 1, &text, &length);
+  glCompileShader(shader);
+  return shader;
+}
+
+std::string ShaderLog(GLuint shader) {
+  GLint length = 0;
+  glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+  std::string log(length > 0 ? length : 0, '\0');
+  if (length > 0) {
+    glGetShaderInfoLog(shader, length, nullptr, &log[0]);
+    log.resize(length - 1);
+  }
+  return log;
+}
+
+std::string ProgramLog(GLuint program) {
+  GLint length = 0;
+  glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+  std::string log(length > 0 ? length : 0, '\0');
+  if (length > 0) {
+    glGetProgramInfoLog(program, length, nullptr, &log[0]);
+    log.resize(length - 1);
+  }
+  return log;
+}
+
+// Returns whether the driver has KHR_parallel_shader_compile.
+bool EnableParallelCompile() {
+  if (!HasExtension("GL_KHR_parallel_shader_compile")) {
+    return false;
+  }
+  // Drivers may default to compiling on the calling thread. The setting
+  // belongs to the context, so it is made again for every program.
+  auto max_shader_compiler_threads =
+      reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(
+          eglGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+  if (max_shader_compiler_threads) {
+    max_shader_compiler_threads(0xffffffffu);
+  }
+  return true;
+}
+
+}  // namespace
+
+PendingProgram::PendingProgram(const ProgramSource &source,
+                               ProgramBinaryCache *cache)
+    : cache_(cache), parallel_(EnableParallelCompile()) {
+  BOB_ROSS_TRACE_SCOPE("PendingProgram::PendingProgram");
+  if (cache_) {
+    // The attribute bindings are part of the linked program.
+    std::string locations;
+    for (const auto &[location, name] : source.attribute_locations) {
+      locations += std::to_string(location) + ' ' + name + '\n';
+    }
+    cache_key_ = ProgramBinaryCache::MakeKey(
+        {source.vertex, source.fragment, locations});
+    program_ = cache_->Load(cache_key_);
+    if (program_) {
+      status_ = Status::kReady;
+      return;
+    }
+  }
+  vertex_shader_ = StartShader(GL_VERTEX_SHADER, source.vertex);
+  fragment_shader_ = StartShader(GL_FRAGMENT_SHADER, source.fragment);
+  program_ = glCreateProgram();
+  glAttachShader(program_, vertex_shader_);
+  glAttachShader(program_, fragment_shader_);
+  for (const auto &[location, name] : source.attribute_locations) {
+    glBindAttribLocation(program_, location, name.c_str());
+  }
+  if (cache_) {
+    cache_->PrepareForLink(program_);
+  }
+  // Linking right away lets the driver compile and link in one go. A
+  // failed compile shows up as a failed link.
+  glLinkProgram(program_);
+  status_ = Status::kCompiling;
+}
+
+PendingProgram::~PendingProgram() { Reset(); }
+
+PendingProgram::PendingProgram(PendingProgram &&other) noexcept {
+  *this = std::move(other);
+}
+
+PendingProgram &PendingProgram::operator=(PendingProgram &&other) noexcept {
+  if (this != &other) {
+    Reset();
+    cache_ = other.cache_;
+    cache_key_ = std::move(other.cache_key_);
+    parallel_ = other.parallel_;
+    program_ = std::exchange(other.program_, 0);
+    vertex_shader_ = std::exchange(other.vertex_shader_, 0);
+    fragment_shader_ = std::exchange(other.fragment_shader_, 0);
+    status_ = std::exchange(other.status_, Status::kFailed);
+    error_ = std::move(other.error_);
+  }
+  return *this;
+}
+
+PendingProgram::Status PendingProgram::Poll() {
+  if (status_ != Status::kCompiling) {
+    return status_;
+  }
+  if (parallel_) {
+    GLint done = GL_FALSE;
+    glGetProgramiv(program_, GL_COMPLETION_STATUS_KHR, &done);
+    if (!done) {
+      return status_;
+    }
+  }
+  Finish();
+  return status_;
+}
+
+PendingProgram::Status PendingProgram::Wait() {
+  if (status_ == Status::kCompiling) {
+    Finish();
+  }
+  return status_;
+}
+
+GLuint PendingProgram::Release() {
+  if (status_ != Status::kReady) {
+    return 0;
+  }
+  status_ = Status::kFailed;
+  return std::exchange(program_, 0);
+}
+
+void PendingProgram::Finish() {
+  BOB_ROSS_TRACE_SCOPE("PendingProgram::Finish");
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program_, GL_LINK_STATUS, &linked);
+  if (linked) {
+    status_ = Status::kReady;
+    if (cache_) {
+      cache_->Store(cache_key_, program_);
+    }
+  } else {
+    status_ = Status::kFailed;
+    // The link log rarely says more than that a shader didn't compile.
+    for (GLuint shader : {vertex_shader_, fragment_shader_}) {
+      GLint compiled = GL_FALSE;
+      glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+      if (!compiled) {
+        error_ += ShaderLog(shader);
+      }
+    }
+    if (error_.empty()) {
+      error_ = ProgramLog(program_);
+    }
+    glDeleteProgram(program_);
+    program_ = 0;
+  }
+  glDeleteShader(vertex_shader_);
+  glDeleteShader(fragment_shader_);
+  vertex_shader_ = fragment_shader_ = 0;
+}
+
+void PendingProgram::Reset() {
+  glDeleteShader(vertex_shader_);
+  glDeleteShader(fragment_shader_);
+  glDeleteProgram(program_);
+  vertex_shader_ = fragment_shader_ = program_ = 0;
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,206 @@
+#include <bob_ross/program_cache.h>
+#include <bob_ross/trace.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+constexpr uint32_t kMagic = 0x42525042;  // "BPRB" in little endian.
+constexpr uint32_t kFormatVersion = 1;
+
+uint64_t Hash(const void *data, size_t size) {
+  uint64_t hash = kFnvOffset;
+  auto *bytes = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+// Followed by the key, the driver string and the binary. Files are only
+// read on the device that wrote them, so fields are in native byte order.
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t key_size;
+  uint32_t driver_size;
+  uint32_t binary_format;
+  uint32_t binary_size;
+  // Of the binary, to catch truncated or corrupted files before handing
+  // them to the driver.
+  uint64_t checksum;
+};
+
+struct FileCloser {
+  void operator()(FILE *file) const { std::fclose(file); }
+};
+using File = std::unique_ptr<FILE, FileCloser>;
+
+bool ReadString(FILE *file, size_t size, std::string *out) {
+  out->resize(size);
+  return std::fread(&(*out)[0], 1, size, file) == size;
+}
+
+// Bytes from the current position to the end of |file|, or 0 if unknown.
+size_t RemainingBytes(FILE *file) {
+  long position = std::ftell(file);
+  if (position < 0 || std::fseek(file, 0, SEEK_END)) {
+    return 0;
+  }
+  long end = std::ftell(file);
+  if (end < position || std::fseek(file, position, SEEK_SET)) {
+    return 0;
+  }
+  return static_cast<size_t>(end - position);
+}
+
+std::string GlString(GLenum name) {
+  auto *value = reinterpret_cast<const char *>(glGetString(name));
+  return value ? value : "";
+}
+
+}  // namespace
+
+ProgramBinaryCache::ProgramBinaryCache(std::string directory)
+    : directory_(std::move(directory)) {
+  GLint formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  available_ = formats > 0;
+  driver_ = GlString(GL_VENDOR) + '\n' + GlString(GL_RENDERER) + '\n' +
+            GlString(GL_VERSION);
+}
+
+std::string ProgramBinaryCache::MakeKey(
+    std::initializer_list<std::string_view> parts) {
+  // GLSL sources and identifiers can't contain NUL, so joining with it is
+  // unambiguous.
+  std::string key;
+  for (std::string_view part : parts) {
+    key.append(part.data(), part.size());
+    key += '\0';
+  }
+  return key;
+}
+
+GLuint ProgramBinaryCache::Load(const std::string &key) {
+  if (!available_) {
+    return 0;
+  }
+  BOB_ROSS_TRACE_SCOPE("ProgramBinaryCache::Load");
+  std::string path = PathFor(key);
+  File file(std::fopen(path.c_str(), "rb"));
+  FileHeader header;
+  std::string stored_key, stored_driver;
+  std::vector<uint8_t> binary;
+  bool valid = file &&
+               std::fread(&header, sizeof(header), 1, file.get()) == 1 &&
+               header.magic == kMagic && header.version == kFormatVersion &&
+               header.key_size == key.size() &&
+               header.driver_size == driver_.size() &&
+               ReadString(file.get(), header.key_size, &stored_key) &&
+               stored_key == key &&
+               ReadString(file.get(), header.driver_size, &stored_driver) &&
+               stored_driver == driver_;
+  // The size is checked against the file before allocating, so a corrupt
+  // header can't ask for gigabytes.
+  if (valid && header.binary_size <= RemainingBytes(file.get())) {
+    binary.resize(header.binary_size);
+    valid = std::fread(binary.data(), 1, binary.size(), file.get()) ==
+                binary.size() &&
+            Hash(binary.data(), binary.size()) == header.checksum;
+  } else {
+    valid = false;
+  }
+  file.reset();
+  if (!valid) {
+    // Anything stored for another key or driver is overwritten by the
+    // Store that follows the miss.
+    misses_++;
+    return 0;
+  }
+
+  GLuint program = glCreateProgram();
+  glProgramBinary(program, header.binary_format, binary.data(),
+                  static_cast<GLsizei>(binary.size()));
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (!linked) {
+    glDeleteProgram(program);
+    std::remove(path.c_str());
+    misses_++;
+    return 0;
+  }
+  hits_++;
+  return program;
+}
+
+void ProgramBinaryCache::PrepareForLink(GLuint program) const {
+  if (available_) {
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+}
+
+bool ProgramBinaryCache::Store(const std::string &key, GLuint program) {
+  if (!available_) {
+    return false;
+  }
+  BOB_ROSS_TRACE_SCOPE("ProgramBinaryCache::Store");
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) {
+    return false;
+  }
+  std::vector<uint8_t> binary(static_cast<size_t>(length));
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &length, &format, binary.data());
+  binary.resize(static_cast<size_t>(length));
+  if (binary.empty()) {
+    return false;
+  }
+
+  FileHeader header = {kMagic,
+                       kFormatVersion,
+                       static_cast<uint32_t>(key.size()),
+                       static_cast<uint32_t>(driver_.size()),
+                       format,
+                       static_cast<uint32_t>(binary.size()),
+                       Hash(binary.data(), binary.size())};
+  // Written next to the final file and renamed over it, so a crash midway
+  // never leaves a partial file under the real name.
+  std::string path = PathFor(key);
+  std::string temporary_path = path + ".tmp";
+  File file(std::fopen(temporary_path.c_str(), "wb"));
+  if (!file) {
+    return false;
+  }
+  bool written =
+      std::fwrite(&header, sizeof(header), 1, file.get()) == 1 &&
+      std::fwrite(key.data(), 1, key.size(), file.get()) == key.size() &&
+      std::fwrite(driver_.data(), 1, driver_.size(), file.get()) ==
+          driver_.size() &&
+      std::fwrite(binary.data(), 1, binary.size(), file.get()) ==
+          binary.size();
+  written = std::fclose(file.release()) == 0 && written;
+  if (!written || std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    std::remove(temporary_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::string ProgramBinaryCache::PathFor(const std::string &key) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "program_%016" PRIx64 ".bin",
+                Hash(key.data(), key.size()));
+  return directory_ + '/' + name;
+}
+
+}  // namespace bob_ross
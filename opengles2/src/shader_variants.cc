@@ -0,0 +1,231 @@
+#include <bob_ross/frame_uniforms.h>
+#include <bob_ross/shader_variants.h>
+
+#include <string>
+
+namespace bob_ross {
+namespace {
+
+// Prepended to both stages. The version line has to come first.
+std::string Preamble(uint32_t features) {
+  std::string preamble = "#version 300 es\n";
+  const char *names[] = {"TEXTURED", "GRADIENT", "SDF", "INSTANCED",
+                         "PROJECTED"};
+  static_assert(sizeof(names) / sizeof(names[0]) == kShaderFeatureCount,
+                "Every feature needs a define");
+  for (uint32_t i = 0; i < kShaderFeatureCount; i++) {
+    if (features & (1u << i)) {
+      preamble += std::string("#define ") + names[i] + "\n";
+    }
+  }
+  return preamble;
+}
+
+// Only the vertex stage reads it, so its precision can't disagree with the
+// fragment stage's.
+const char *kFrameBlock = R"glsl(
+layout(std140) uniform BobRossFrame {
+    mat4 uProjection;
+    vec2 uScreenSize;
+};
+)glsl";
+
+const char *kVertexShader = R"vertex(
+#ifdef INSTANCED
+layout(location = 0) in vec2 inCorner;
+layout(location = 1) in vec4 inRect;
+layout(location = 2) in vec2 inRadiusDepth;
+layout(location = 3) in vec4 inColor;
+#else
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+#endif
+#ifdef TEXTURED
+layout(location = 2) in vec2 inUV;
+out vec2 fragUV;
+#endif
+#if !defined(INSTANCED) && !defined(PROJECTED)
+// 1 for float positions, one over the subpixel steps for fixed point ones.
+uniform float uPositionScale;
+#endif
+#ifdef SDF
+out vec2 fragLocal;
+out vec2 fragHalfExtent;
+out float fragRadius;
+#endif
+#ifdef GRADIENT
+out vec2 fragPosition;
+#endif
+
+out vec4 fragColor;
+
+void main() {
+#ifdef INSTANCED
+    // The quad is padded by a pixel so the antialiased edge isn't clipped.
+    vec2 local = inCorner * (inRect.zw + 1.0);
+    vec3 position = vec3(inRect.xy + local, inRadiusDepth.y);
+#elif defined(PROJECTED)
+    vec3 position = inPosition;
+#else
+    vec3 position = vec3(inPosition.xy * uPositionScale, inPosition.z);
+#endif
+#ifdef PROJECTED
+    gl_Position = uProjection * vec4(position, 1.0);
+#else
+    // z is a layer BobRoss already drew in order, not a depth, and may be
+    // any float. Passing it on would clip shapes outside [-1, 1].
+    vec2 ndc = position.xy / uScreenSize * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+#endif
+    fragColor = inColor;
+#ifdef TEXTURED
+    fragUV = inUV;
+#endif
+#ifdef SDF
+    fragLocal = local;
+    fragHalfExtent = inRect.zw;
+    fragRadius = inRadiusDepth.x;
+#endif
+#ifdef GRADIENT
+    fragPosition = position.xy;
+#endif
+}
+)vertex";
+
+const char *kFragmentShader = R"fragment(
+in vec4 fragColor;
+#ifdef TEXTURED
+in vec2 fragUV;
+uniform sampler2D uTexture;
+#endif
+#ifdef SDF
+// Pixel distances on large shapes need more than mediump's 11 bits.
+in highp vec2 fragLocal;
+in highp vec2 fragHalfExtent;
+in highp float fragRadius;
+#endif
+#ifdef GRADIENT
+in vec2 fragPosition;
+uniform vec4 uGradientLine;
+uniform vec4 uGradientStartColor;
+uniform vec4 uGradientEndColor;
+#endif
+
+out vec4 outColor;
+
+void main() {
+    vec4 color = fragColor;
+#ifdef GRADIENT
+    vec2 axis = uGradientLine.zw - uGradientLine.xy;
+    float t = clamp(dot(fragPosition - uGradientLine.xy, axis) /
+                    dot(axis, axis), 0.0, 1.0);
+    color = mix(uGradientStartColor, uGradientEndColor, t);
+#endif
+#if defined(TEXTURED) && defined(GRADIENT)
+    color *= texture(uTexture, fragUV);
+#elif defined(TEXTURED)
+    color = texture(uTexture, fragUV);
+#endif
+#ifdef SDF
+    highp vec2 q = abs(fragLocal) - fragHalfExtent + fragRadius;
+    highp float distance = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - fragRadius;
+    float coverage = clamp(0.5 - distance, 0.0, 1.0);
+    if (coverage <= 0.0) {
+        discard;
+    }
+    color.a *= coverage;
+#endif
+    outColor = color;
+}
+)fragment";
+
+}  // namespace
+
+ShaderVariants::ShaderVariants(ProgramBinaryCache *cache) : cache_(cache) {}
+
+ShaderVariants::~ShaderVariants() {
+  for (Variant &variant : variants_) {
+    glDeleteProgram(variant.program);
+  }
+}
+
+bool ShaderVariants::IsValid(uint32_t features) {
+  if (features >> kShaderFeatureCount) {
+    return false;
+  }
+  bool instanced = features & kShaderInstanced;
+  // Instances have no UVs, and the signed distance needs the instance's
+  // rectangle.
+  return !(instanced && (features & kShaderTextured)) &&
+         !(!instanced && (features & kShaderSdf));
+}
+
+ProgramSource ShaderVariants::Source(uint32_t features) {
+  std::string preamble = Preamble(features);
+  return {preamble + kFrameBlock + kVertexShader,
+          preamble + "precision mediump float;\n" + kFragmentShader,
+          {}};
+}
+
+void ShaderVariants::Prepare(uint32_t features) {
+  if (!IsValid(features)) {
+    return;
+  }
+  Variant &variant = variants_[features];
+  if (!variant.program && !variant.failed && !variant.pending) {
+    variant.pending =
+        std::make_unique<PendingProgram>(Source(features), cache_);
+  }
+}
+
+bool ShaderVariants::Ready(uint32_t features) {
+  Prepare(features);
+  if (!IsValid(features)) {
+    return false;
+  }
+  Variant &variant = variants_[features];
+  if (variant.pending &&
+      variant.pending->Poll() != PendingProgram::Status::kCompiling) {
+    Finish(&variant);
+  }
+  return variant.program != 0;
+}
+
+GLuint ShaderVariants::Get(uint32_t features) {
+  Prepare(features);
+  if (!IsValid(features)) {
+    return 0;
+  }
+  Variant &variant = variants_[features];
+  if (variant.pending) {
+    variant.pending->Wait();
+    Finish(&variant);
+  }
+  return variant.program;
+}
+
+bool ShaderVariants::Failed(uint32_t features) const {
+  return !IsValid(features) || variants_[features].failed;
+}
+
+const std::string &ShaderVariants::error(uint32_t features) const {
+  static const std::string kInvalid = "Invalid shader features";
+  return IsValid(features) ? variants_[features].error : kInvalid;
+}
+
+void ShaderVariants::Finish(Variant *variant) {
+  variant->program = variant->pending->Release();
+  variant->failed = !variant->program;
+  variant->error = variant->pending->error();
+  variant->pending.reset();
+  if (variant->program) {
+    // Block bindings aren't part of program binaries, so they are set on
+    // every load.
+    GLuint block = glGetUniformBlockIndex(variant->program, "BobRossFrame");
+    if (block != GL_INVALID_INDEX) {
+      glUniformBlockBinding(variant->program, block, FrameUniforms::kBinding);
+    }
+  }
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <bob_ross/types.h>
+
+#include <cmath>
+#include <cstdint>
+
+namespace bob_ross {
+
+// Per-instance record for the instanced Rect/Circle path. Both shapes are
+// rounded rectangles: a rect has no corner radius and a circle's corner
+// radius equals its half extent. The fragment shader evaluates the signed
+// distance to the shape over a unit quad.
+struct ShapeInstance {
+  float center_x, center_y;
+  float half_width, half_height;
+  float corner_radius;
+  float z;
+  uint32_t color;
+};
+
+inline ShapeInstance MakeShapeInstance(const RectInstance &rect,
+                                       uint32_t color) {
+  const Point &tl = rect.top_left;
+  const Point &br = rect.bottom_right;
+  return {(tl.x + br.x) * 0.5f,
+          (tl.y + br.y) * 0.5f,
+          std::fabs(br.x - tl.x) * 0.5f,
+          std::fabs(br.y - tl.y) * 0.5f,
+          0.0f,
+          tl.z,
+          color};
+}
+
+inline ShapeInstance MakeShapeInstance(const CircleInstance &circle,
+                                       uint32_t color) {
+  float radius = std::fabs(circle.radius);
+  return {circle.origin.x, circle.origin.y, radius, radius, radius,
+          circle.origin.z, color};
+}
+
+}  // namespace bob_ross
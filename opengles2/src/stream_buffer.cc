@@ -0,0 +1,42 @@
+#include "stream_buffer.h"
+
+#include <algorithm>
+
+namespace bob_ross {
+namespace {
+
+constexpr size_t kInitialCapacity = 256 * 1024;
+
+}  // namespace
+
+StreamBuffer::StreamBuffer(GLenum target) : target_(target) {
+  glGenBuffers(1, &buffer_);
+}
+
+StreamBuffer::~StreamBuffer() { glDeleteBuffers(1, &buffer_); }
+
+void StreamBuffer::Reset() {
+  if (capacity_) {
+    glBindBuffer(target_, buffer_);
+    glBufferData(target_, capacity_, nullptr, GL_STREAM_DRAW);
+  }
+  size_ = 0;
+}
+
+size_t StreamBuffer::Append(const void *data, size_t size) {
+  glBindBuffer(target_, buffer_);
+  if (size_ + size > capacity_) {
+    // Draws already issued keep their copy of the old storage, so growing
+    // mid-frame only needs to restart at offset zero.
+    capacity_ = std::max({capacity_ * 2, size, kInitialCapacity});
+    glBufferData(target_, capacity_, nullptr, GL_STREAM_DRAW);
+    size_ = 0;
+  }
+  size_t offset = size_;
+  glBufferSubData(target_, offset, size, data);
+  // Keep every upload 4 byte aligned for the index and vertex formats.
+  size_ += (size + 3) & ~size_t{3};
+  return offset;
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <GLES3/gl3.h>
+
+#include <cstddef>
+
+namespace bob_ross {
+
+// A GL buffer that is refilled every frame. Data is appended at increasing
+// offsets and the storage is orphaned at the start of each frame, so the
+// driver never has to wait for draws from the previous frame.
+class StreamBuffer {
+ public:
+  explicit StreamBuffer(GLenum target);
+  ~StreamBuffer();
+  StreamBuffer(const StreamBuffer &) = delete;
+  StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+  // Orphans the storage, previously returned offsets become invalid.
+  void Reset();
+
+  // Copies |size| bytes into the buffer and returns their offset. Leaves the
+  // buffer bound to its target.
+  size_t Append(const void *data, size_t size);
+
+  GLuint id() const { return buffer_; }
+
+ private:
+  GLenum target_;
+  GLuint buffer_ = 0;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace bob_ross
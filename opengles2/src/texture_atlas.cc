@@ -0,0 +1,128 @@
+#include <bob_ross/texture_atlas.h>
+#include <bob_ross/trace.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace bob_ross {
+namespace {
+
+int AlignUp(int value, int alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+TextureAtlas::TextureAtlas(const TextureAtlasOptions &options)
+    : options_(options), gutter_(1 << std::max(options.max_mip_level, 0)) {}
+
+TextureAtlas::~TextureAtlas() {
+  for (Page &page : pages_) {
+    glDeleteTextures(1, &page.texture);
+  }
+}
+
+AtlasRegion TextureAtlas::Add(const uint8_t *pixels, int width, int height,
+                              size_t stride) {
+  BOB_ROSS_TRACE_SCOPE("TextureAtlas::Add");
+  if (width <= 0 || height <= 0 || width > options_.max_image_size ||
+      height > options_.max_image_size) {
+    return {};
+  }
+  // Cells start and end on multiples of the gutter, so a texel of every mip
+  // level up to max_mip_level belongs to a single image.
+  int cell_width = AlignUp(width + 2 * gutter_, gutter_);
+  int cell_height = AlignUp(height + 2 * gutter_, gutter_);
+  Page *page = nullptr;
+  int x = 0, y = 0;
+  for (Page &candidate : pages_) {
+    if (candidate.packer.Pack(cell_width, cell_height, &x, &y)) {
+      page = &candidate;
+      break;
+    }
+  }
+  if (!page) {
+    if (static_cast<int>(pages_.size()) >= options_.max_pages) {
+      return {};
+    }
+    page = CreatePage();
+    if (!page->packer.Pack(cell_width, cell_height, &x, &y)) {
+      return {};
+    }
+  }
+
+  // The image is extruded to fill its whole cell.
+  staging_.resize(static_cast<size_t>(cell_width) * cell_height * 4);
+  for (int row = 0; row < cell_height; row++) {
+    int source_row = std::clamp(row - gutter_, 0, height - 1);
+    const uint8_t *source = pixels + source_row * stride;
+    uint8_t *target = staging_.data() + row * cell_width * 4;
+    for (int column = 0; column < gutter_; column++) {
+      std::memcpy(target + column * 4, source, 4);
+    }
+    std::memcpy(target + gutter_ * 4, source, width * 4);
+    const uint8_t *last = source + (width - 1) * 4;
+    for (int column = gutter_ + width; column < cell_width; column++) {
+      std::memcpy(target + column * 4, last, 4);
+    }
+  }
+  glBindTexture(GL_TEXTURE_2D, page->texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, cell_width, cell_height, GL_RGBA,
+                  GL_UNSIGNED_BYTE, staging_.data());
+  page->dirty = true;
+
+  float scale = 1.0f / options_.page_size;
+  AtlasRegion region;
+  region.texture = page->texture;
+  region.u0 = (x + gutter_) * scale;
+  region.v0 = (y + gutter_) * scale;
+  region.u1 = (x + gutter_ + width) * scale;
+  region.v1 = (y + gutter_ + height) * scale;
+  return region;
+}
+
+void TextureAtlas::Flush() {
+  for (Page &page : pages_) {
+    if (page.dirty) {
+      BOB_ROSS_TRACE_SCOPE("TextureAtlas::Flush");
+      glBindTexture(GL_TEXTURE_2D, page.texture);
+      glGenerateMipmap(GL_TEXTURE_2D);
+      page.dirty = false;
+    }
+  }
+}
+
+float TextureAtlas::occupancy() const {
+  if (pages_.empty()) {
+    return 0;
+  }
+  int64_t used = 0;
+  for (const Page &page : pages_) {
+    used += page.packer.used_area();
+  }
+  auto page_area = static_cast<float>(options_.page_size) * options_.page_size;
+  return used / (page_area * pages_.size());
+}
+
+TextureAtlas::Page *TextureAtlas::CreatePage() {
+  BOB_ROSS_TRACE_SCOPE("TextureAtlas::CreatePage");
+  int levels = std::max(options_.max_mip_level, 0) + 1;
+  GLuint texture;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, options_.page_size,
+                 options_.page_size);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                  levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+  pages_.push_back({texture, SkylinePacker(options_.page_size,
+                                           options_.page_size),
+                    false});
+  return &pages_.back();
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,107 @@
+#include <bob_ross/texture_cache.h>
+#include <bob_ross/trace.h>
+
+#include <algorithm>
+
+namespace bob_ross {
+namespace {
+
+std::string MakeKey(const std::string &path, uint32_t options) {
+  // Paths never hold a NUL, so no two keys collide.
+  std::string key = path;
+  key.push_back('\0');
+  key.append(std::to_string(options));
+  return key;
+}
+
+bool Referenced(const std::shared_ptr<CachedTexture> &texture) {
+  return texture.use_count() > 1;
+}
+
+}  // namespace
+
+size_t Rgba8TextureBytes(int width, int height, bool mipmapped) {
+  size_t bytes = 0;
+  for (;;) {
+    bytes += static_cast<size_t>(width) * height * 4;
+    if (!mipmapped || (width <= 1 && height <= 1)) {
+      return bytes;
+    }
+    width = std::max(width / 2, 1);
+    height = std::max(height / 2, 1);
+  }
+}
+
+TextureCache::TextureCache(size_t budget_bytes)
+    : budget_bytes_(budget_bytes) {}
+
+std::shared_ptr<CachedTexture> TextureCache::Get(const std::string &path,
+                                                 uint32_t options,
+                                                 const Loader &loader) {
+  std::string key = MakeKey(path, options);
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    hits_++;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return found->second->texture;
+  }
+  misses_++;
+  std::shared_ptr<CachedTexture> texture = loader();
+  if (!texture) {
+    return nullptr;
+  }
+  entries_.push_front({key, texture});
+  index_.emplace(std::move(key), entries_.begin());
+  // Makes room for the new texture among the unused ones.
+  EvictToBudget(budget_bytes_);
+  return texture;
+}
+
+void TextureCache::Trim() { EvictToBudget(budget_bytes_); }
+
+void TextureCache::SetBudget(size_t budget_bytes) {
+  budget_bytes_ = budget_bytes;
+  EvictToBudget(budget_bytes_);
+}
+
+void TextureCache::Purge() { EvictToBudget(0); }
+
+TextureResidency TextureCache::residency() const {
+  TextureResidency residency;
+  for (const Entry &entry : entries_) {
+    size_t bytes = entry.texture->gpu_bytes();
+    residency.texture_count++;
+    residency.resident_bytes += bytes;
+    if (Referenced(entry.texture)) {
+      residency.referenced_count++;
+      residency.referenced_bytes += bytes;
+    }
+  }
+  return residency;
+}
+
+// Sizes aren't kept between calls, textures loading in the background grow
+// without telling the cache.
+void TextureCache::EvictToBudget(size_t budget_bytes) {
+  size_t size_bytes = 0;
+  for (const Entry &entry : entries_) {
+    size_bytes += entry.texture->gpu_bytes();
+  }
+  if (size_bytes <= budget_bytes) {
+    return;
+  }
+  BOB_ROSS_TRACE_SCOPE("TextureCache::EvictToBudget");
+  auto entry = entries_.end();
+  while (size_bytes > budget_bytes && entry != entries_.begin()) {
+    --entry;
+    if (Referenced(entry->texture)) {
+      continue;
+    }
+    size_bytes -= entry->texture->gpu_bytes();
+    index_.erase(entry->key);
+    entry = entries_.erase(entry);
+    evictions_++;
+  }
+}
+
+}  // namespace bob_ross
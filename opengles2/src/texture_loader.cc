@@ -0,0 +1,240 @@
+#include <bob_ross/texture_loader.h>
+#include <bob_ross/trace.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "upload_ring.h"
+
+namespace bob_ross {
+namespace {
+
+int MipLevels(int width, int height) {
+  int levels = 1;
+  for (int size = std::max(width, height); size > 1; size >>= 1) {
+    levels++;
+  }
+  return levels;
+}
+
+}  // namespace
+
+AsyncTexture::~AsyncTexture() { glDeleteTextures(1, &texture_); }
+
+TextureLoader::TextureLoader(const TextureLoaderOptions &options)
+    : options_(options) {
+  glGenTextures(1, &placeholder_);
+  glBindTexture(GL_TEXTURE_2D, placeholder_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               options_.placeholder);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  glGenBuffers(1, &ring_);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring_);
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, options_.ring_bytes, nullptr,
+               GL_STREAM_DRAW);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  for (int i = 0; i < std::max(options_.worker_count, 1); i++) {
+    workers_.emplace_back(&TextureLoader::WorkerLoop, this);
+  }
+}
+
+TextureLoader::~TextureLoader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+  for (Upload &upload : uploads_) {
+    glDeleteSync(upload.fence);
+  }
+  glDeleteBuffers(1, &ring_);
+  glDeleteTextures(1, &placeholder_);
+}
+
+std::shared_ptr<AsyncTexture> TextureLoader::Load(Decoder decoder) {
+  std::shared_ptr<AsyncTexture> texture(new AsyncTexture(placeholder_));
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back({texture, std::move(decoder)});
+  }
+  wake_.notify_one();
+  return texture;
+}
+
+void TextureLoader::WorkerLoop() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return quit_ || !jobs_.empty(); });
+      if (quit_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+      decoding_++;
+    }
+    // Only checked, never locked: the last reference to a texture has to
+    // be dropped on the GL thread.
+    Decoded decoded = {std::move(job.texture), {}, false};
+    if (!decoded.texture.expired()) {
+      BOB_ROSS_TRACE_SCOPE("TextureLoader::Decode");
+      decoded.ok = job.decoder(&decoded.image);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    decoded_.push_back(std::move(decoded));
+    decoding_--;
+  }
+}
+
+int TextureLoader::Pump() {
+  BOB_ROSS_TRACE_SCOPE("TextureLoader::Pump");
+  int finished = 0;
+  Reclaim(&finished);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::move(decoded_.begin(), decoded_.end(), std::back_inserter(staging_));
+    decoded_.clear();
+  }
+  if (staging_.empty()) {
+    return finished;
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring_);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  size_t budget = options_.upload_bytes_per_pump;
+  while (!staging_.empty() && budget &&
+         Stage(&staging_.front(), &budget, &finished)) {
+    staging_.pop_front();
+  }
+  // Client memory uploads elsewhere would otherwise read from the ring.
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  return finished;
+}
+
+size_t TextureLoader::pending() const {
+  size_t uploading = std::count_if(uploads_.begin(), uploads_.end(),
+                                   [](const Upload &upload) {
+                                     return upload.last;
+                                   });
+  std::lock_guard<std::mutex> lock(mutex_);
+  return jobs_.size() + decoding_ + decoded_.size() + staging_.size() +
+         uploading;
+}
+
+// Finds |size| contiguous bytes in the ring that no unfinished upload
+// uses.
+bool TextureLoader::Allocate(size_t size, size_t *offset) {
+  if (uploads_.empty()) {
+    return AllocateRing(options_.ring_bytes, nullptr, size, offset);
+  }
+  RingRange used = {uploads_.front().begin, uploads_.back().end};
+  return AllocateRing(options_.ring_bytes, &used, size, offset);
+}
+
+void TextureLoader::Reclaim(int *finished) {
+  while (!uploads_.empty()) {
+    Upload &upload = uploads_.front();
+    GLenum result = glClientWaitSync(upload.fence, 0, 0);
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+      break;
+    }
+    glDeleteSync(upload.fence);
+    if (upload.last) {
+      if (std::shared_ptr<AsyncTexture> texture = upload.texture.lock()) {
+        texture->status_ = AsyncTexture::Status::kReady;
+        (*finished)++;
+      }
+    }
+    uploads_.pop_front();
+  }
+}
+
+// Stages the next band of rows of |decoded| and uploads it to its texture.
+// Returns true once the image is done with, false when it has to wait for
+// budget or ring space.
+bool TextureLoader::Stage(Decoded *decoded, size_t *budget, int *finished) {
+  std::shared_ptr<AsyncTexture> texture = decoded->texture.lock();
+  if (!texture) {
+    staged_rows_ = 0;
+    return true;
+  }
+  const DecodedImage &image = decoded->image;
+  size_t row_bytes = static_cast<size_t>(image.width) * 4;
+  if (!decoded->ok || image.width <= 0 || image.height <= 0 ||
+      image.stride < row_bytes ||
+      image.pixels.size() < image.stride * (image.height - 1) + row_bytes ||
+      row_bytes > options_.ring_bytes) {
+    texture->status_ = AsyncTexture::Status::kFailed;
+    (*finished)++;
+    return true;
+  }
+  if (!staged_rows_) {
+    glGenTextures(1, &texture->texture_);
+    glBindTexture(GL_TEXTURE_2D, texture->texture_);
+    glTexStorage2D(GL_TEXTURE_2D, MipLevels(image.width, image.height),
+                   GL_RGBA8, image.width, image.height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    texture->width_ = image.width;
+    texture->height_ = image.height;
+  }
+
+  while (*budget) {
+    // At least one row per band, so the budget may be overshot by less
+    // than a row.
+    size_t rows = std::min<size_t>(
+        {static_cast<size_t>(image.height - staged_rows_),
+         std::max<size_t>(*budget / row_bytes, 1),
+         options_.ring_bytes / row_bytes});
+    size_t size = rows * row_bytes;
+    size_t offset;
+    if (!Allocate(size, &offset)) {
+      return false;
+    }
+    // The range is unused by the GPU, its fence has signaled.
+    auto *target = static_cast<uint8_t *>(glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, offset, size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+            GL_MAP_UNSYNCHRONIZED_BIT));
+    if (!target) {
+      return false;
+    }
+    for (size_t row = 0; row < rows; row++) {
+      std::memcpy(target + row * row_bytes,
+                  image.pixels.data() + (staged_rows_ + row) * image.stride,
+                  row_bytes);
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindTexture(GL_TEXTURE_2D, texture->texture_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, staged_rows_, image.width,
+                    static_cast<GLsizei>(rows), GL_RGBA, GL_UNSIGNED_BYTE,
+                    reinterpret_cast<const void *>(offset));
+    staged_rows_ += static_cast<int>(rows);
+    *budget -= std::min(*budget, size);
+
+    bool last = staged_rows_ == image.height;
+    if (last) {
+      glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    uploads_.push_back({offset, offset + size,
+                        glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), last,
+                        decoded->texture});
+    if (last) {
+      staged_rows_ = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace bob_ross
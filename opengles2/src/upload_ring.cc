@@ -0,0 +1,26 @@
+#include "upload_ring.h"
+
+namespace bob_ross {
+
+bool AllocateRing(size_t capacity, const RingRange *used, size_t size,
+                  size_t *offset) {
+  if (!used) {
+    *offset = 0;
+    return size <= capacity;
+  }
+  // Ranges in use are never empty, so one ending where the oldest begins
+  // has filled the ring.
+  bool wrapped = used->end <= used->begin;
+  if (!wrapped && size <= capacity - used->end) {
+    *offset = used->end;
+    return true;
+  }
+  size_t start = wrapped ? used->end : 0;
+  if (size <= used->begin - start) {
+    *offset = start;
+    return true;
+  }
+  return false;
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+namespace bob_ross {
+
+// Bytes of a ring buffer, from |begin| up to |end|. A range ending before
+// it begins wraps around the end of the ring.
+struct RingRange {
+  size_t begin, end;
+};
+
+// Finds |size| contiguous bytes in a ring of |capacity| bytes outside
+// |used|, which runs from the start of the oldest range in use to the end
+// of the newest, or is null when none is. Ranges are handed out in ring
+// order, so new ones go after the newest, or at the start of the ring when
+// that leaves too little room before its end.
+bool AllocateRing(size_t capacity, const RingRange *used, size_t size,
+                  size_t *offset);
+
+}  // namespace bob_ross
@@ -0,0 +1,186 @@
+#include "vertex_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if !defined(BOB_ROSS_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64)
+#define BOB_ROSS_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+// vcvtnq_s32_f32, which rounds like the other variants, is AArch64 only.
+#define BOB_ROSS_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace bob_ross {
+namespace {
+
+static_assert(sizeof(Vertex) == 16, "The SIMD loops load one Vertex per lane");
+static_assert(sizeof(CompactVertex) == 8, "CompactVertex must stay packed");
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+constexpr float kMaxFixed = 32767;
+
+// |lowest| and |highest| hold the extremes of x and y over a range of
+// vertices, none of which is NaN.
+int SubpixelsFor(const float *lowest, const float *highest) {
+  float largest = std::max({-lowest[0], highest[0], -lowest[1], highest[1]});
+  if (largest * kMinCompactSubpixels > kMaxFixed) {
+    return 0;
+  }
+  int subpixels = kMaxCompactSubpixels;
+  while (largest * subpixels > kMaxFixed) {
+    subpixels /= 2;
+  }
+  return subpixels;
+}
+
+#if !BOB_ROSS_SSE2 && !BOB_ROSS_NEON
+int CompactSubpixelsScalar(const Vertex *vertices, size_t count) {
+  float lowest[2] = {kInfinity, kInfinity};
+  float highest[2] = {-kInfinity, -kInfinity};
+  bool nan = false;
+  for (size_t i = 0; i < count; i++) {
+    const float position[2] = {vertices[i].x, vertices[i].y};
+    for (int j = 0; j < 2; j++) {
+      lowest[j] = std::min(lowest[j], position[j]);
+      highest[j] = std::max(highest[j], position[j]);
+      nan |= std::isnan(position[j]);
+    }
+  }
+  return nan ? 0 : SubpixelsFor(lowest, highest);
+}
+#endif
+
+void PackCompactScalar(const Vertex *vertices, size_t count, int subpixels,
+                       CompactVertex *out) {
+  auto scale = static_cast<float>(subpixels);
+  for (size_t i = 0; i < count; i++) {
+    // lrint rounds to nearest even like the SIMD conversions.
+    out[i] = {static_cast<int16_t>(std::lrint(vertices[i].x * scale)),
+              static_cast<int16_t>(std::lrint(vertices[i].y * scale)),
+              vertices[i].color};
+  }
+}
+
+#if BOB_ROSS_SSE2
+int CompactSubpixelsSse2(const Vertex *vertices, size_t count) {
+  __m128 lowest = _mm_set1_ps(kInfinity);
+  __m128 highest = _mm_set1_ps(-kInfinity);
+  __m128 nan = _mm_setzero_ps();
+  for (size_t i = 0; i < count; i += 2) {
+    // x and y of two vertices, or of the last one twice.
+    size_t next = i + 1 < count ? i + 1 : i;
+    __m128 xy = _mm_loadh_pi(
+        _mm_loadl_pi(_mm_setzero_ps(),
+                     reinterpret_cast<const __m64 *>(&vertices[i].x)),
+        reinterpret_cast<const __m64 *>(&vertices[next].x));
+    lowest = _mm_min_ps(lowest, xy);
+    highest = _mm_max_ps(highest, xy);
+    nan = _mm_or_ps(nan, _mm_cmpunord_ps(xy, xy));
+  }
+  if (_mm_movemask_ps(nan)) {
+    return 0;
+  }
+  // Folds the lanes of the second vertex into those of the first.
+  lowest = _mm_min_ps(lowest, _mm_movehl_ps(lowest, lowest));
+  highest = _mm_max_ps(highest, _mm_movehl_ps(highest, highest));
+  alignas(16) float low[4], high[4];
+  _mm_store_ps(low, lowest);
+  _mm_store_ps(high, highest);
+  return SubpixelsFor(low, high);
+}
+
+void PackCompactSse2(const Vertex *vertices, size_t count, int subpixels,
+                     CompactVertex *out) {
+  const __m128 scale = _mm_set1_ps(static_cast<float>(subpixels));
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 x = _mm_loadu_ps(&vertices[i].x);
+    __m128 y = _mm_loadu_ps(&vertices[i + 1].x);
+    __m128 z = _mm_loadu_ps(&vertices[i + 2].x);
+    __m128 color = _mm_loadu_ps(&vertices[i + 3].x);
+    // One vertex per register to one attribute per register.
+    _MM_TRANSPOSE4_PS(x, y, z, color);
+    __m128i xy = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(x, scale)),
+                                 _mm_cvtps_epi32(_mm_mul_ps(y, scale)));
+    // x0 x1 x2 x3 y0 y1 y2 y3 to x0 y0 x1 y1 x2 y2 x3 y3.
+    xy = _mm_unpacklo_epi16(xy, _mm_srli_si128(xy, 8));
+    __m128i colors = _mm_castps_si128(color);
+    auto *p = reinterpret_cast<__m128i *>(out + i);
+    _mm_storeu_si128(p, _mm_unpacklo_epi32(xy, colors));
+    _mm_storeu_si128(p + 1, _mm_unpackhi_epi32(xy, colors));
+  }
+  PackCompactScalar(vertices + i, count - i, subpixels, out + i);
+}
+#endif
+
+#if BOB_ROSS_NEON
+int CompactSubpixelsNeon(const Vertex *vertices, size_t count) {
+  float32x2_t lowest = vdup_n_f32(kInfinity);
+  float32x2_t highest = vdup_n_f32(-kInfinity);
+  uint32x2_t nan = vdup_n_u32(0);
+  for (size_t i = 0; i < count; i++) {
+    float32x2_t xy = vld1_f32(&vertices[i].x);
+    lowest = vmin_f32(lowest, xy);
+    highest = vmax_f32(highest, xy);
+    nan = vorr_u32(nan, vmvn_u32(vceq_f32(xy, xy)));
+  }
+  if (vget_lane_u32(nan, 0) | vget_lane_u32(nan, 1)) {
+    return 0;
+  }
+  float low[2], high[2];
+  vst1_f32(low, lowest);
+  vst1_f32(high, highest);
+  return SubpixelsFor(low, high);
+}
+
+void PackCompactNeon(const Vertex *vertices, size_t count, int subpixels,
+                     CompactVertex *out) {
+  const float32x4_t scale = vdupq_n_f32(static_cast<float>(subpixels));
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    // De-interleaves four vertices into x, y, z and color registers.
+    uint32x4x4_t v =
+        vld4q_u32(reinterpret_cast<const uint32_t *>(vertices + i));
+    int16x4_t x = vqmovn_s32(
+        vcvtnq_s32_f32(vmulq_f32(vreinterpretq_f32_u32(v.val[0]), scale)));
+    int16x4_t y = vqmovn_s32(
+        vcvtnq_s32_f32(vmulq_f32(vreinterpretq_f32_u32(v.val[1]), scale)));
+    int16x4x2_t xy = vzip_s16(x, y);
+    uint32x4x2_t packed = {
+        {vreinterpretq_u32_s16(vcombine_s16(xy.val[0], xy.val[1])),
+         v.val[3]}};
+    vst2q_u32(reinterpret_cast<uint32_t *>(out + i), packed);
+  }
+  PackCompactScalar(vertices + i, count - i, subpixels, out + i);
+}
+#endif
+
+}  // namespace
+
+int CompactSubpixels(const Vertex *vertices, size_t count) {
+#if BOB_ROSS_SSE2
+  return CompactSubpixelsSse2(vertices, count);
+#elif BOB_ROSS_NEON
+  return CompactSubpixelsNeon(vertices, count);
+#else
+  return CompactSubpixelsScalar(vertices, count);
+#endif
+}
+
+void PackCompact(const Vertex *vertices, size_t count, int subpixels,
+                 CompactVertex *out) {
+#if BOB_ROSS_SSE2
+  PackCompactSse2(vertices, count, subpixels, out);
+#elif BOB_ROSS_NEON
+  PackCompactNeon(vertices, count, subpixels, out);
+#else
+  PackCompactScalar(vertices, count, subpixels, out);
+#endif
+}
+
+}  // namespace bob_ross
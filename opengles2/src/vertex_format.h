@@ -0,0 +1,34 @@
+#pragma once
+
+#include <bob_ross/tessellator.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bob_ross {
+
+// Half the size of Vertex. Positions are 16 bit fixed point and z is
+// dropped, the color is the same RGBA8 value. The number of subpixel steps
+// per pixel is chosen per range of vertices, as many as their largest
+// coordinate leaves room for.
+struct CompactVertex {
+  int16_t x, y;
+  uint32_t color;
+};
+
+// GPUs snap vertices to at most 8 subpixel bits, more would be wasted.
+constexpr int kMaxCompactSubpixels = 256;
+// Coarser positions would visibly move edges.
+constexpr int kMinCompactSubpixels = 4;
+
+// Subpixel steps to pack |vertices| with, or 0 if they don't fit a
+// CompactVertex because a coordinate is too large or NaN. z is not looked
+// at, the unprojected vertex shader draws every vertex at depth 0.
+int CompactSubpixels(const Vertex *vertices, size_t count);
+
+// Converts |count| vertices, rounding positions to the nearest of
+// |subpixels| steps per pixel.
+void PackCompact(const Vertex *vertices, size_t count, int subpixels,
+                 CompactVertex *out);
+
+}  // namespace bob_ross
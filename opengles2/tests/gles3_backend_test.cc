@@ -0,0 +1,136 @@
+#include <bob_ross/bob_ross.h>
+#include <bob_ross/cpu_backend.h>
+#include <bob_ross/gles3_backend.h>
+#include <bob_ross/headless_context.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+constexpr int kWidth = 128, kHeight = 96;
+
+using Scene = std::function<void(BobRoss *)>;
+
+class Gles3BackendTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    context_ = HeadlessContext::Create(kWidth, kHeight);
+    if (!context_) {
+      GTEST_SKIP() << "No GLES 3 context";
+    }
+  }
+
+  std::vector<uint32_t> DrawGl(const Gles3Options &options,
+                               const Scene &scene) {
+    BobRoss bob_ross(kWidth, kHeight, std::make_unique<Gles3Backend>(options));
+    glClearColor(0, 0, 0, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+    bob_ross.BeginFrame();
+    scene(&bob_ross);
+    bob_ross.EndFrame();
+    std::vector<uint32_t> pixels;
+    context_->ReadPixels(&pixels);
+    return pixels;
+  }
+
+  static std::vector<uint32_t> DrawCpu(const Scene &scene) {
+    CpuOptions options;
+    options.clear_color = {0, 0, 0, 255};
+    auto backend = std::make_unique<CpuBackend>(options);
+    CpuBackend *cpu = backend.get();
+    BobRoss bob_ross(kWidth, kHeight, std::move(backend));
+    bob_ross.BeginFrame();
+    scene(&bob_ross);
+    bob_ross.EndFrame();
+    return std::vector<uint32_t>(cpu->pixels(),
+                                 cpu->pixels() + kWidth * kHeight);
+  }
+
+  std::unique_ptr<HeadlessContext> context_;
+};
+
+// Largest difference between the channels of two RGBA8 pixels.
+int Difference(uint32_t a, uint32_t b) {
+  int difference = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    int channel_a = (a >> shift) & 0xff, channel_b = (b >> shift) & 0xff;
+    difference = std::max(difference, std::abs(channel_a - channel_b));
+  }
+  return difference;
+}
+
+// Shapes well apart, each with a z outside the GL clip volume, and a pair
+// overlapping in reverse z order.
+void FarLayers(BobRoss *bob_ross) {
+  bob_ross->SetFillColor({255, 0, 0, 255});
+  bob_ross->Rect({8, 8, 2}, {40, 40, 2});
+  bob_ross->SetFillColor({0, 255, 0, 255});
+  bob_ross->Circle({64, 24, -3}, 14);
+  bob_ross->SetFillColor({0, 0, 255, 255});
+  bob_ross->Polygon({{88, 8, 100}, {120, 8, 100}, {104, 40, 100}});
+  bob_ross->SetFillColor({255, 255, 0, 255});
+  bob_ross->Rect({8, 56, 50}, {56, 88, 50});
+  bob_ross->SetFillColor({0, 255, 255, 255});
+  bob_ross->Rect({24, 64, -50}, {72, 80, -50});
+}
+
+TEST_F(Gles3BackendTest, LayersOutsideClipVolumeMatchCpu) {
+  std::vector<uint32_t> expected = DrawCpu(FarLayers);
+  // Centers of the shapes, and of the overlap where the rect with the
+  // greater z has to stay on top.
+  const int samples[][2] = {{24, 24}, {64, 24}, {104, 20}, {40, 72}, {64, 72}};
+  for (bool instanced : {true, false}) {
+    Gles3Options options;
+    options.instanced_shapes = instanced;
+    std::vector<uint32_t> pixels = DrawGl(options, FarLayers);
+    for (const auto &sample : samples) {
+      int index = sample[1] * kWidth + sample[0];
+      EXPECT_LE(Difference(pixels[index], expected[index]), 2)
+          << "instanced " << instanced << " at " << sample[0] << ","
+          << sample[1];
+    }
+  }
+}
+
+// Translucent shapes of three kinds in a grid, so some overlap and some
+// don't, with the fill color changing between them.
+void Mixed(BobRoss *bob_ross) {
+  for (int i = 0; i < 48; i++) {
+    float x = static_cast<float>((i * 37) % 112);
+    float y = static_cast<float>((i * 23) % 80);
+    float z = static_cast<float>(i % 3);
+    bob_ross->SetFillColor({(i * 80) % 256, (i * 50) % 256, (i * 30) % 256,
+                            128 + i % 2 * 127});
+    switch (i % 3) {
+      case 0:
+        bob_ross->Rect({x, y, z}, {x + 14, y + 10, z});
+        break;
+      case 1:
+        bob_ross->Circle({x + 8, y + 8, z}, 7.5f);
+        break;
+      default:
+        bob_ross->Polygon({{x, y, z}, {x + 16, y + 2, z}, {x + 6, y + 14, z}});
+        break;
+    }
+  }
+}
+
+TEST_F(Gles3BackendTest, ReorderingDrawsKeepsPixels) {
+  for (bool instanced : {true, false}) {
+    Gles3Options options;
+    options.instanced_shapes = instanced;
+    options.reorder_draws = false;
+    std::vector<uint32_t> in_order = DrawGl(options, Mixed);
+    options.reorder_draws = true;
+    std::vector<uint32_t> reordered = DrawGl(options, Mixed);
+    EXPECT_EQ(in_order, reordered) << "instanced " << instanced;
+  }
+}
+
+}  // namespace
+}  // namespace bob_ross
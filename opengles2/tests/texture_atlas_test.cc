@@ -0,0 +1,173 @@
+#include <bob_ross/headless_context.h>
+#include <bob_ross/texture_atlas.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+constexpr int kPageSize = 256;
+
+// Part of an atlas page in page pixels.
+struct Cell {
+  int left, top, right, bottom;
+};
+
+class TextureAtlasTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    context_ = HeadlessContext::Create(16, 16);
+    if (!context_) {
+      GTEST_SKIP() << "No GLES 3 context";
+    }
+  }
+
+  // |rect| of mip |level| of |texture| as RGBA8 pixels.
+  static std::vector<uint32_t> Read(GLuint texture, int level,
+                                    const Cell &rect) {
+    GLint previous;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+    GLuint framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, texture, level);
+    int width = rect.right - rect.left, height = rect.bottom - rect.top;
+    std::vector<uint32_t> pixels(static_cast<size_t>(width) * height);
+    glReadPixels(rect.left, rect.top, width, height, GL_RGBA,
+                 GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previous);
+    glDeleteFramebuffers(1, &framebuffer);
+    return pixels;
+  }
+
+  std::unique_ptr<HeadlessContext> context_;
+};
+
+// The image of |region| in page pixels, without its gutter.
+Cell ImageOf(const AtlasRegion &region) {
+  return {static_cast<int>(std::lround(region.u0 * kPageSize)),
+          static_cast<int>(std::lround(region.v0 * kPageSize)),
+          static_cast<int>(std::lround(region.u1 * kPageSize)),
+          static_cast<int>(std::lround(region.v1 * kPageSize))};
+}
+
+TEST_F(TextureAtlasTest, CellsAreGutterAligned) {
+  for (int max_mip_level : {0, 2, 3}) {
+    SCOPED_TRACE(max_mip_level);
+    TextureAtlasOptions options;
+    options.page_size = kPageSize;
+    options.max_mip_level = max_mip_level;
+    options.max_image_size = 48;
+    options.max_pages = 2;
+    TextureAtlas atlas(options);
+    const int gutter = 1 << max_mip_level;
+
+    std::mt19937 random(max_mip_level);
+    std::vector<std::pair<GLuint, Cell>> cells;
+    std::vector<uint32_t> pixels(48 * 48, 0xff00ff00);
+    int refused = 0;
+    while (refused < 10) {
+      int width = 1 + random() % 48, height = 1 + random() % 48;
+      AtlasRegion region = atlas.Add(
+          reinterpret_cast<const uint8_t *>(pixels.data()), width, height,
+          width * 4);
+      if (!region.texture) {
+        refused++;
+        continue;
+      }
+      Cell image = ImageOf(region);
+      ASSERT_EQ(image.right - image.left, width);
+      ASSERT_EQ(image.bottom - image.top, height);
+      // Starts a gutter into its cell, which starts on a multiple of it.
+      ASSERT_EQ(image.left % gutter, 0);
+      ASSERT_EQ(image.top % gutter, 0);
+      Cell cell = {image.left - gutter, image.top - gutter,
+                   image.right + gutter, image.bottom + gutter};
+      ASSERT_GE(cell.left, 0);
+      ASSERT_GE(cell.top, 0);
+      ASSERT_LE(cell.right, kPageSize);
+      ASSERT_LE(cell.bottom, kPageSize);
+      for (const auto &[texture, other] : cells) {
+        ASSERT_TRUE(texture != region.texture ||
+                    cell.right <= other.left || other.right <= cell.left ||
+                    cell.bottom <= other.top || other.bottom <= cell.top);
+      }
+      cells.emplace_back(region.texture, cell);
+    }
+    EXPECT_EQ(atlas.page_count(), 2u);
+    EXPECT_GT(cells.size(), 20u);
+  }
+}
+
+// Solid images of odd sizes side by side. At the last mip level each
+// still covers its own texels, with nothing of its neighbors blended in.
+TEST_F(TextureAtlasTest, MipLevelsKeepImagesApart) {
+  TextureAtlasOptions options;
+  options.page_size = kPageSize;
+  options.max_mip_level = 2;
+  TextureAtlas atlas(options);
+  const uint32_t colors[] = {0xff0000ff, 0xff00ff00, 0xffff0000,
+                             0x80ffffff, 0xff000000, 0x00ffffff};
+  const int sizes[][2] = {{13, 7}, {5, 9}, {1, 1}, {30, 3}, {7, 22}, {2, 2}};
+  std::vector<AtlasRegion> regions;
+  for (int i = 0; i < 6; i++) {
+    std::vector<uint32_t> pixels(sizes[i][0] * sizes[i][1], colors[i]);
+    regions.push_back(atlas.Add(reinterpret_cast<uint8_t *>(pixels.data()),
+                                sizes[i][0], sizes[i][1], sizes[i][0] * 4));
+    ASSERT_NE(regions.back().texture, 0u);
+  }
+  atlas.Flush();
+  const int level = options.max_mip_level, scale = 1 << level;
+  for (int i = 0; i < 6; i++) {
+    SCOPED_TRACE(i);
+    Cell image = ImageOf(regions[i]);
+    // The image's texels at |level|, which its gutter pads to whole ones.
+    Cell texels = {image.left / scale, image.top / scale,
+                   (image.right + scale - 1) / scale,
+                   (image.bottom + scale - 1) / scale};
+    for (uint32_t pixel : Read(regions[i].texture, level, texels)) {
+      ASSERT_EQ(pixel, colors[i]);
+    }
+  }
+}
+
+// The gutter repeats the image's edge pixels, as clamp to edge would.
+TEST_F(TextureAtlasTest, GutterRepeatsEdges) {
+  TextureAtlasOptions options;
+  options.page_size = kPageSize;
+  options.max_mip_level = 1;
+  TextureAtlas atlas(options);
+  constexpr int kWidth = 5, kHeight = 3, kGutter = 2;
+  std::vector<uint32_t> pixels(kWidth * kHeight);
+  for (int i = 0; i < kWidth * kHeight; i++) {
+    pixels[i] = 0xff000000 | i * 0x0a0b0c;
+  }
+  AtlasRegion region = atlas.Add(
+      reinterpret_cast<const uint8_t *>(pixels.data()), kWidth, kHeight,
+      kWidth * 4);
+  ASSERT_NE(region.texture, 0u);
+  Cell image = ImageOf(region);
+  Cell cell = {image.left - kGutter, image.top - kGutter,
+               image.right + kGutter, image.bottom + kGutter};
+  std::vector<uint32_t> texels = Read(region.texture, 0, cell);
+  const int cell_width = kWidth + 2 * kGutter;
+  for (int y = 0; y < kHeight + 2 * kGutter; y++) {
+    for (int x = 0; x < cell_width; x++) {
+      int source_x = std::clamp(x - kGutter, 0, kWidth - 1);
+      int source_y = std::clamp(y - kGutter, 0, kHeight - 1);
+      ASSERT_EQ(texels[y * cell_width + x],
+                pixels[source_y * kWidth + source_x])
+          << x << "," << y;
+    }
+  }
+}
+
+}  // namespace
+}  // namespace bob_ross
@@ -0,0 +1,159 @@
+#include <bob_ross/texture_cache.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bob_ross {
+namespace {
+
+// Records its name when destroyed, which is when the cache evicts it once
+// the test holds no reference.
+class FakeTexture : public CachedTexture {
+ public:
+  FakeTexture(std::string name, size_t bytes,
+              std::vector<std::string> *destroyed)
+      : name_(std::move(name)), bytes_(bytes), destroyed_(destroyed) {}
+  ~FakeTexture() override { destroyed_->push_back(name_); }
+
+  size_t gpu_bytes() const override { return bytes_; }
+  void set_gpu_bytes(size_t bytes) { bytes_ = bytes; }
+
+ private:
+  std::string name_;
+  size_t bytes_;
+  std::vector<std::string> *destroyed_;
+};
+
+class TextureCacheTest : public testing::Test {
+ protected:
+  std::shared_ptr<CachedTexture> Get(const std::string &path, size_t bytes,
+                                     uint32_t options = 0) {
+    return cache_.Get(path, options, [&] {
+      loads_++;
+      return std::make_shared<FakeTexture>(path, bytes, &destroyed_);
+    });
+  }
+
+  // Declared before the cache, so it outlives the textures the cache holds.
+  std::vector<std::string> destroyed_;
+  TextureCache cache_{100};
+  int loads_ = 0;
+};
+
+TEST_F(TextureCacheTest, SharesTextures) {
+  std::shared_ptr<CachedTexture> first = Get("a.png", 10);
+  std::shared_ptr<CachedTexture> second = Get("a.png", 10);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(loads_, 1);
+  EXPECT_EQ(cache_.hits(), 1u);
+  EXPECT_EQ(cache_.misses(), 1u);
+}
+
+TEST_F(TextureCacheTest, KeysIncludeOptions) {
+  std::shared_ptr<CachedTexture> plain = Get("a.png", 10, 0);
+  std::shared_ptr<CachedTexture> other = Get("a.png", 10, 1);
+  EXPECT_NE(plain, other);
+  EXPECT_EQ(loads_, 2);
+  EXPECT_EQ(Get("a.png", 10, 1), other);
+  EXPECT_EQ(cache_.residency().texture_count, 2u);
+}
+
+TEST_F(TextureCacheTest, KeepsUnreferencedTexturesWithinBudget) {
+  Get("a.png", 40);
+  Get("b.png", 40);
+  EXPECT_TRUE(destroyed_.empty());
+  TextureResidency residency = cache_.residency();
+  EXPECT_EQ(residency.texture_count, 2u);
+  EXPECT_EQ(residency.resident_bytes, 80u);
+  EXPECT_EQ(residency.referenced_count, 0u);
+  Get("a.png", 40);
+  EXPECT_EQ(loads_, 2);
+}
+
+TEST_F(TextureCacheTest, EvictsLeastRecentlyUsed) {
+  Get("a.png", 40);
+  Get("b.png", 40);
+  // Used last, so b is now the oldest.
+  Get("a.png", 40);
+  Get("c.png", 40);
+  EXPECT_EQ(destroyed_, std::vector<std::string>{"b.png"});
+  EXPECT_EQ(cache_.evictions(), 1u);
+  Get("d.png", 40);
+  EXPECT_EQ(destroyed_, (std::vector<std::string>{"b.png", "a.png"}));
+  EXPECT_EQ(cache_.residency().resident_bytes, 80u);
+}
+
+TEST_F(TextureCacheTest, SkipsReferencedTextures) {
+  std::shared_ptr<CachedTexture> held = Get("a.png", 40);
+  Get("b.png", 40);
+  Get("c.png", 40);
+  // a is the oldest but still held, so b goes instead.
+  EXPECT_EQ(destroyed_, std::vector<std::string>{"b.png"});
+
+  // Stays over budget while held textures don't fit.
+  std::shared_ptr<CachedTexture> big = Get("big.png", 200);
+  EXPECT_EQ(destroyed_, (std::vector<std::string>{"b.png", "c.png"}));
+  TextureResidency residency = cache_.residency();
+  EXPECT_EQ(residency.texture_count, 2u);
+  EXPECT_EQ(residency.resident_bytes, 240u);
+  EXPECT_EQ(residency.referenced_count, 2u);
+  EXPECT_EQ(residency.referenced_bytes, 240u);
+
+  big.reset();
+  cache_.Trim();
+  EXPECT_EQ(destroyed_.back(), "big.png");
+  EXPECT_EQ(cache_.residency().texture_count, 1u);
+}
+
+TEST_F(TextureCacheTest, TrimCountsGrownTextures) {
+  std::shared_ptr<CachedTexture> a = Get("a.png", 10);
+  Get("b.png", 10);
+  static_cast<FakeTexture *>(a.get())->set_gpu_bytes(95);
+  EXPECT_TRUE(destroyed_.empty());
+  cache_.Trim();
+  EXPECT_EQ(destroyed_, std::vector<std::string>{"b.png"});
+}
+
+TEST_F(TextureCacheTest, SetBudgetTrims) {
+  Get("a.png", 40);
+  Get("b.png", 40);
+  cache_.SetBudget(50);
+  EXPECT_EQ(cache_.budget_bytes(), 50u);
+  EXPECT_EQ(destroyed_, std::vector<std::string>{"a.png"});
+}
+
+TEST_F(TextureCacheTest, PurgeKeepsReferencedTextures) {
+  std::shared_ptr<CachedTexture> held = Get("a.png", 10);
+  Get("b.png", 10);
+  Get("c.png", 10);
+  cache_.Purge();
+  EXPECT_EQ(destroyed_.size(), 2u);
+  EXPECT_EQ(cache_.residency().texture_count, 1u);
+  EXPECT_EQ(Get("a.png", 10), held);
+}
+
+TEST_F(TextureCacheTest, FailedLoadsAreNotCached) {
+  auto fail = [this] {
+    loads_++;
+    return std::shared_ptr<CachedTexture>();
+  };
+  EXPECT_EQ(cache_.Get("missing.png", 0, fail), nullptr);
+  EXPECT_EQ(cache_.Get("missing.png", 0, fail), nullptr);
+  EXPECT_EQ(loads_, 2);
+  EXPECT_EQ(cache_.misses(), 2u);
+  EXPECT_EQ(cache_.residency().texture_count, 0u);
+}
+
+TEST(Rgba8TextureBytesTest, CountsMipLevels) {
+  EXPECT_EQ(Rgba8TextureBytes(4, 4, false), 64u);
+  // 4x4, 2x2 and 1x1.
+  EXPECT_EQ(Rgba8TextureBytes(4, 4), 84u);
+  // 8x2, 4x1, 2x1 and 1x1.
+  EXPECT_EQ(Rgba8TextureBytes(8, 2), 4u * (16 + 4 + 2 + 1));
+}
+
+}  // namespace
+}  // namespace bob_ross
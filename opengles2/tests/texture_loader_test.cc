@@ -0,0 +1,268 @@
+#include <bob_ross/headless_context.h>
+#include <bob_ross/texture_loader.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "upload_ring.h"
+
+namespace bob_ross {
+namespace {
+
+// Smaller than most test images, which are then uploaded in bands.
+constexpr size_t kRingBytes = 4096;
+
+// An image whose texels depend on their position and |seed|, with |stride|
+// bytes per row, padding included.
+DecodedImage Pattern(int width, int height, size_t stride, int seed) {
+  DecodedImage image;
+  image.width = width;
+  image.height = height;
+  image.stride = stride;
+  image.pixels.assign(stride * height, 0xee);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      for (int c = 0; c < 4; c++) {
+        image.pixels[y * stride + x * 4 + c] =
+            static_cast<uint8_t>(x * 7 + y * 13 + seed * 5 + c * 61);
+      }
+    }
+  }
+  return image;
+}
+
+// The image's rows without their padding.
+std::vector<uint8_t> Texels(const DecodedImage &image) {
+  size_t row_bytes = static_cast<size_t>(image.width) * 4;
+  std::vector<uint8_t> texels(row_bytes * image.height);
+  for (int y = 0; y < image.height; y++) {
+    std::memcpy(texels.data() + y * row_bytes,
+                image.pixels.data() + y * image.stride, row_bytes);
+  }
+  return texels;
+}
+
+class TextureLoaderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    context_ = HeadlessContext::Create(16, 16);
+    if (!context_) {
+      GTEST_SKIP() << "No GLES 3 context";
+    }
+  }
+
+  void CreateLoader(size_t upload_bytes_per_pump) {
+    TextureLoaderOptions options;
+    options.ring_bytes = kRingBytes;
+    options.upload_bytes_per_pump = upload_bytes_per_pump;
+    loader_ = std::make_unique<TextureLoader>(options);
+  }
+
+  std::shared_ptr<AsyncTexture> Load(const DecodedImage &image) {
+    return loader_->Load([image](DecodedImage *decoded) {
+      *decoded = image;
+      return true;
+    });
+  }
+
+  // Pumps until |done| or nothing is pending, with a timeout in case
+  // neither happens.
+  template <typename Done>
+  void PumpUntil(Done done) {
+    auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!done() && loader_->pending()) {
+      ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+      finished_ += loader_->Pump();
+      std::this_thread::yield();
+    }
+  }
+  void PumpAll() {
+    PumpUntil([] { return false; });
+  }
+
+  // Level 0 of |texture| as RGBA8, rows in the order they were uploaded.
+  static std::vector<uint8_t> ReadTexture(GLuint texture, int width,
+                                          int height) {
+    GLint previous;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous);
+    GLuint framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D, texture, 0);
+    std::vector<uint8_t> texels(static_cast<size_t>(width) * height * 4);
+    EXPECT_EQ(glCheckFramebufferStatus(GL_READ_FRAMEBUFFER),
+              static_cast<GLenum>(GL_FRAMEBUFFER_COMPLETE));
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE,
+                 texels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previous);
+    glDeleteFramebuffers(1, &framebuffer);
+    return texels;
+  }
+
+  static void ExpectLoaded(const AsyncTexture &texture,
+                           const DecodedImage &image) {
+    ASSERT_EQ(texture.status(), AsyncTexture::Status::kReady);
+    ASSERT_EQ(texture.width(), image.width);
+    ASSERT_EQ(texture.height(), image.height);
+    EXPECT_EQ(ReadTexture(texture.texture(), image.width, image.height),
+              Texels(image));
+  }
+
+  // Declared first, so the loader is destroyed while the context exists.
+  std::unique_ptr<HeadlessContext> context_;
+  std::unique_ptr<TextureLoader> loader_;
+  int finished_ = 0;
+};
+
+TEST_F(TextureLoaderTest, UploadsImagesLargerThanTheRing) {
+  // Less than the ring per pump, so images take several pumps, in bands
+  // of rows that don't divide their height.
+  CreateLoader(kRingBytes / 2 - 100);
+  // Rows of 148 bytes, 27 fit the ring with 100 bytes left over.
+  const DecodedImage images[] = {
+      Pattern(37, 100, 160, 1), Pattern(64, 48, 256, 2),
+      Pattern(1, 300, 4, 3),    Pattern(3, 5, 12, 4),
+      Pattern(37, 100, 148, 5), Pattern(1024, 3, 4096, 6),
+      Pattern(29, 61, 116, 7),
+  };
+  std::vector<std::shared_ptr<AsyncTexture>> textures;
+  for (const DecodedImage &image : images) {
+    textures.push_back(Load(image));
+    EXPECT_EQ(textures.back()->texture(), loader_->placeholder());
+  }
+  PumpAll();
+  for (size_t i = 0; i < textures.size(); i++) {
+    SCOPED_TRACE(i);
+    ExpectLoaded(*textures[i], images[i]);
+  }
+}
+
+TEST_F(TextureLoaderTest, FailedImagesKeepThePlaceholder) {
+  CreateLoader(kRingBytes);
+  std::shared_ptr<AsyncTexture> failed =
+      loader_->Load([](DecodedImage *) { return false; });
+  DecodedImage short_stride = Pattern(8, 8, 32, 9);
+  short_stride.stride = 28;
+  DecodedImage truncated = Pattern(8, 8, 32, 10);
+  truncated.pixels.resize(8 * 32 - 1);
+  // A single row would not fit the ring.
+  DecodedImage too_wide = Pattern(kRingBytes / 4 + 1, 1, kRingBytes + 4, 11);
+  DecodedImage good = Pattern(8, 8, 32, 12);
+  std::shared_ptr<AsyncTexture> textures[] = {
+      failed, Load(short_stride), Load(truncated), Load(too_wide),
+      Load(DecodedImage()), Load(good)};
+  PumpAll();
+  EXPECT_EQ(finished_, 6);
+  for (int i = 0; i < 5; i++) {
+    SCOPED_TRACE(i);
+    EXPECT_EQ(textures[i]->status(), AsyncTexture::Status::kFailed);
+    EXPECT_EQ(textures[i]->texture(), loader_->placeholder());
+  }
+  EXPECT_EQ(ReadTexture(loader_->placeholder(), 1, 1),
+            (std::vector<uint8_t>{128, 128, 128, 255}));
+  ExpectLoaded(*textures[5], good);
+}
+
+TEST_F(TextureLoaderTest, DropsTexturesReleasedMidUpload) {
+  CreateLoader(1000);
+  DecodedImage dropped = Pattern(37, 100, 148, 13);
+  DecodedImage next = Pattern(50, 40, 200, 14);
+  std::shared_ptr<AsyncTexture> texture = Load(dropped);
+  std::shared_ptr<AsyncTexture> kept = Load(next);
+  // The size is known once the first band is staged.
+  PumpUntil([&] { return texture->width() != 0; });
+  ASSERT_EQ(texture->status(), AsyncTexture::Status::kLoading);
+  texture.reset();
+  PumpAll();
+  EXPECT_EQ(loader_->pending(), 0u);
+  // Starts from its first row, not where the dropped image stopped.
+  ExpectLoaded(*kept, next);
+  DecodedImage last = Pattern(37, 100, 148, 15);
+  std::shared_ptr<AsyncTexture> reloaded = Load(last);
+  PumpAll();
+  ExpectLoaded(*reloaded, last);
+}
+
+// Uploads on llvmpipe finish before the next pump, so the loader only
+// wraps the ring on real GPUs. Its arithmetic is tested on its own.
+TEST(UploadRingTest, AllocatesAfterNewestThenWraps) {
+  size_t offset = 1;
+  EXPECT_TRUE(AllocateRing(1000, nullptr, 1000, &offset));
+  EXPECT_EQ(offset, 0u);
+  EXPECT_FALSE(AllocateRing(1000, nullptr, 1001, &offset));
+
+  RingRange used = {200, 900};
+  EXPECT_TRUE(AllocateRing(1000, &used, 100, &offset));
+  EXPECT_EQ(offset, 900u);
+  // Too little room before the end, so at the start, up to the oldest.
+  EXPECT_TRUE(AllocateRing(1000, &used, 101, &offset));
+  EXPECT_EQ(offset, 0u);
+  EXPECT_TRUE(AllocateRing(1000, &used, 200, &offset));
+  EXPECT_EQ(offset, 0u);
+  EXPECT_FALSE(AllocateRing(1000, &used, 201, &offset));
+
+  // Wrapped, the free space is between the newest and the oldest only.
+  used = {600, 300};
+  EXPECT_TRUE(AllocateRing(1000, &used, 300, &offset));
+  EXPECT_EQ(offset, 300u);
+  EXPECT_FALSE(AllocateRing(1000, &used, 301, &offset));
+}
+
+TEST(UploadRingTest, FullRingRefuses) {
+  size_t offset;
+  const RingRange full[] = {{0, 1000}, {400, 400}};
+  for (const RingRange &used : full) {
+    EXPECT_FALSE(AllocateRing(1000, &used, 1, &offset))
+        << used.begin << "-" << used.end;
+  }
+}
+
+// Allocates ranges of random sizes, releasing the oldest when the ring is
+// full or at random, like uploads whose fences signal in order.
+TEST(UploadRingTest, RangesInUseNeverOverlap) {
+  constexpr size_t kCapacity = 4096;
+  std::mt19937 random(3);
+  std::deque<RingRange> ranges;
+  int wraps = 0;
+  for (int i = 0; i < 20000; i++) {
+    if (!ranges.empty() && random() % 3 == 0) {
+      ranges.pop_front();
+      continue;
+    }
+    size_t size = 1 + random() % 1500;
+    RingRange used = {};
+    if (!ranges.empty()) {
+      used = {ranges.front().begin, ranges.back().end};
+    }
+    size_t offset;
+    if (!AllocateRing(kCapacity, ranges.empty() ? nullptr : &used, size,
+                      &offset)) {
+      ASSERT_FALSE(ranges.empty());
+      ranges.pop_front();
+      continue;
+    }
+    ASSERT_LE(offset + size, kCapacity);
+    for (const RingRange &range : ranges) {
+      ASSERT_TRUE(offset + size <= range.begin || offset >= range.end)
+          << offset << "+" << size << " overlaps " << range.begin << "-"
+          << range.end;
+    }
+    if (!ranges.empty() && offset < ranges.back().end) {
+      wraps++;
+    }
+    ranges.push_back({offset, offset + size});
+  }
+  EXPECT_GT(wraps, 100);
+}
+
+}  // namespace
+}  // namespace bob_ross
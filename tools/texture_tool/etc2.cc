@@ -0,0 +1,452 @@
+#include "etc2.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace bob_ross {
+namespace {
+
+// Modifier tables of the individual and differential modes, the small and
+// large magnitude of each.
+constexpr int kModifiers[8][2] = {{2, 8},   {5, 17},  {9, 29},  {13, 42},
+                                  {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+// Distances of the T and H modes.
+constexpr int kDistances[8] = {3, 6, 11, 16, 23, 32, 41, 64};
+constexpr int kEacModifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12}, {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11}, {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9},  {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9},  {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},  {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8},   {-3, -5, -7, -9, 2, 4, 6, 8}};
+
+int Clamp255(int value) { return std::min(std::max(value, 0), 255); }
+
+// Pixel indices 0 to 3 select +small, +large, -small and -large.
+int Modifier(int table, int index) {
+  int modifier = kModifiers[table][index & 1];
+  return index & 2 ? -modifier : modifier;
+}
+
+int Extend4(int value) { return value << 4 | value; }
+int Extend5(int value) { return value << 3 | value >> 2; }
+int Extend6(int value) { return value << 2 | value >> 4; }
+int Extend7(int value) { return value << 1 | value >> 6; }
+
+uint64_t ReadBlock(const uint8_t *block) {
+  uint64_t bits = 0;
+  for (int i = 0; i < 8; i++) {
+    bits = bits << 8 | block[i];
+  }
+  return bits;
+}
+
+void WriteBlock(uint64_t bits, uint8_t *block) {
+  for (int i = 7; i >= 0; i--) {
+    block[i] = static_cast<uint8_t>(bits);
+    bits >>= 8;
+  }
+}
+
+// Half of a block: the left or right 2x4 pixels, or with |flip| the top or
+// bottom 4x2.
+struct Subblock {
+  int rgb[8][3];
+  // Bit of each pixel in the index word, x * 4 + y.
+  int bit[8];
+};
+
+Subblock GetSubblock(const uint8_t *pixels, size_t stride, bool flip,
+                     int half) {
+  Subblock subblock;
+  int count = 0;
+  for (int y = 0; y < 4; y++) {
+    for (int x = 0; x < 4; x++) {
+      if ((flip ? y / 2 : x / 2) != half) {
+        continue;
+      }
+      const uint8_t *pixel = pixels + y * stride + x * 4;
+      for (int c = 0; c < 3; c++) {
+        subblock.rgb[count][c] = pixel[c];
+      }
+      subblock.bit[count++] = x * 4 + y;
+    }
+  }
+  return subblock;
+}
+
+struct Fit {
+  int error = INT_MAX;
+  int base[3];
+  int table;
+  // Index bits of the subblock's pixels, the high bits in the upper half.
+  uint32_t indices;
+};
+
+// Picks the modifier table and pixel indices that best fit |subblock| to
+// the 8 bit color |base|.
+Fit FitBase(const Subblock &subblock, const int *base) {
+  Fit best;
+  for (int table = 0; table < 8; table++) {
+    int error = 0;
+    uint32_t indices = 0;
+    for (int i = 0; i < 8; i++) {
+      int pixel_error = INT_MAX, pixel_index = 0;
+      for (int index = 0; index < 4; index++) {
+        int modifier = Modifier(table, index);
+        int sum = 0;
+        for (int c = 0; c < 3; c++) {
+          int d = Clamp255(base[c] + modifier) - subblock.rgb[i][c];
+          sum += d * d;
+        }
+        if (sum < pixel_error) {
+          pixel_error = sum;
+          pixel_index = index;
+        }
+      }
+      error += pixel_error;
+      indices |= (pixel_index >> 1) << (subblock.bit[i] + 16) |
+                 (pixel_index & 1) << subblock.bit[i];
+    }
+    if (error < best.error) {
+      best.error = error;
+      best.table = table;
+      best.indices = indices;
+      std::copy(base, base + 3, best.base);
+    }
+  }
+  return best;
+}
+
+// Fits |subblock| with base colors of |bits| per channel, trying both
+// roundings of its average in every channel. Channels are limited to
+// [low, high] when given.
+Fit FitQuantized(const Subblock &subblock, int bits, const int *low = nullptr,
+                 const int *high = nullptr) {
+  int max = (1 << bits) - 1;
+  int candidates[3][2];
+  for (int c = 0; c < 3; c++) {
+    int sum = 0;
+    for (int i = 0; i < 8; i++) {
+      sum += subblock.rgb[i][c];
+    }
+    int floor = sum * max / (8 * 255);
+    for (int r = 0; r < 2; r++) {
+      int value = std::min(floor + r, max);
+      if (low) {
+        value = std::min(std::max(value, low[c]), high[c]);
+      }
+      candidates[c][r] = value;
+    }
+  }
+  Fit best;
+  for (int i = 0; i < 8; i++) {
+    int quantized[3], base[3];
+    for (int c = 0; c < 3; c++) {
+      quantized[c] = candidates[c][i >> c & 1];
+      base[c] = bits == 4 ? Extend4(quantized[c]) : Extend5(quantized[c]);
+    }
+    Fit fit = FitBase(subblock, base);
+    if (fit.error < best.error) {
+      best = fit;
+      std::copy(quantized, quantized + 3, best.base);
+    }
+  }
+  return best;
+}
+
+uint64_t PackBlock(const Fit &first, const Fit &second, bool differential,
+                   bool flip) {
+  uint64_t bits = 0;
+  for (int c = 0; c < 3; c++) {
+    int shift = 56 - c * 8;
+    if (differential) {
+      int delta = second.base[c] - first.base[c];
+      bits |= static_cast<uint64_t>(first.base[c] << 3 | (delta & 7)) << shift;
+    } else {
+      bits |= static_cast<uint64_t>(first.base[c] << 4 | second.base[c])
+              << shift;
+    }
+  }
+  bits |= static_cast<uint64_t>(first.table << 5 | second.table << 2 |
+                                differential << 1 | flip)
+          << 32;
+  return bits | first.indices | second.indices;
+}
+
+}  // namespace
+
+void EncodeEtc2RgbBlock(const uint8_t *pixels, size_t stride,
+                        uint8_t *block) {
+  int best_error = INT_MAX;
+  uint64_t best = 0;
+  for (bool flip : {false, true}) {
+    Subblock first = GetSubblock(pixels, stride, flip, 0);
+    Subblock second = GetSubblock(pixels, stride, flip, 1);
+
+    Fit first_fit = FitQuantized(first, 4);
+    Fit second_fit = FitQuantized(second, 4);
+    if (first_fit.error + second_fit.error < best_error) {
+      best_error = first_fit.error + second_fit.error;
+      best = PackBlock(first_fit, second_fit, false, flip);
+    }
+
+    // The second base is stored as a 3 bit delta from the first, it must
+    // stay in range or the block decodes in another ETC2 mode.
+    first_fit = FitQuantized(first, 5);
+    int low[3], high[3];
+    for (int c = 0; c < 3; c++) {
+      low[c] = std::max(first_fit.base[c] - 4, 0);
+      high[c] = std::min(first_fit.base[c] + 3, 31);
+    }
+    second_fit = FitQuantized(second, 5, low, high);
+    if (first_fit.error + second_fit.error < best_error) {
+      best_error = first_fit.error + second_fit.error;
+      best = PackBlock(first_fit, second_fit, true, flip);
+    }
+  }
+  WriteBlock(best, block);
+}
+
+void EncodeEacAlphaBlock(const uint8_t *pixels, size_t stride,
+                         uint8_t *block) {
+  int alpha[16];
+  int low = 255, high = 0;
+  for (int i = 0; i < 16; i++) {
+    // Pixels are in column order, like ETC2 indices.
+    alpha[i] = pixels[(i % 4) * stride + (i / 4) * 4 + 3];
+    low = std::min(low, alpha[i]);
+    high = std::max(high, alpha[i]);
+  }
+  // A multiplier of 0 decodes every pixel to the base.
+  if (low == high) {
+    WriteBlock(static_cast<uint64_t>(low) << 56, block);
+    return;
+  }
+
+  int best_error = INT_MAX;
+  uint64_t best = 0;
+  for (int table = 0; table < 16; table++) {
+    const int *modifiers = kEacModifiers[table];
+    int span = modifiers[7] - modifiers[3];
+    int center = (high - low + span / 2) / span;
+    for (int multiplier = std::max(center - 1, 1);
+         multiplier <= std::min(center + 1, 15); multiplier++) {
+      int middle = (low + high - (modifiers[7] + modifiers[3]) * multiplier) /
+                   2;
+      for (int base = std::max(middle - 4, 0);
+           base <= std::min(middle + 4, 255); base++) {
+        int error = 0;
+        uint64_t indices = 0;
+        for (int i = 0; i < 16 && error < best_error; i++) {
+          int pixel_error = INT_MAX, pixel_index = 0;
+          for (int index = 0; index < 8; index++) {
+            int d = Clamp255(base + modifiers[index] * multiplier) - alpha[i];
+            if (d * d < pixel_error) {
+              pixel_error = d * d;
+              pixel_index = index;
+            }
+          }
+          error += pixel_error;
+          indices |= static_cast<uint64_t>(pixel_index) << (45 - 3 * i);
+        }
+        if (error < best_error) {
+          best_error = error;
+          best = static_cast<uint64_t>(base) << 56 |
+                 static_cast<uint64_t>(multiplier) << 52 |
+                 static_cast<uint64_t>(table) << 48 | indices;
+        }
+      }
+    }
+  }
+  WriteBlock(best, block);
+}
+
+void DecodeEtc2RgbBlock(const uint8_t *block, uint8_t *pixels,
+                        size_t stride) {
+  uint64_t bits = ReadBlock(block);
+  auto field = [bits](int shift, int width) {
+    return static_cast<int>(bits >> shift & ((1u << width) - 1));
+  };
+  auto index_of = [bits](int x, int y) {
+    int bit = x * 4 + y;
+    return static_cast<int>((bits >> (bit + 16) & 1) << 1 | (bits >> bit & 1));
+  };
+  auto store = [pixels, stride](int x, int y, const int *rgb) {
+    uint8_t *pixel = pixels + y * stride + x * 4;
+    for (int c = 0; c < 3; c++) {
+      pixel[c] = static_cast<uint8_t>(Clamp255(rgb[c]));
+    }
+  };
+
+  int bases[2][3];
+  bool differential = field(33, 1);
+  if (!differential) {
+    for (int c = 0; c < 3; c++) {
+      bases[0][c] = Extend4(field(60 - c * 8, 4));
+      bases[1][c] = Extend4(field(56 - c * 8, 4));
+    }
+  } else {
+    int first[3], second[3];
+    for (int c = 0; c < 3; c++) {
+      first[c] = field(59 - c * 8, 5);
+      // Sign extend the 3 bit delta.
+      second[c] = first[c] + ((field(56 - c * 8, 3) ^ 4) - 4);
+    }
+    if (second[0] < 0 || second[0] > 31) {
+      // T mode.
+      int colors[2][3] = {
+          {Extend4(field(59, 2) << 2 | field(56, 2)), Extend4(field(52, 4)),
+           Extend4(field(48, 4))},
+          {Extend4(field(44, 4)), Extend4(field(40, 4)),
+           Extend4(field(36, 4))}};
+      int distance = kDistances[field(34, 2) << 1 | field(32, 1)];
+      int paint[4][3];
+      for (int c = 0; c < 3; c++) {
+        paint[0][c] = colors[0][c];
+        paint[1][c] = colors[1][c] + distance;
+        paint[2][c] = colors[1][c];
+        paint[3][c] = colors[1][c] - distance;
+      }
+      for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+          store(x, y, paint[index_of(x, y)]);
+        }
+      }
+      return;
+    }
+    if (second[1] < 0 || second[1] > 31) {
+      // H mode.
+      int raw[2][3] = {
+          {field(59, 4), field(56, 3) << 1 | field(52, 1),
+           field(51, 1) << 3 | field(47, 3)},
+          {field(43, 4), field(39, 4), field(35, 4)}};
+      int order = (raw[0][0] << 8 | raw[0][1] << 4 | raw[0][2]) >=
+                  (raw[1][0] << 8 | raw[1][1] << 4 | raw[1][2]);
+      int distance =
+          kDistances[field(34, 1) << 2 | field(32, 1) << 1 | order];
+      int paint[4][3];
+      for (int c = 0; c < 3; c++) {
+        paint[0][c] = Extend4(raw[0][c]) + distance;
+        paint[1][c] = Extend4(raw[0][c]) - distance;
+        paint[2][c] = Extend4(raw[1][c]) + distance;
+        paint[3][c] = Extend4(raw[1][c]) - distance;
+      }
+      for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+          store(x, y, paint[index_of(x, y)]);
+        }
+      }
+      return;
+    }
+    if (second[2] < 0 || second[2] > 31) {
+      // Planar mode: colors at the origin, right and bottom edges.
+      int origin[3] = {
+          Extend6(field(57, 6)), Extend7(field(56, 1) << 6 | field(49, 6)),
+          Extend6(field(48, 1) << 5 | field(43, 2) << 3 | field(39, 3))};
+      int horizontal[3] = {Extend6(field(34, 5) << 1 | field(32, 1)),
+                           Extend7(field(25, 7)), Extend6(field(19, 6))};
+      int vertical[3] = {Extend6(field(13, 6)), Extend7(field(6, 7)),
+                         Extend6(field(0, 6))};
+      for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) {
+          int rgb[3];
+          for (int c = 0; c < 3; c++) {
+            rgb[c] = (x * (horizontal[c] - origin[c]) +
+                      y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >>
+                     2;
+          }
+          store(x, y, rgb);
+        }
+      }
+      return;
+    }
+    for (int c = 0; c < 3; c++) {
+      bases[0][c] = Extend5(first[c]);
+      bases[1][c] = Extend5(second[c]);
+    }
+  }
+
+  bool flip = field(32, 1);
+  int tables[2] = {field(37, 3), field(34, 3)};
+  for (int y = 0; y < 4; y++) {
+    for (int x = 0; x < 4; x++) {
+      int half = flip ? y / 2 : x / 2;
+      int modifier = Modifier(tables[half], index_of(x, y));
+      int rgb[3];
+      for (int c = 0; c < 3; c++) {
+        rgb[c] = bases[half][c] + modifier;
+      }
+      store(x, y, rgb);
+    }
+  }
+}
+
+void DecodeEacAlphaBlock(const uint8_t *block, uint8_t *pixels,
+                         size_t stride) {
+  uint64_t bits = ReadBlock(block);
+  int base = static_cast<int>(bits >> 56);
+  int multiplier = static_cast<int>(bits >> 52 & 15);
+  const int *modifiers = kEacModifiers[bits >> 48 & 15];
+  for (int i = 0; i < 16; i++) {
+    int index = static_cast<int>(bits >> (45 - 3 * i) & 7);
+    pixels[(i % 4) * stride + (i / 4) * 4 + 3] =
+        static_cast<uint8_t>(Clamp255(base + modifiers[index] * multiplier));
+  }
+}
+
+std::vector<uint8_t> EncodeEtc2Image(const uint8_t *pixels, int width,
+                                     int height, size_t stride, bool alpha) {
+  size_t block_bytes = alpha ? 16 : 8;
+  int blocks_x = (width + 3) / 4, blocks_y = (height + 3) / 4;
+  std::vector<uint8_t> data(block_bytes * blocks_x * blocks_y);
+  uint8_t *out = data.data();
+  for (int by = 0; by < blocks_y; by++) {
+    for (int bx = 0; bx < blocks_x; bx++) {
+      uint8_t block[4 * 16];
+      for (int y = 0; y < 4; y++) {
+        int sy = std::min(by * 4 + y, height - 1);
+        for (int x = 0; x < 4; x++) {
+          int sx = std::min(bx * 4 + x, width - 1);
+          std::copy_n(pixels + sy * stride + sx * 4, 4, block + y * 16 + x * 4);
+        }
+      }
+      if (alpha) {
+        EncodeEacAlphaBlock(block, 16, out);
+        out += 8;
+      }
+      EncodeEtc2RgbBlock(block, 16, out);
+      out += 8;
+    }
+  }
+  return data;
+}
+
+std::vector<uint8_t> DecodeEtc2Image(const uint8_t *data, int width,
+                                     int height, bool alpha) {
+  std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+  int blocks_x = (width + 3) / 4, blocks_y = (height + 3) / 4;
+  for (int by = 0; by < blocks_y; by++) {
+    for (int bx = 0; bx < blocks_x; bx++) {
+      uint8_t block[4 * 16];
+      std::fill_n(block, sizeof(block), 255);
+      if (alpha) {
+        DecodeEacAlphaBlock(data, block, 16);
+        data += 8;
+      }
+      DecodeEtc2RgbBlock(data, block, 16);
+      data += 8;
+      for (int y = 0; y < 4 && by * 4 + y < height; y++) {
+        for (int x = 0; x < 4 && bx * 4 + x < width; x++) {
+          std::copy_n(block + y * 16 + x * 4, 4,
+                      &pixels[((by * 4 + y) * width + bx * 4 + x) * 4]);
+        }
+      }
+    }
+  }
+  return pixels;
+}
+
+}  // namespace bob_ross
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bob_ross {
+
+// ETC2 RGB8 and RGBA8 (EAC alpha) block codecs. Blocks are 4x4 pixels of
+// RGBA8 with rows |stride| bytes apart.
+//
+// The encoder only emits the individual and differential modes ETC2 shares
+// with ETC1, searching both subblock orientations, every modifier table
+// and base colors around each subblock's average. The decoder handles the
+// T, H and planar modes as well, so files from other encoders can be
+// checked.
+
+// Writes an 8 byte ETC2 RGB block. Alpha is ignored.
+void EncodeEtc2RgbBlock(const uint8_t *pixels, size_t stride,
+                        uint8_t *block);
+// Writes an 8 byte EAC block of the alpha channel.
+void EncodeEacAlphaBlock(const uint8_t *pixels, size_t stride,
+                         uint8_t *block);
+// Decodes RGB of a block and leaves alpha untouched.
+void DecodeEtc2RgbBlock(const uint8_t *block, uint8_t *pixels, size_t stride);
+// Decodes alpha of a block and leaves RGB untouched.
+void DecodeEacAlphaBlock(const uint8_t *block, uint8_t *pixels,
+                         size_t stride);
+
+// Encodes an image as ETC2 RGB8, or RGBA8 when |alpha|. Blocks past the
+// edges repeat the last row and column.
+std::vector<uint8_t> EncodeEtc2Image(const uint8_t *pixels, int width,
+                                     int height, size_t stride, bool alpha);
+// Decodes an image encoded by EncodeEtc2Image to tightly packed RGBA8,
+// opaque unless |alpha|.
+std::vector<uint8_t> DecodeEtc2Image(const uint8_t *data, int width,
+                                     int height, bool alpha);
+
+}  // namespace bob_ross
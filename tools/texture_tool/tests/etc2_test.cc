@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <png.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "etc2.h"
+
+namespace bob_ross {
+namespace {
+
+struct Image {
+  int width = 0, height = 0;
+  // Tightly packed RGBA8.
+  std::vector<uint8_t> pixels;
+};
+
+bool ReadPng(const char *path, Image *image) {
+  png_image png;
+  std::memset(&png, 0, sizeof(png));
+  png.version = PNG_IMAGE_VERSION;
+  if (!png_image_begin_read_from_file(&png, path)) {
+    return false;
+  }
+  png.format = PNG_FORMAT_RGBA;
+  image->width = static_cast<int>(png.width);
+  image->height = static_cast<int>(png.height);
+  image->pixels.resize(PNG_IMAGE_SIZE(png));
+  return png_image_finish_read(&png, nullptr, image->pixels.data(), 0,
+                               nullptr);
+}
+
+// Over the channels selected by |channel_mask|, bit 0 for red.
+double Psnr(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b,
+            int channel_mask) {
+  double sum = 0;
+  size_t count = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    if (channel_mask & (1 << (i % 4))) {
+      double d = a[i] - b[i];
+      sum += d * d;
+      count++;
+    }
+  }
+  double mse = sum / count;
+  return mse ? 10 * std::log10(255.0 * 255.0 / mse) : INFINITY;
+}
+
+constexpr int kRgb = 0x7, kAlpha = 0x8;
+
+class Etc2Test : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(ReadPng(BOB_ROSS_TEST_IMAGE, &image_)) << BOB_ROSS_TEST_IMAGE;
+  }
+
+  Image image_;
+};
+
+TEST_F(Etc2Test, RgbQuality) {
+  std::vector<uint8_t> data =
+      EncodeEtc2Image(image_.pixels.data(), image_.width, image_.height,
+                      image_.width * 4, false);
+  ASSERT_EQ(data.size(), static_cast<size_t>((image_.width + 3) / 4) *
+                             ((image_.height + 3) / 4) * 8);
+  std::vector<uint8_t> decoded =
+      DecodeEtc2Image(data.data(), image_.width, image_.height, false);
+  ASSERT_EQ(decoded.size(), image_.pixels.size());
+  EXPECT_GT(Psnr(image_.pixels, decoded, kRgb), 38.0);
+  for (size_t i = 3; i < decoded.size(); i += 4) {
+    ASSERT_EQ(decoded[i], 255);
+  }
+}
+
+TEST_F(Etc2Test, RgbaQuality) {
+  std::vector<uint8_t> data =
+      EncodeEtc2Image(image_.pixels.data(), image_.width, image_.height,
+                      image_.width * 4, true);
+  ASSERT_EQ(data.size(), static_cast<size_t>((image_.width + 3) / 4) *
+                             ((image_.height + 3) / 4) * 16);
+  std::vector<uint8_t> decoded =
+      DecodeEtc2Image(data.data(), image_.width, image_.height, true);
+  ASSERT_EQ(decoded.size(), image_.pixels.size());
+  EXPECT_GT(Psnr(image_.pixels, decoded, kRgb), 38.0);
+  EXPECT_GT(Psnr(image_.pixels, decoded, kAlpha), 50.0);
+}
+
+TEST_F(Etc2Test, PartialBlocks) {
+  // Not a multiple of 4 either way, so the last blocks repeat edge pixels.
+  int width = 37, height = 22;
+  std::vector<uint8_t> data = EncodeEtc2Image(
+      image_.pixels.data(), width, height, image_.width * 4, true);
+  std::vector<uint8_t> decoded =
+      DecodeEtc2Image(data.data(), width, height, true);
+  ASSERT_EQ(decoded.size(), static_cast<size_t>(width) * height * 4);
+  std::vector<uint8_t> expected;
+  for (int y = 0; y < height; y++) {
+    const uint8_t *row = image_.pixels.data() + y * image_.width * 4;
+    expected.insert(expected.end(), row, row + width * 4);
+  }
+  EXPECT_GT(Psnr(expected, decoded, kRgb | kAlpha), 38.0);
+}
+
+}  // namespace
+}  // namespace bob_ross
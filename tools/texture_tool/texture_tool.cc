@@ -0,0 +1,238 @@
+// Converts PNG images to KTX2 containers of ETC2 compressed mip levels,
+// which GLES 3 devices upload as they are with glCompressedTexImage2D.
+//
+// Usage: bob_ross_texture_tool [--no-mips] in.png out.ktx2
+//        bob_ross_texture_tool --decode in.ktx2 out.png
+// Opaque images are encoded as ETC2 RGB8, others as ETC2 RGBA8. Mip levels
+// are box filtered down to 1x1 unless --no-mips is given. The written file
+// is parsed and decoded again, and the PSNR of level 0 is printed.
+// --decode writes level 0 of an ETC2 KTX2 file as a PNG.
+
+#include <bob_ross/ktx2.h>
+#include <png.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "etc2.h"
+
+namespace {
+
+using bob_ross::Ktx2Texture;
+
+struct Image {
+  int width = 0, height = 0;
+  // Tightly packed RGBA8.
+  std::vector<uint8_t> pixels;
+};
+
+bool ReadFile(const char *path, std::vector<uint8_t> *data) {
+  FILE *file = std::fopen(path, "rb");
+  if (!file) {
+    return false;
+  }
+  std::fseek(file, 0, SEEK_END);
+  data->resize(std::ftell(file));
+  std::fseek(file, 0, SEEK_SET);
+  bool ok = std::fread(data->data(), 1, data->size(), file) == data->size();
+  std::fclose(file);
+  return ok;
+}
+
+bool WriteFile(const char *path, const std::vector<uint8_t> &data) {
+  FILE *file = std::fopen(path, "wb");
+  if (!file) {
+    return false;
+  }
+  bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+  return std::fclose(file) == 0 && ok;
+}
+
+bool ReadPng(const char *path, Image *image) {
+  png_image png;
+  std::memset(&png, 0, sizeof(png));
+  png.version = PNG_IMAGE_VERSION;
+  if (!png_image_begin_read_from_file(&png, path)) {
+    std::fprintf(stderr, "%s: %s\n", path, png.message);
+    return false;
+  }
+  png.format = PNG_FORMAT_RGBA;
+  image->width = static_cast<int>(png.width);
+  image->height = static_cast<int>(png.height);
+  image->pixels.resize(PNG_IMAGE_SIZE(png));
+  if (!png_image_finish_read(&png, nullptr, image->pixels.data(), 0,
+                             nullptr)) {
+    std::fprintf(stderr, "%s: %s\n", path, png.message);
+    return false;
+  }
+  return true;
+}
+
+bool WritePng(const char *path, const Image &image) {
+  png_image png;
+  std::memset(&png, 0, sizeof(png));
+  png.version = PNG_IMAGE_VERSION;
+  png.width = image.width;
+  png.height = image.height;
+  png.format = PNG_FORMAT_RGBA;
+  if (!png_image_write_to_file(&png, path, 0, image.pixels.data(), 0,
+                               nullptr)) {
+    std::fprintf(stderr, "%s: %s\n", path, png.message);
+    return false;
+  }
+  return true;
+}
+
+// Averages 2x2 pixels, repeating the last row or column of odd sizes.
+Image Downsample(const Image &image) {
+  Image half;
+  half.width = std::max(image.width / 2, 1);
+  half.height = std::max(image.height / 2, 1);
+  half.pixels.resize(static_cast<size_t>(half.width) * half.height * 4);
+  for (int y = 0; y < half.height; y++) {
+    int y0 = std::min(y * 2, image.height - 1);
+    int y1 = std::min(y * 2 + 1, image.height - 1);
+    for (int x = 0; x < half.width; x++) {
+      int x0 = std::min(x * 2, image.width - 1);
+      int x1 = std::min(x * 2 + 1, image.width - 1);
+      for (int c = 0; c < 4; c++) {
+        auto at = [&](int px, int py) {
+          return image.pixels[(py * image.width + px) * 4 + c];
+        };
+        int sum = at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1);
+        half.pixels[(y * half.width + x) * 4 + c] =
+            static_cast<uint8_t>((sum + 2) / 4);
+      }
+    }
+  }
+  return half;
+}
+
+double Psnr(const Image &a, const Image &b) {
+  double sum = 0;
+  for (size_t i = 0; i < a.pixels.size(); i++) {
+    double d = a.pixels[i] - b.pixels[i];
+    sum += d * d;
+  }
+  double mse = sum / a.pixels.size();
+  return mse ? 10 * std::log10(255.0 * 255.0 / mse) : INFINITY;
+}
+
+bool IsAlphaFormat(uint32_t format) {
+  return format == bob_ross::kKtx2Etc2Rgba8 ||
+         format == bob_ross::kKtx2Etc2Rgba8Srgb;
+}
+
+bool IsEtc2Format(uint32_t format) {
+  return format == bob_ross::kKtx2Etc2Rgb8 ||
+         format == bob_ross::kKtx2Etc2Rgb8Srgb || IsAlphaFormat(format);
+}
+
+// Parses |data| and decodes its level 0. Only ETC2 files can be decoded.
+bool DecodeKtx2(const std::vector<uint8_t> &data, Image *image) {
+  Ktx2Texture texture;
+  std::string error;
+  if (!bob_ross::ParseKtx2(data.data(), data.size(), &texture, &error)) {
+    std::fprintf(stderr, "%s\n", error.c_str());
+    return false;
+  }
+  if (!IsEtc2Format(texture.format)) {
+    std::fprintf(stderr, "Can't decode format %u\n", texture.format);
+    return false;
+  }
+  image->width = texture.width;
+  image->height = texture.height;
+  image->pixels =
+      bob_ross::DecodeEtc2Image(texture.levels[0].data, texture.width,
+                                texture.height, IsAlphaFormat(texture.format));
+  return true;
+}
+
+int Encode(const char *input, const char *output, bool mips) {
+  Image image;
+  if (!ReadPng(input, &image)) {
+    return 1;
+  }
+  bool alpha = false;
+  for (size_t i = 3; i < image.pixels.size(); i += 4) {
+    alpha |= image.pixels[i] != 255;
+  }
+
+  Ktx2Texture texture;
+  texture.format = alpha ? bob_ross::kKtx2Etc2Rgba8 : bob_ross::kKtx2Etc2Rgb8;
+  texture.width = image.width;
+  texture.height = image.height;
+  std::vector<std::vector<uint8_t>> levels;
+  Image level = image;
+  for (;;) {
+    levels.push_back(bob_ross::EncodeEtc2Image(
+        level.pixels.data(), level.width, level.height, level.width * 4,
+        alpha));
+    texture.levels.push_back({levels.back().data(), levels.back().size(),
+                              level.width, level.height});
+    if (!mips || (level.width == 1 && level.height == 1)) {
+      break;
+    }
+    level = Downsample(level);
+  }
+
+  std::vector<uint8_t> data = bob_ross::WriteKtx2(texture);
+  if (!WriteFile(output, data)) {
+    std::fprintf(stderr, "Can't write %s\n", output);
+    return 1;
+  }
+  Image decoded;
+  if (!DecodeKtx2(data, &decoded)) {
+    return 1;
+  }
+  std::printf("%s: %dx%d %s, %zu levels, %zu bytes, %zu uncompressed, "
+              "PSNR %.2f dB\n",
+              output, image.width, image.height, alpha ? "RGBA8" : "RGB8",
+              texture.levels.size(), data.size(), image.pixels.size(),
+              Psnr(image, decoded));
+  return 0;
+}
+
+int Decode(const char *input, const char *output) {
+  std::vector<uint8_t> data;
+  if (!ReadFile(input, &data)) {
+    std::fprintf(stderr, "Can't read %s\n", input);
+    return 1;
+  }
+  Image image;
+  if (!DecodeKtx2(data, &image) || !WritePng(output, image)) {
+    return 1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  bool mips = true;
+  bool decode = false;
+  std::vector<const char *> paths;
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    if (!std::strcmp(arg, "--no-mips")) {
+      mips = false;
+    } else if (!std::strcmp(arg, "--decode")) {
+      decode = true;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+  if (paths.size() != 2) {
+    std::fprintf(stderr,
+                 "Usage: %s [--no-mips] in.png out.ktx2\n"
+                 "       %s --decode in.ktx2 out.png\n",
+                 argv[0], argv[0]);
+    return 1;
+  }
+  return decode ? Decode(paths[0], paths[1])
+                : Encode(paths[0], paths[1], mips);
+}